@@ -1,8 +1,13 @@
 #pragma once
 
 #include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
 #include "teqp/derivs.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/parallel.hpp"
+#include "teqp/algorithms/rootfinding.hpp"
 #include "teqp/algorithms/critical_tracing.hpp"
 #include "teqp/algorithms/critical_pure.hpp"
 #include <Eigen/Dense>
@@ -115,11 +120,11 @@ auto do_pure_VLE_T(Residual &resid, Scalar rhoL, Scalar rhoV, int maxiter) {
         //double r01 = static_cast<double>(r0[1]);
         
         // If the solution has stopped improving, stop. The change in rhovec is equal to v in infinite precision, but 
-        // not when finite precision is involved, use the minimum non-denormal float as the determination of whether
-        // the values are done changing
+        // not when finite precision is involved, so stop once the densities change by no more than the precision 
+        // of the numerical type relative to their values
         auto minval = std::numeric_limits<Scalar>::epsilon();
         //double minvaldbl = static_cast<double>(minval);
-        if (((rhovecnew - rhovec).cwiseAbs() < minval).all()) {
+        if (((rhovecnew - rhovec).cwiseAbs() <= minval * rhovec.cwiseAbs()).all()) {
             break;
         }
         if ((r0.cwiseAbs() < minval).all()) {
@@ -130,12 +135,41 @@ auto do_pure_VLE_T(Residual &resid, Scalar rhoL, Scalar rhoV, int maxiter) {
     return rhovec;
 }
 
+/***
+* \brief Solve for the saturated liquid and vapor densities of a pure fluid at the temperature T
+*
+* Newton's method is started from rhoL and rhoV, and stops after maxiter steps, or before once the densities no longer 
+* change to within the precision of Scalar. See pure_VLE_T_superanc to start from the superancillary of the model instead
+* \param maxiter The maximum number of Newton steps
+* \returns Array of liquid and vapor density
+*/
 template<typename Model, typename Scalar, ADBackends backend = ADBackends::autodiff>
 auto pure_VLE_T(const Model& model, Scalar T, Scalar rhoL, Scalar rhoV, int maxiter) {
     auto res = IsothermPureVLEResiduals<Model, Scalar, backend>(model, T);
     return do_pure_VLE_T(res, rhoL, rhoV, maxiter);
 }
 
+/***
+* \brief Solve for the saturated liquid and vapor densities of a pure fluid at the temperature T, starting from the 
+* superancillary of the model
+*
+* For models that provide superanc_rhoLV(T) (the canonical cubics and SaturationSurrogateModel, see has_superanc_rhoLV).
+* The superancillary densities are exact to nearly double precision, so in double precision one Newton step usually 
+* polishes them; as for pure_VLE_T, maxiter is the maximum number of steps, and with maxiter of zero the superancillary 
+* densities are returned as they are. Throws if T is outside the range of the superancillary
+* \param maxiter The maximum number of Newton steps
+* \returns Array of liquid and vapor density
+*/
+template<typename Model, typename Scalar, ADBackends backend = ADBackends::autodiff>
+auto pure_VLE_T_superanc(const Model& model, Scalar T, int maxiter = 10) {
+    static_assert(has_superanc_rhoLV<Model>::value, "The model must provide superanc_rhoLV(T)");
+    auto rhos = detail::try_superanc_rhoLV(model, static_cast<double>(T));
+    if (!rhos) {
+        throw InvalidArgument("Temperature of " + std::to_string(static_cast<double>(T)) + " K is outside the range of the superancillary");
+    }
+    return pure_VLE_T<Model, Scalar, backend>(model, T, static_cast<Scalar>(std::get<0>(*rhos)), static_cast<Scalar>(std::get<1>(*rhos)), maxiter);
+}
+
 enum class VLE_return_code { unset, xtol_satisfied, functol_satisfied, maxiter_met, notfinite_step };
 
 /***
@@ -155,31 +189,42 @@ template<typename Model, typename Scalar, typename Vector>
 auto mix_VLE_Tx(const Model& model, Scalar T, const Vector& rhovecL0, const Vector& rhovecV0, const Vector& xspec, double atol, double reltol, double axtol, double relxtol, int maxiter) {
 
     const Eigen::Index N = rhovecL0.size();
-    auto lengths = (Eigen::ArrayXi(3) << rhovecL0.size(), rhovecV0.size(), xspec.size()).finished();
+    auto lengths = (Eigen::Array3i() << rhovecL0.size(), rhovecV0.size(), xspec.size()).finished();
     if (lengths.minCoeff() != lengths.maxCoeff()){
         throw InvalidArgument("lengths of rhovecs and xspec must be the same in mix_VLE_Tx");
     }
-    Eigen::MatrixXd J(2 * N, 2 * N), r(2 * N, 1), x(2 * N, 1);
-    x.col(0).array().head(N) = rhovecL0;
-    x.col(0).array().tail(N) = rhovecV0;
+    // If the number of components is known at compile time, so are the sizes of all the arrays
+    constexpr int Ncomp = detail::compile_time_size_v<Vector>;
+    constexpr int N2 = (Ncomp == Eigen::Dynamic) ? Eigen::Dynamic : 2 * Ncomp;
+    using ArrayN = Eigen::Array<double, Ncomp, 1>;
+    Eigen::Matrix<double, N2, N2> J(2 * N, 2 * N);
+    Eigen::Matrix<double, N2, 1> r, x; r.resize(2 * N); x.resize(2 * N);
+    x.array().head(N) = rhovecL0;
+    x.array().tail(N) = rhovecV0;
     using isochoric = IsochoricDerivatives<Model, Scalar, Vector>;
 
-    Eigen::Map<Eigen::ArrayXd> rhovecL(&(x(0)), N);
-    Eigen::Map<Eigen::ArrayXd> rhovecV(&(x(0 + N)), N);
+    Eigen::Map<ArrayN> rhovecL(&(x(0)), N);
+    Eigen::Map<ArrayN> rhovecV(&(x(0 + N)), N);
     auto RT = model.R(xspec) * T;
 
+    // All the storage used in the iterations is allocated here, once
+    typename isochoric::Workspace wsL(N), wsV(N);
+    Eigen::Matrix<double, Ncomp, 1> dpdrhovecL, dpdrhovecV; dpdrhovecL.resize(N); dpdrhovecV.resize(N);
+    Eigen::Array<double, N2, 1> dx; dx.resize(2 * N);
+    NewtonStepSolver<N2> stepsolver(2 * N);
+
     VLE_return_code return_code = VLE_return_code::unset;
 
     for (int iter = 0; iter < maxiter; ++iter) {
 
-        auto [PsirL, PsirgradL, hessianL] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecL);
-        auto [PsirV, PsirgradV, hessianV] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecV);
+        auto [PsirL, PsirgradL, hessianL] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecL, wsL);
+        auto [PsirV, PsirgradV, hessianV] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecV, wsV);
         auto rhoL = rhovecL.sum();
         auto rhoV = rhovecV.sum();
         Scalar pL = rhoL * RT - PsirL + (rhovecL.array() * PsirgradL.array()).sum(); // The (array*array).sum is a dot product
         Scalar pV = rhoV * RT - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-        auto dpdrhovecL = RT + (hessianL * rhovecL.matrix()).array();
-        auto dpdrhovecV = RT + (hessianV * rhovecV.matrix()).array();
+        dpdrhovecL.noalias() = hessianL * rhovecL.matrix(); dpdrhovecL.array() += RT;
+        dpdrhovecV.noalias() = hessianV * rhovecV.matrix(); dpdrhovecV.array() += RT;
 
         r(0) = PsirgradL(0) + RT * log(rhovecL(0)) - (PsirgradV(0) + RT * log(rhovecV(0)));
         r(1) = PsirgradL(1) + RT * log(rhovecL(1)) - (PsirgradV(1) + RT * log(rhovecV(1)));
@@ -206,7 +251,7 @@ auto mix_VLE_Tx(const Model& model, Scalar T, const Vector& rhovecL0, const Vect
         J(3, 1) = -rhovecL(0) / (rhoL * rhoL); // dxi/drhoj (j!=i)
 
         // Solve for the step
-        Eigen::ArrayXd dx = J.colPivHouseholderQr().solve(-r);
+        stepsolver.solve(J, -r, dx);
         x.array() += dx;
 
         if ((!dx.isFinite()).all()){
@@ -214,14 +259,12 @@ auto mix_VLE_Tx(const Model& model, Scalar T, const Vector& rhovecL0, const Vect
             break;
         }
 
-        auto xtol_threshold = (axtol + relxtol * x.array().cwiseAbs()).eval();
-        if ((dx.array().cwiseAbs() < xtol_threshold).all()) {
+        if ((dx.cwiseAbs() < axtol + relxtol * x.array().cwiseAbs()).all()) {
             return_code = VLE_return_code::xtol_satisfied;
             break;
         }
 
-        auto error_threshold = (atol + reltol * r.array().cwiseAbs()).eval();
-        if ((r.array().cwiseAbs() < error_threshold).all()) {
+        if ((r.array().cwiseAbs() < atol + reltol * r.array().cwiseAbs()).all()) {
             return_code = VLE_return_code::functol_satisfied;
             break;
         }
@@ -237,7 +280,7 @@ auto mix_VLE_Tx(const Model& model, Scalar T, const Vector& rhovecL0, const Vect
             return_code = VLE_return_code::maxiter_met;
         }
     }
-    Eigen::ArrayXd rhovecLfinal = rhovecL, rhovecVfinal = rhovecV;
+    ArrayN rhovecLfinal = rhovecL, rhovecVfinal = rhovecV;
     return std::make_tuple(return_code, rhovecLfinal, rhovecVfinal);
 }
 
@@ -286,6 +329,12 @@ auto mixture_VLE_px(const Model& model, Scalar p_spec, const Vector& xmolar_spec
 
     double T = T0;
 
+    // All the storage used in the iterations is allocated here, once
+    typename isochoric::Workspace wsL(N), wsV(N);
+    Eigen::VectorXd dpdrhovecL(N), dpdrhovecV(N);
+    Eigen::ArrayXd DELTAdmu_dT_res(N), dx(2*N+1);
+    NewtonStepSolver<> stepsolver(2*N+1);
+
     VLE_return_code return_code = VLE_return_code::unset;
 
     for (int iter = 0; iter < flags.maxiter; ++iter) {
@@ -295,30 +344,20 @@ auto mixture_VLE_px(const Model& model, Scalar p_spec, const Vector& xmolar_spec
         auto RVT = RLT; // Note: this should not be exactly the same if you use mole-fraction-weighted gas constants
         
         // calculations from the EOS in the isochoric thermodynamics formalism
-        auto [PsirL, PsirgradL, hessianL] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecL);
-        auto [PsirV, PsirgradV, hessianV] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecV);
-        auto DELTAdmu_dT_res = (isochoric::build_d2PsirdTdrhoi_autodiff(model, T, rhovecL.eval()) 
-                              - isochoric::build_d2PsirdTdrhoi_autodiff(model, T, rhovecV.eval())).eval();
-
-        auto make_diag = [](const Eigen::ArrayXd& v) -> Eigen::ArrayXXd {
-            Eigen::MatrixXd A = Eigen::MatrixXd::Identity(v.size(), v.size());
-            A.diagonal() = v;
-            return A;
-        };
-        auto HtotL = (hessianL.array() + make_diag(RLT/rhovecL)).eval();
-        auto HtotV = (hessianV.array() + make_diag(RVT/rhovecV)).eval();
+        auto [PsirL, PsirgradL, hessianL] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecL, wsL);
+        auto [PsirV, PsirgradV, hessianV] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecV, wsV);
+        DELTAdmu_dT_res = isochoric::build_d2PsirdTdrhoi_autodiff(model, T, rhovecL, wsL);
+        DELTAdmu_dT_res -= isochoric::build_d2PsirdTdrhoi_autodiff(model, T, rhovecV, wsV);
 
         auto rhoL = rhovecL.sum();
         auto rhoV = rhovecV.sum();
         Scalar pL = rhoL * RLT - PsirL + (rhovecL.array() * PsirgradL.array()).sum(); // The (array*array).sum is a dot product
         Scalar pV = rhoV * RVT - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-        auto dpdrhovecL = RLT + (hessianL * rhovecL.matrix()).array();
-        auto dpdrhovecV = RVT + (hessianV * rhovecV.matrix()).array();
-        
-        auto DELTA_dchempot_dT = (DELTAdmu_dT_res + RL*log(rhovecL/rhovecV)).eval();
+        dpdrhovecL.noalias() = hessianL * rhovecL.matrix(); dpdrhovecL.array() += RLT;
+        dpdrhovecV.noalias() = hessianV * rhovecV.matrix(); dpdrhovecV.array() += RVT;
 
         // First N equations are equalities of chemical potentials in both phases
-        r.head(N) = PsirgradL + RLT*log(rhovecL) - (PsirgradV + RVT*log(rhovecV));
+        r.head(N) = PsirgradL.array() + RLT*log(rhovecL) - (PsirgradV.array() + RVT*log(rhovecV));
         // Next two are pressures in each phase equaling the specification
         r(N) = pL/p_spec - 1;
         r(N+1) = pV/p_spec - 1;
@@ -329,25 +368,30 @@ auto mixture_VLE_px(const Model& model, Scalar p_spec, const Vector& xmolar_spec
         // Columns in Jacobian are: [T, rhovecL, rhovecV]
         // ...
         // N Chemical potential contributions in Jacobian (indices 0 to N-1)
-        J.block(0, 0, N, 1) = DELTA_dchempot_dT; 
-        J.block(0, 1, N, N) = HtotL; // These are the concentration derivatives
-        J.block(0, N+1, N, N) = -HtotV; // These are the concentration derivatives
-        // Pressure contributions in Jacobian
-        J(N, 0) = isochoric::get_dpdT_constrhovec(model, T, rhovecL)/p_spec;
+        J.block(0, 0, N, 1) = DELTAdmu_dT_res + RL*log(rhovecL/rhovecV);
+        // These are the concentration derivatives, the Hessians of Psi in each phase
+        J.block(0, 1, N, N) = hessianL;
+        J.block(0, 1, N, N).diagonal().array() += RLT/rhovecL;
+        J.block(0, N+1, N, N) = -hessianV;
+        J.block(0, N+1, N, N).diagonal().array() -= RVT/rhovecV;
+        // Pressure contributions in Jacobian; the temperature derivatives are as in get_dpdT_constrhovec, 
+        // but from the derivatives that are already in the workspaces
+        J(N, 0) = (rhoL*model.R(rhovecL/rhoL) - wsL.dPsirdT + rhovecL.matrix().dot(wsL.d2PsirdTdrhoi.matrix()))/p_spec;
         J.block(N, 1, 1, N) = dpdrhovecL.transpose()/p_spec;
         // No vapor concentration derivatives
-        J(N+1, 0) = isochoric::get_dpdT_constrhovec(model, T, rhovecV)/p_spec;
+        J(N+1, 0) = (rhoV*model.R(rhovecV/rhoV) - wsV.dPsirdT + rhovecV.matrix().dot(wsV.d2PsirdTdrhoi.matrix()))/p_spec;
         // No liquid concentration derivatives
         J.block(N+1, N+1, 1, N) = dpdrhovecV.transpose()/p_spec;
         // Mole fraction contributions in Jacobian
         // dxi/drhoj = (rho*Kronecker(i,j)-rho_i)/rho^2 since x_i = rho_i/rho
-        //
-        Eigen::ArrayXXd AA = rhovecL.matrix().reshaped(N, 1).replicate(1, N).array();
-        Eigen::MatrixXd M = ((rhoL * Eigen::MatrixXd::Identity(N, N).array() - AA) / (rhoL * rhoL));
-        J.block(N+2, 1, N-1, N) = M.block(0,0,N-1,N);
+        for (auto i = 0; i < N-1; ++i) {
+            for (auto j = 0; j < N; ++j) {
+                J(N+2+i, 1+j) = (((i == j) ? rhoL : 0.0) - rhovecL(i)) / (rhoL * rhoL);
+            }
+        }
 
         // Solve for the step
-        Eigen::ArrayXd dx = J.colPivHouseholderQr().solve(-r);
+        stepsolver.solve(J, -r, dx);
 
         if ((!dx.isFinite()).all()) {
             return_code = VLE_return_code::notfinite_step;
@@ -357,14 +401,12 @@ auto mixture_VLE_px(const Model& model, Scalar p_spec, const Vector& xmolar_spec
         T += dx(0);
         x.tail(2*N).array() += dx.tail(2*N);
 
-        auto xtol_threshold = (flags.axtol + flags.relxtol * x.array().cwiseAbs()).eval();
-        if ((dx.array().cwiseAbs() < xtol_threshold).all()) {
+        if ((dx.cwiseAbs() < flags.axtol + flags.relxtol * x.array().cwiseAbs()).all()) {
             return_code = VLE_return_code::xtol_satisfied;
             break;
         }
 
-        auto error_threshold = (flags.atol + flags.reltol * r.array().cwiseAbs()).eval();
-        if ((r.array().cwiseAbs() < error_threshold).all()) {
+        if ((r.array().cwiseAbs() < flags.atol + flags.reltol * r.array().cwiseAbs()).all()) {
             return_code = VLE_return_code::functol_satisfied;
             break;
         }
@@ -389,15 +431,19 @@ template<class Model, class Scalar, class VecType>
 auto get_drhovecdp_Tsat(const Model& model, const Scalar &T, const VecType& rhovecL, const VecType& rhovecV) {
     //tic = timeit.default_timer();
     using id = IsochoricDerivatives<Model, Scalar, VecType>;
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = id::build_Psi_Hessian_autodiff(model, T, rhovecL).eval();
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = id::build_Psi_Hessian_autodiff(model, T, rhovecV).eval();
+    // The matrices have fixed size if the number of components is known at compile time
+    constexpr int Ncomp = detail::compile_time_size_v<VecType>;
+    using Mat = Eigen::Matrix<Scalar, Ncomp, Ncomp>;
+    using Col = Eigen::Matrix<Scalar, Ncomp, (Ncomp == Eigen::Dynamic) ? Eigen::Dynamic : 1>;
+    Mat Hliq = id::build_Psi_Hessian_autodiff(model, T, rhovecL).eval();
+    Mat Hvap = id::build_Psi_Hessian_autodiff(model, T, rhovecV).eval();
     //Hvap[~np.isfinite(Hvap)] = 1e20;
     //Hliq[~np.isfinite(Hliq)] = 1e20;
 
     auto N = rhovecL.size();
-    Eigen::MatrixXd A = decltype(Hliq)::Zero(N, N);
-    auto b = decltype(Hliq)::Ones(N, 1);
-    decltype(Hliq) drhodp_liq, drhodp_vap;
+    Mat A = Mat::Zero(N, N);
+    auto b = Col::Ones(N, 1);
+    Col drhodp_liq, drhodp_vap;
     assert(rhovecL.size() == rhovecV.size());
     if ((rhovecL != 0).all() && (rhovecV != 0).all()) {
         // Normal treatment for all concentrations not equal to zero
@@ -467,13 +513,17 @@ auto get_drhovecdT_psat(const Model& model, const Scalar &T, const VecType& rhov
     if (rhovecL.size() != 2) { throw std::invalid_argument("Binary mixtures only"); }
     assert(rhovecL.size() == rhovecV.size());
 
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = id::build_Psi_Hessian_autodiff(model, T, rhovecL).eval();
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = id::build_Psi_Hessian_autodiff(model, T, rhovecV).eval();
+    // The matrices have fixed size if the number of components is known at compile time
+    constexpr int Ncomp = detail::compile_time_size_v<VecType>;
+    using Mat = Eigen::Matrix<Scalar, Ncomp, Ncomp>;
+    using Col = Eigen::Matrix<Scalar, Ncomp, (Ncomp == Eigen::Dynamic) ? Eigen::Dynamic : 1>;
+    Mat Hliq = id::build_Psi_Hessian_autodiff(model, T, rhovecL).eval();
+    Mat Hvap = id::build_Psi_Hessian_autodiff(model, T, rhovecV).eval();
 
     auto N = rhovecL.size();
-    Eigen::MatrixXd A = decltype(Hliq)::Zero(N, N);
-    Eigen::MatrixXd b = decltype(Hliq)::Ones(N, 1);
-    decltype(Hliq) drhovecdT_liq, drhovecdT_vap;
+    Mat A = Mat::Zero(N, N);
+    Col b = Col::Ones(N, 1);
+    Col drhovecdT_liq, drhovecdT_vap;
     assert(rhovecL.size() == rhovecV.size());
 
     if ((rhovecL != 0).all() && (rhovecV != 0).all()) {
@@ -588,10 +638,14 @@ auto get_drhovecdT_xsat(const Model& model, const Scalar& T, const VecType& rhov
     Scalar deltabeta = (id::get_dpdT_constrhovec(model, T, rhovecV)- id::get_dpdT_constrhovec(model, T, rhovecL));
     VecType deltarho = (rhovecV - rhovecL).eval();
 
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hliq = id::build_Psi_Hessian_autodiff(model, T, rhovecL).eval();
-    Eigen::Matrix<Scalar, Eigen::Dynamic, Eigen::Dynamic> Hvap = id::build_Psi_Hessian_autodiff(model, T, rhovecV).eval();
+    // The matrices have fixed size if the number of components is known at compile time
+    constexpr int Ncomp = detail::compile_time_size_v<VecType>;
+    using Mat = Eigen::Matrix<Scalar, Ncomp, Ncomp>;
+    using Col = Eigen::Matrix<Scalar, Ncomp, (Ncomp == Eigen::Dynamic) ? Eigen::Dynamic : 1>;
+    Mat Hliq = id::build_Psi_Hessian_autodiff(model, T, rhovecL).eval();
+    Mat Hvap = id::build_Psi_Hessian_autodiff(model, T, rhovecV).eval();
     
-    Eigen::MatrixXd drhodT_liq, drhodT_vap;
+    Col drhodT_liq, drhodT_vap;
     if ((rhovecL != 0).all() && (rhovecV != 0).all()) {
         auto num = (deltas.matrix().dot(rhovecV.matrix()) - deltabeta); // numerator, a scalar
         auto den = (Hliq*(deltarho.matrix())).dot(molefracL.matrix()); // denominator, a scalar
@@ -663,15 +717,116 @@ struct TVLEOptions {
     bool terminate_unstable = false;
 };
 
+/// Selection of the derived quantities that are calculated at each point of a VLE trace that is passed to an observer
+struct VLETraceColumns {
+    bool pressures = true; ///< The pressures of the liquid and vapor phases
+    bool criticality_conditions = false; ///< The criticality conditions of each phase (always calculated if calc_criticality is set in the options)
+};
+
+/// One accepted point of a VLE isotherm or isobar; the optional members are only populated if they were selected in the VLETraceColumns
+struct VLETracePoint {
+    double t; ///< The tracing variable
+    double dt; ///< The current step size in the tracing variable
+    double T; ///< Temperature, in K
+    double c; ///< The direction of tracing, 1 or -1
+    Eigen::ArrayXd rhovecL; ///< Molar concentrations of the liquid phase, in mol/m^3
+    Eigen::ArrayXd rhovecV; ///< Molar concentrations of the vapor phase, in mol/m^3
+    Eigen::ArrayXd dxdt; ///< Derivative of the state vector w.r.t. the tracing variable; the state is [rhovecL, rhovecV] for an isotherm and [T, rhovecL, rhovecV] for an isobar
+    std::optional<double> pL; ///< Pressure of the liquid phase, in Pa
+    std::optional<double> pV; ///< Pressure of the vapor phase, in Pa
+    std::optional<Eigen::ArrayXd> crit_conditions_L; ///< Criticality conditions of the liquid phase
+    std::optional<Eigen::ArrayXd> crit_conditions_V; ///< Criticality conditions of the vapor phase
+};
+
+/// Convert a point of a VLE trace into the JSON representation returned by trace_VLE_isotherm_binary and trace_VLE_isobar_binary
+inline nlohmann::json VLE_trace_point_to_JSON(const VLETracePoint& pt) {
+    nlohmann::json point = {
+        {"t", pt.t},
+        {"dt", pt.dt},
+        {"T / K", pt.T},
+        {"c", pt.c},
+        {"rhoL / mol/m^3", pt.rhovecL},
+        {"rhoV / mol/m^3", pt.rhovecV},
+        {"xL_0 / mole frac.", pt.rhovecL[0] / pt.rhovecL.sum()},
+        {"xV_0 / mole frac.", pt.rhovecV[0] / pt.rhovecV.sum()},
+        {"drho/dt", pt.dxdt}
+    };
+    if (pt.pL) { point["pL / Pa"] = pt.pL.value(); }
+    if (pt.pV) { point["pV / Pa"] = pt.pV.value(); }
+    if (pt.crit_conditions_L) { point["crit. conditions L"] = pt.crit_conditions_L.value(); }
+    if (pt.crit_conditions_V) { point["crit. conditions V"] = pt.crit_conditions_V.value(); }
+    return point;
+}
+
+/**
+* \brief The points of a VLE isotherm or isobar, stored column-wise
+*
+* Each quantity has its own contiguous column and the vector quantities have one column per entry. 
+* The columns of quantities that were not selected in the VLETraceColumns are empty.
+*/
+struct VLETraceData {
+    std::vector<double> t, ///< The tracing variable
+        dt, ///< The step size in the tracing variable
+        T, ///< Temperature, in K
+        c, ///< The direction of tracing
+        pL, ///< Pressure of the liquid phase, in Pa
+        pV; ///< Pressure of the vapor phase, in Pa
+    std::vector<std::vector<double>> rhovecL, ///< Molar concentrations of the liquid phase, in mol/m^3
+        rhovecV, ///< Molar concentrations of the vapor phase, in mol/m^3
+        dxdt, ///< Derivative of the state vector w.r.t. the tracing variable
+        crit_conditions_L, ///< Criticality conditions of the liquid phase
+        crit_conditions_V; ///< Criticality conditions of the vapor phase
+
+    /// The number of points
+    std::size_t size() const { return T.size(); }
+
+    /// Append a point to the columns
+    void push_back(const VLETracePoint& pt) {
+        t.push_back(pt.t); dt.push_back(pt.dt); T.push_back(pt.T); c.push_back(pt.c);
+        detail::append_to_columns(rhovecL, pt.rhovecL);
+        detail::append_to_columns(rhovecV, pt.rhovecV);
+        detail::append_to_columns(dxdt, pt.dxdt);
+        if (pt.pL) { pL.push_back(pt.pL.value()); }
+        if (pt.pV) { pV.push_back(pt.pV.value()); }
+        if (pt.crit_conditions_L) { detail::append_to_columns(crit_conditions_L, pt.crit_conditions_L.value()); }
+        if (pt.crit_conditions_V) { detail::append_to_columns(crit_conditions_V, pt.crit_conditions_V.value()); }
+    }
+
+    /// Reassemble the i-th point from the columns
+    VLETracePoint point(std::size_t i) const {
+        VLETracePoint pt{ t[i], dt[i], T[i], c[i], detail::row_of_columns(rhovecL, i), detail::row_of_columns(rhovecV, i), detail::row_of_columns(dxdt, i) };
+        if (!pL.empty()) { pt.pL = pL[i]; }
+        if (!pV.empty()) { pt.pV = pV[i]; }
+        if (!crit_conditions_L.empty()) { pt.crit_conditions_L = detail::row_of_columns(crit_conditions_L, i); }
+        if (!crit_conditions_V.empty()) { pt.crit_conditions_V = detail::row_of_columns(crit_conditions_V, i); }
+        return pt;
+    }
+
+    /// A view of the data as a JSON array with one object per point, as returned by trace_VLE_isotherm_binary and trace_VLE_isobar_binary
+    nlohmann::json to_JSON() const {
+        auto JSONdata = nlohmann::json::array();
+        for (auto i = 0U; i < size(); ++i) {
+            JSONdata.push_back(VLE_trace_point_to_JSON(point(i)));
+        }
+        return JSONdata;
+    }
+};
+
 /***
-* \brief Trace an isotherm with parametric tracing
+* \brief Trace an isotherm with parametric tracing, passing each accepted point to an observer
+*
+* The observer is called as observer(const VLETracePoint&), with the derived quantities selected in columns. If it returns 
+* a bool, returning false stops the tracing
+* \returns The number of points passed to the observer
 */
-template<typename Model, typename Scalar, typename VecType>
-auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, VecType rhovecV0, const std::optional<TVLEOptions>& options = std::nullopt) 
+template<typename Model, typename Scalar, typename VecType, typename Observer>
+std::size_t trace_VLE_isotherm_binary_observed(const Model &model, Scalar T, VecType rhovecL0, VecType rhovecV0, const Observer& observer, const VLETraceColumns& columns = {}, const std::optional<TVLEOptions>& options = std::nullopt) 
 {
     // Get the options, or the default values if not provided
     TVLEOptions opt = options.value_or(TVLEOptions{});
     auto N = rhovecL0.size();
+    // The views of the molar concentrations have fixed size if VecType does
+    using ArrayN = Eigen::Array<double, detail::compile_time_size_v<VecType>, 1>;
     if (N != 2) {
         throw InvalidArgument("Size must be 2");
     }
@@ -681,8 +836,8 @@ auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, V
 
     auto norm = [](const auto& v) { return (v * v).sum(); };
 
-    // Define datatypes and functions for tracing tools
-    auto JSONdata = nlohmann::json::array();
+    std::size_t Npoints = 0;
+    bool keep_going = true;
 
     // Typedefs for the types
     using namespace boost::numeric::odeint;
@@ -703,8 +858,8 @@ auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, V
     // Set up the initial state vector
     state_type x0(2 * N), last_drhodt(2 * N), previous_drhodt(2 * N);
     auto set_init_state = [&](state_type& X) {
-        auto rhovecL = Eigen::Map<Eigen::ArrayXd>(&(X[0]), N);
-        auto rhovecV = Eigen::Map<Eigen::ArrayXd>(&(X[0]) + N, N);
+        auto rhovecL = Eigen::Map<ArrayN>(&(X[0]), N);
+        auto rhovecV = Eigen::Map<ArrayN>(&(X[0]) + N, N);
         rhovecL = rhovecL0;
         rhovecV = rhovecV0;
     };
@@ -714,10 +869,10 @@ auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, V
     auto xprime = [&](const state_type& X, state_type& Xprime, double /*t*/) {
         // Memory maps into the state vector for inputs and their derivatives
         // These are views, not copies!
-        auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(X[0]), N);
-        auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(X[0]) + N, N);
-        auto drhovecdtL = Eigen::Map<Eigen::ArrayXd>(&(Xprime[0]), N);
-        auto drhovecdtV = Eigen::Map<Eigen::ArrayXd>(&(Xprime[0]) + N, N);
+        auto rhovecL = Eigen::Map<const ArrayN>(&(X[0]), N);
+        auto rhovecV = Eigen::Map<const ArrayN>(&(X[0]) + N, N);
+        auto drhovecdtL = Eigen::Map<ArrayN>(&(Xprime[0]), N);
+        auto drhovecdtV = Eigen::Map<ArrayN>(&(Xprime[0]) + N, N);
         // Get the derivatives with respect to pressure along the isotherm of the phase envelope
         auto [drhovecdpL, drhovecdpV] = get_drhovecdp_Tsat(model, T, rhovecL, rhovecV);
         // Get the derivative of p w.r.t. parameter
@@ -764,14 +919,9 @@ auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, V
         auto store_point = [&]() {
             //// Calculate some other parameters, for debugging
             auto N = x0.size() / 2;
-            auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]), N);
-            auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]) + N, N);
-            auto rhototL = rhovecL.sum(), rhototV = rhovecV.sum();
-            using id = IsochoricDerivatives<decltype(model), Scalar, VecType>;
-            double pL = rhototL * model.R(rhovecL / rhovecL.sum())*T + id::get_pr(model, T, rhovecL);
-            double pV = rhototV * model.R(rhovecV / rhovecV.sum())*T + id::get_pr(model, T, rhovecV);
-
-            // Store the derivative
+            auto rhovecL = Eigen::Map<const ArrayN>(&(x0[0]), N);
+            auto rhovecV = Eigen::Map<const ArrayN>(&(x0[0]) + N, N);
+            // Store the derivative (this is also needed for the direction checks of the next step)
             try {
                 xprime(x0, last_drhodt, -1.0);
             }
@@ -779,30 +929,24 @@ auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, V
                 std::cout << "Something bad happened; couldn't calculate xprime in store_point" << std::endl;
             }
 
-            // Store the data in a JSON structure
-            nlohmann::json point = {
-                {"t", t},
-                {"dt", dt},
-                {"T / K", T},
-                {"pL / Pa", pL},
-                {"pV / Pa", pV},
-                {"c", c},
-                {"rhoL / mol/m^3", rhovecL},
-                {"rhoV / mol/m^3", rhovecV},
-                {"xL_0 / mole frac.", rhovecL[0]/rhovecL.sum()},
-                {"xV_0 / mole frac.", rhovecV[0]/rhovecV.sum()},
-                {"drho/dt", last_drhodt}
-            };
-            if (opt.calc_criticality) {
+            VLETracePoint point{ t, dt, T, c, rhovecL, rhovecV, Eigen::Map<const Eigen::ArrayXd>(&(last_drhodt[0]), last_drhodt.size()) };
+            if (columns.pressures) {
+                using id = IsochoricDerivatives<decltype(model), Scalar, VecType>;
+                auto rhototL = rhovecL.sum(), rhototV = rhovecV.sum();
+                point.pL = rhototL * model.R(rhovecL / rhovecL.sum())*T + id::get_pr(model, T, rhovecL);
+                point.pV = rhototV * model.R(rhovecV / rhovecV.sum())*T + id::get_pr(model, T, rhovecV);
+            }
+            if (columns.criticality_conditions || opt.calc_criticality) {
                 using ct = CriticalTracing<Model, Scalar, VecType>;
-                point["crit. conditions L"] = ct::get_criticality_conditions(model, T, rhovecL);
-                point["crit. conditions V"] = ct::get_criticality_conditions(model, T, rhovecV);
+                point.crit_conditions_L = ct::get_criticality_conditions(model, T, rhovecL);
+                point.crit_conditions_V = ct::get_criticality_conditions(model, T, rhovecV);
             }
-            JSONdata.push_back(point);
-            //std::cout << JSONdata.back().dump() << std::endl;
+            Npoints++;
+            keep_going = notify_observer(observer, point);
         };
         if (istep == 0 && retry_count == 0) {
             store_point();
+            if (!keep_going) { break; }
         }
 
         //double dtold = dt;
@@ -844,8 +988,8 @@ auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, V
         auto stop_requested = [&]() {
             //// Calculate some other parameters, for debugging
             auto N = x0.size() / 2;
-            auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]), N);
-            auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]) + N, N);
+            auto rhovecL = Eigen::Map<const ArrayN>(&(x0[0]), N);
+            auto rhovecV = Eigen::Map<const ArrayN>(&(x0[0]) + N, N);
             auto x = rhovecL / rhovecL.sum();
             auto y = rhovecV / rhovecV.sum();
             // Check if the solution has gone mechanically unstable
@@ -869,14 +1013,14 @@ auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, V
         }
         // Polish the solution
         if (opt.polish) {
-            auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(x0[0]), N).eval();
-            auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(x0[0 + N]), N).eval();
-            auto x = (Eigen::ArrayXd(2) << rhovecL(0) / rhovecL.sum(), rhovecL(1) / rhovecL.sum()).finished(); // Mole fractions in the liquid phase (to be kept constant)
+            auto rhovecL = Eigen::Map<const ArrayN>(&(x0[0]), N).eval();
+            auto rhovecV = Eigen::Map<const ArrayN>(&(x0[0 + N]), N).eval();
+            const ArrayN x = (rhovecL / rhovecL.sum()).eval(); // Mole fractions in the liquid phase (to be kept constant)
             auto [return_code, rhovecLnew, rhovecVnew] = mix_VLE_Tx(model, T, rhovecL, rhovecV, x, 1e-10, 1e-8, 1e-10, 1e-8, 10);
 
             // If the step is accepted, copy into x again ...
-            auto rhovecLview = Eigen::Map<Eigen::ArrayXd>(&(x0[0]), N);
-            auto rhovecVview = Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + N, N);
+            auto rhovecLview = Eigen::Map<ArrayN>(&(x0[0]), N);
+            auto rhovecVview = Eigen::Map<ArrayN>(&(x0[0]) + N, N);
             rhovecLview = rhovecLnew;
             rhovecVview = rhovecVnew;
             //std::cout << "[polish]: " << static_cast<int>(return_code) << ": " << rhovecLnew.sum() / rhovecL.sum() << " " << rhovecVnew.sum() / rhovecV.sum() << std::endl;
@@ -884,9 +1028,33 @@ auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, V
 
         std::swap(previous_drhodt, last_drhodt);
         store_point(); // last_drhodt is updated;
+        if (!keep_going) { break; }
         
     }
-    return JSONdata;
+    return Npoints;
+}
+
+/***
+* \brief Trace an isotherm with parametric tracing, storing the points column-wise
+*/
+template<typename Model, typename Scalar, typename VecType>
+VLETraceData trace_VLE_isotherm_binary_columnar(const Model &model, Scalar T, VecType rhovecL0, VecType rhovecV0, const VLETraceColumns& columns = {}, const std::optional<TVLEOptions>& options = std::nullopt) 
+{
+    VLETraceData data;
+    trace_VLE_isotherm_binary_observed(model, T, rhovecL0, rhovecV0, [&data](const VLETracePoint& pt) { data.push_back(pt); }, columns, options);
+    return data;
+}
+
+/***
+* \brief Trace an isotherm with parametric tracing, storing all the points in JSON
+*
+* See trace_VLE_isotherm_binary_columnar for the version that stores the points column-wise, and 
+* trace_VLE_isotherm_binary_observed for the version that passes each point to a callback instead
+*/
+template<typename Model, typename Scalar, typename VecType>
+auto trace_VLE_isotherm_binary(const Model &model, Scalar T, VecType rhovecL0, VecType rhovecV0, const std::optional<TVLEOptions>& options = std::nullopt) 
+{
+    return trace_VLE_isotherm_binary_columnar(model, T, rhovecL0, rhovecV0, VLETraceColumns{}, options).to_JSON();
 }
 
 
@@ -899,14 +1067,20 @@ struct PVLEOptions {
 };
 
 /***
-* \brief Trace an isobar with parametric tracing
+* \brief Trace an isobar with parametric tracing, passing each accepted point to an observer
+*
+* The observer is called as observer(const VLETracePoint&), with the derived quantities selected in columns. If it returns 
+* a bool, returning false stops the tracing
+* \returns The number of points passed to the observer
 */
-template<typename Model, typename Scalar, typename VecType>
-auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rhovecL0, VecType rhovecV0, const std::optional<PVLEOptions>& options = std::nullopt)
+template<typename Model, typename Scalar, typename VecType, typename Observer>
+std::size_t trace_VLE_isobar_binary_observed(const Model& model, Scalar p, Scalar T0, VecType rhovecL0, VecType rhovecV0, const Observer& observer, const VLETraceColumns& columns = {}, const std::optional<PVLEOptions>& options = std::nullopt)
 {
     // Get the options, or the default values if not provided
     PVLEOptions opt = options.value_or(PVLEOptions{});
     auto N = rhovecL0.size();
+    // The views of the molar concentrations have fixed size if VecType does
+    using ArrayN = Eigen::Array<double, detail::compile_time_size_v<VecType>, 1>;
     if (N != 2) {
         throw InvalidArgument("Size must be 2");
     }
@@ -916,8 +1090,8 @@ auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rh
 
     auto norm = [](const auto& v) { return (v * v).sum(); };
 
-    // Define datatypes and functions for tracing tools
-    auto JSONdata = nlohmann::json::array();
+    std::size_t Npoints = 0;
+    bool keep_going = true;
 
     // Typedefs for the types
     using namespace boost::numeric::odeint;
@@ -939,8 +1113,8 @@ auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rh
     state_type x0(2*N+1), last_drhodt(2*N+1), previous_drhodt(2*N+1);
     auto set_init_state = [&](state_type& X) {
         X[0] = T0; 
-        auto rhovecL = Eigen::Map<Eigen::ArrayXd>(&(X[1]), N);
-        auto rhovecV = Eigen::Map<Eigen::ArrayXd>(&(X[1]) + N, N);
+        auto rhovecL = Eigen::Map<ArrayN>(&(X[1]), N);
+        auto rhovecV = Eigen::Map<ArrayN>(&(X[1]) + N, N);
         rhovecL = rhovecL0;
         rhovecV = rhovecV0;
     };
@@ -951,11 +1125,11 @@ auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rh
         // Memory maps into the state vector for inputs and their derivatives
         // These are views, not copies!
         const double& T = X[0];
-        auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(X[1]), N);
-        auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(X[1]) + N, N);
+        auto rhovecL = Eigen::Map<const ArrayN>(&(X[1]), N);
+        auto rhovecV = Eigen::Map<const ArrayN>(&(X[1]) + N, N);
         auto& dTdt = Xprime[0];
-        auto drhovecdtL = Eigen::Map<Eigen::ArrayXd>(&(Xprime[1]), N);
-        auto drhovecdtV = Eigen::Map<Eigen::ArrayXd>(&(Xprime[1]) + N, N);
+        auto drhovecdtL = Eigen::Map<ArrayN>(&(Xprime[1]), N);
+        auto drhovecdtV = Eigen::Map<ArrayN>(&(Xprime[1]) + N, N);
         // Get the derivatives with respect to temperature along the isobar of the phase envelope
         auto [drhovecdTL, drhovecdTV] = get_drhovecdT_psat(model, T, rhovecL, rhovecV);
         // Get the derivative of T w.r.t. parameter
@@ -1003,14 +1177,9 @@ auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rh
             //// Calculate some other parameters, for debugging
             auto N = x0.size() / 2;
             double T = x0[0];
-            auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(x0[1]), N);
-            auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(x0[1]) + N, N);
-            auto rhototL = rhovecL.sum(), rhototV = rhovecV.sum();
-            using id = IsochoricDerivatives<decltype(model), Scalar, VecType>;
-            double pL = rhototL * model.R(rhovecL / rhovecL.sum()) * T + id::get_pr(model, T, rhovecL);
-            double pV = rhototV * model.R(rhovecV / rhovecV.sum()) * T + id::get_pr(model, T, rhovecV);
-
-            // Store the derivative
+            auto rhovecL = Eigen::Map<const ArrayN>(&(x0[1]), N);
+            auto rhovecV = Eigen::Map<const ArrayN>(&(x0[1]) + N, N);
+            // Store the derivative (this is also needed for the direction checks of the next step)
             try {
                 xprime(x0, last_drhodt, -1.0);
             }
@@ -1018,30 +1187,24 @@ auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rh
                 std::cout << "Something bad happened; couldn't calculate xprime in store_point" << std::endl;
             }
 
-            // Store the data in a JSON structure
-            nlohmann::json point = {
-                {"t", t},
-                {"dt", dt},
-                {"T / K", T},
-                {"pL / Pa", pL},
-                {"pV / Pa", pV},
-                {"c", c},
-                {"rhoL / mol/m^3", rhovecL},
-                {"rhoV / mol/m^3", rhovecV},
-                {"xL_0 / mole frac.", rhovecL[0] / rhovecL.sum()},
-                {"xV_0 / mole frac.", rhovecV[0] / rhovecV.sum()},
-                {"drho/dt", last_drhodt}
-            };
-            if (opt.calc_criticality) {
+            VLETracePoint point{ t, dt, T, c, rhovecL, rhovecV, Eigen::Map<const Eigen::ArrayXd>(&(last_drhodt[0]), last_drhodt.size()) };
+            if (columns.pressures) {
+                using id = IsochoricDerivatives<decltype(model), Scalar, VecType>;
+                auto rhototL = rhovecL.sum(), rhototV = rhovecV.sum();
+                point.pL = rhototL * model.R(rhovecL / rhovecL.sum())*T + id::get_pr(model, T, rhovecL);
+                point.pV = rhototV * model.R(rhovecV / rhovecV.sum())*T + id::get_pr(model, T, rhovecV);
+            }
+            if (columns.criticality_conditions || opt.calc_criticality) {
                 using ct = CriticalTracing<Model, Scalar, VecType>;
-                point["crit. conditions L"] = ct::get_criticality_conditions(model, T, rhovecL);
-                point["crit. conditions V"] = ct::get_criticality_conditions(model, T, rhovecV);
+                point.crit_conditions_L = ct::get_criticality_conditions(model, T, rhovecL);
+                point.crit_conditions_V = ct::get_criticality_conditions(model, T, rhovecV);
             }
-            JSONdata.push_back(point);
-            //std::cout << JSONdata.back().dump() << std::endl;
+            Npoints++;
+            keep_going = notify_observer(observer, point);
         };
         if (istep == 0 && retry_count == 0) {
             store_point();
+            if (!keep_going) { break; }
         }
 
         //double dtold = dt;
@@ -1084,8 +1247,8 @@ auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rh
             //// Calculate some other parameters, for debugging
             auto N = (x0.size()-1) / 2;
             auto& T = x0[0];
-            auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(x0[1]), N);
-            auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(x0[1]) + N, N);
+            auto rhovecL = Eigen::Map<const ArrayN>(&(x0[1]), N);
+            auto rhovecV = Eigen::Map<const ArrayN>(&(x0[1]) + N, N);
             auto x = rhovecL / rhovecL.sum();
             auto y = rhovecV / rhovecV.sum();
             // Check if the solution has gone mechanically unstable
@@ -1110,15 +1273,15 @@ auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rh
         // Polish the solution
         if (opt.polish) {
             double T = x0[0];
-            auto rhovecL = Eigen::Map<const Eigen::ArrayXd>(&(x0[1]), N).eval();
-            auto rhovecV = Eigen::Map<const Eigen::ArrayXd>(&(x0[1 + N]), N).eval();
-            auto x = (Eigen::ArrayXd(2) << rhovecL(0) / rhovecL.sum(), rhovecL(1) / rhovecL.sum()).finished(); // Mole fractions in the liquid phase (to be kept constant)
+            auto rhovecL = Eigen::Map<const ArrayN>(&(x0[1]), N).eval();
+            auto rhovecV = Eigen::Map<const ArrayN>(&(x0[1 + N]), N).eval();
+            const ArrayN x = (rhovecL / rhovecL.sum()).eval(); // Mole fractions in the liquid phase (to be kept constant)
             auto [return_code, Tnew, rhovecLnew, rhovecVnew] = mixture_VLE_px(model, p, x, T, rhovecL, rhovecV);
 
             // If the step is accepted, copy into x again ...
             x0[0] = Tnew;
-            auto rhovecLview = Eigen::Map<Eigen::ArrayXd>(&(x0[1]), N);
-            auto rhovecVview = Eigen::Map<Eigen::ArrayXd>(&(x0[1]) + N, N);
+            auto rhovecLview = Eigen::Map<ArrayN>(&(x0[1]), N);
+            auto rhovecVview = Eigen::Map<ArrayN>(&(x0[1]) + N, N);
             rhovecLview = rhovecLnew;
             rhovecVview = rhovecVnew;
             //std::cout << "[polish]: " << static_cast<int>(return_code) << ": " << rhovecLnew.sum() / rhovecL.sum() << " " << rhovecVnew.sum() / rhovecV.sum() << std::endl;
@@ -1126,9 +1289,199 @@ auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rh
 
         std::swap(previous_drhodt, last_drhodt);
         store_point(); // last_drhodt is updated;
+        if (!keep_going) { break; }
+
+    }
+    return Npoints;
+}
+
+/***
+* \brief Trace an isobar with parametric tracing, storing the points column-wise
+*/
+template<typename Model, typename Scalar, typename VecType>
+VLETraceData trace_VLE_isobar_binary_columnar(const Model& model, Scalar p, Scalar T0, VecType rhovecL0, VecType rhovecV0, const VLETraceColumns& columns = {}, const std::optional<PVLEOptions>& options = std::nullopt)
+{
+    VLETraceData data;
+    trace_VLE_isobar_binary_observed(model, p, T0, rhovecL0, rhovecV0, [&data](const VLETracePoint& pt) { data.push_back(pt); }, columns, options);
+    return data;
+}
+
+/***
+* \brief Trace an isobar with parametric tracing, storing all the points in JSON
+*
+* See trace_VLE_isobar_binary_columnar for the version that stores the points column-wise, and 
+* trace_VLE_isobar_binary_observed for the version that passes each point to a callback instead
+*/
+template<typename Model, typename Scalar, typename VecType>
+auto trace_VLE_isobar_binary(const Model& model, Scalar p, Scalar T0, VecType rhovecL0, VecType rhovecV0, const std::optional<PVLEOptions>& options = std::nullopt)
+{
+    return trace_VLE_isobar_binary_columnar(model, p, T0, rhovecL0, rhovecV0, VLETraceColumns{}, options).to_JSON();
+}
+
+/***
+* \brief A view of one component of a mixture model as a pure fluid
+*
+* The pure fluid composition (of length one) is expanded into the composition of the mixture, with 
+* all the other mole fractions equal to zero. This allows the pure fluid routines (e.g., pure_VLE_T) to be 
+* applied to one of the components of a mixture model without needing a separate pure fluid model
+*/
+template<typename Model>
+class PureComponentView {
+private:
+    const Model& m_model;
+    const Eigen::Index m_ipure, m_N;
+    template<typename MoleFractions>
+    auto expand(const MoleFractions& molefrac) const {
+        using S = std::decay_t<decltype(molefrac[0])>;
+        Eigen::Array<S, Eigen::Dynamic, 1> z(m_N);
+        z.setZero();
+        z[m_ipure] = molefrac[0];
+        return z;
+    }
+public:
+    PureComponentView(const Model& model, Eigen::Index ipure, Eigen::Index N) : m_model(model), m_ipure(ipure), m_N(N) {
+        if (ipure < 0 || ipure >= N) {
+            throw InvalidArgument("Pure component index must be in [0, " + std::to_string(N) + ")");
+        }
+    };
+    template<typename MoleFractions>
+    auto R(const MoleFractions& molefrac) const {
+        return m_model.R(expand(molefrac));
+    }
+    template<typename TType, typename RhoType, typename MoleFractions>
+    auto alphar(const TType& T, const RhoType& rho, const MoleFractions& molefrac) const {
+        return m_model.alphar(T, rho, expand(molefrac));
+    }
+};
 
+/***
+* \brief Solve for the saturation temperature and densities of a pure fluid at the given pressure
+*
+* Each iteration solves the pure fluid VLE at the current temperature (warm-started from the densities of the previous 
+* iteration), and then takes a Newton step in temperature, with the slope of the vapor pressure curve given by the 
+* Clapeyron equation
+* \f[
+* \frac{dp}{dT} = \frac{s''-s'}{1/\rho''-1/\rho'}
+* \f]
+* \returns Tuple of temperature, liquid density and vapor density, the densities being solved at the returned temperature
+* \throws IterationFailure if the temperature does not converge in maxiter iterations
+*/
+template<typename Model>
+auto pure_VLE_p(const Model& model, double p, double T0, double rhoL0, double rhoV0, int maxiter = 20) {
+    using tdx = TDXDerivatives<Model, double, Eigen::ArrayXd>;
+    const auto z = (Eigen::ArrayXd(1) << 1.0).finished();
+    const double R = model.R(z);
+    double T = T0, rhoL = rhoL0, rhoV = rhoV0;
+    auto solve_densities = [&]() {
+        auto rhos = pure_VLE_T(model, T, rhoL, rhoV, 10);
+        rhoL = rhos[0]; rhoV = rhos[1];
+        if (!std::isfinite(rhoL) || !std::isfinite(rhoV) || std::abs(rhoL / rhoV - 1) < 1e-6) {
+            throw IterationFailure("Pure fluid VLE did not converge to distinct phases at T=" + std::to_string(T) + " K");
+        }
+    };
+    for (int iter = 0; iter < maxiter; ++iter) {
+        solve_densities();
+        double pT = rhoL * R * T * (1.0 + tdx::get_Ar01(model, T, rhoL, z));
+        // Residual entropies (divided by R) of each phase, and the ideal-gas part of the entropy difference at the same temperature
+        double sRL = tdx::get_Ar10(model, T, rhoL, z) - tdx::get_Ar00(model, T, rhoL, z);
+        double sRV = tdx::get_Ar10(model, T, rhoV, z) - tdx::get_Ar00(model, T, rhoV, z);
+        double dpdT = R * (sRV - sRL + log(rhoL / rhoV)) / (1.0 / rhoV - 1.0 / rhoL);
+        double dT = -(pT - p) / dpdT;
+        T += dT;
+        if (std::abs(dT) < 1e-12 * T) {
+            // The densities are recomputed so that they belong to the returned temperature
+            solve_densities();
+            return std::make_tuple(T, rhoL, rhoV);
+        }
     }
-    return JSONdata;
+    throw IterationFailure("pure_VLE_p did not converge in " + std::to_string(maxiter) + " iterations at p=" + std::to_string(p) + " Pa");
+}
+
+/// The outcome of tracing one isoline (isotherm or isobar) of a family
+struct VLEIsolineResult {
+    double value = 0; ///< The temperature in K (isotherm) or pressure in Pa (isobar) of the isoline
+    bool success = false; ///< True if the seeding and tracing completed without throwing
+    nlohmann::json trace; ///< The trace, as returned by trace_VLE_isotherm_binary or trace_VLE_isobar_binary; null if failed
+    std::string message; ///< The message of the exception if the isoline failed
+};
+
+/***
+* \brief Trace a family of VLE isotherms of a binary mixture concurrently
+*
+* Each isotherm starts from the pure fluid saturation state of the component with index ipure, obtained by 
+* polishing the densities returned by seed(T) (a tuple of liquid and vapor density guesses, for instance from 
+* an ancillary equation or superancillary) with pure_VLE_T. The isotherms are handed out dynamically to the threads;
+* an isotherm that fails (e.g., above the critical temperature of the pure fluid) does not affect the others
+*
+* \param model The mixture model; only const methods are called, so one instance is shared by all threads
+* \param Ts The temperatures of the isotherms, in K
+* \param ipure The index of the pure fluid from which to start each isotherm
+* \param seed The callable returning the density guesses for the pure fluid at T
+* \param options The options passed to trace_VLE_isotherm_binary
+* \param Nthreads The number of threads; if 0, the number of hardware threads
+* \returns One result per temperature, in the same order
+*/
+template<typename Model, typename Seed>
+auto trace_VLE_isotherms_binary(const Model& model, const std::vector<double>& Ts, int ipure, const Seed& seed, const std::optional<TVLEOptions>& options = std::nullopt, std::size_t Nthreads = 0) {
+    const PureComponentView<Model> pure(model, ipure, 2);
+    std::vector<VLEIsolineResult> results(Ts.size());
+    parallel_for_dynamic(Ts.size(), Nthreads, [&](std::size_t i) {
+        auto& result = results[i];
+        const double T = Ts[i];
+        result.value = T;
+        try {
+            auto [rhoL0, rhoV0] = seed(T);
+            auto rhos = pure_VLE_T(pure, T, static_cast<double>(rhoL0), static_cast<double>(rhoV0), 10);
+            if (!rhos.isFinite().all() || std::abs(rhos[0] / rhos[1] - 1) < 1e-6) {
+                throw IterationFailure("Pure fluid VLE did not converge to distinct phases at T=" + std::to_string(T) + " K");
+            }
+            Eigen::ArrayXd rhovecL = Eigen::ArrayXd::Zero(2), rhovecV = Eigen::ArrayXd::Zero(2);
+            rhovecL[ipure] = rhos[0]; rhovecV[ipure] = rhos[1];
+            result.trace = trace_VLE_isotherm_binary(model, T, rhovecL, rhovecV, options);
+            result.success = true;
+        }
+        catch (const std::exception& e) {
+            result.message = e.what();
+        }
+    });
+    return results;
+}
+
+/***
+* \brief Trace a family of VLE isobars of a binary mixture concurrently
+*
+* As for trace_VLE_isotherms_binary, except that seed(p) returns a tuple of guesses for the saturation temperature, 
+* liquid density and vapor density of the pure fluid, which are polished with pure_VLE_p
+*
+* \param model The mixture model; only const methods are called, so one instance is shared by all threads
+* \param ps The pressures of the isobars, in Pa
+* \param ipure The index of the pure fluid from which to start each isobar
+* \param seed The callable returning the guesses of temperature and densities for the pure fluid at p
+* \param options The options passed to trace_VLE_isobar_binary
+* \param Nthreads The number of threads; if 0, the number of hardware threads
+* \returns One result per pressure, in the same order
+*/
+template<typename Model, typename Seed>
+auto trace_VLE_isobars_binary(const Model& model, const std::vector<double>& ps, int ipure, const Seed& seed, const std::optional<PVLEOptions>& options = std::nullopt, std::size_t Nthreads = 0) {
+    const PureComponentView<Model> pure(model, ipure, 2);
+    std::vector<VLEIsolineResult> results(ps.size());
+    parallel_for_dynamic(ps.size(), Nthreads, [&](std::size_t i) {
+        auto& result = results[i];
+        const double p = ps[i];
+        result.value = p;
+        try {
+            auto [T0, rhoL0, rhoV0] = seed(p);
+            auto [T, rhoL, rhoV] = pure_VLE_p(pure, p, static_cast<double>(T0), static_cast<double>(rhoL0), static_cast<double>(rhoV0));
+            Eigen::ArrayXd rhovecL = Eigen::ArrayXd::Zero(2), rhovecV = Eigen::ArrayXd::Zero(2);
+            rhovecL[ipure] = rhoL; rhovecV[ipure] = rhoV;
+            result.trace = trace_VLE_isobar_binary(model, p, T, rhovecL, rhovecV, options);
+            result.success = true;
+        }
+        catch (const std::exception& e) {
+            result.message = e.what();
+        }
+    });
+    return results;
 }
 
 }; /* namespace teqp*/
\ No newline at end of file
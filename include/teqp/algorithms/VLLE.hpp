@@ -2,6 +2,7 @@
 
 #include "teqp/derivs.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/algorithms/rootfinding.hpp"
 
 namespace teqp {
 
@@ -37,17 +38,19 @@ namespace teqp {
         Eigen::Map<Eigen::ArrayXd> rhovecL1(&(x(0+N)), N);
         Eigen::Map<Eigen::ArrayXd> rhovecL2(&(x(0+2*N)), N);
 
+        // All the storage used in the iterations is allocated here, once
+        typename isochoric::Workspace wsV(N), wsL1(N), wsL2(N);
+        Eigen::VectorXd dpdrhovecV(N), dpdrhovecL1(N), dpdrhovecL2(N);
+        Eigen::ArrayXd dx(3 * N);
+        NewtonStepSolver<> stepsolver(3 * N);
+
         VLLE_return_code return_code = VLLE_return_code::unset;
 
         for (int iter = 0; iter < maxiter; ++iter) {
 
-            auto [PsirV, PsirgradV, hessianV] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecV); 
-            auto [PsirL1, PsirgradL1, hessianL1] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecL1);
-            auto [PsirL2, PsirgradL2, hessianL2] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecL2);
-            
-            auto HtotV = isochoric::build_Psi_Hessian_autodiff(model, T, rhovecV);
-            auto HtotL1 = isochoric::build_Psi_Hessian_autodiff(model, T, rhovecL1);
-            auto HtotL2 = isochoric::build_Psi_Hessian_autodiff(model, T, rhovecL2);
+            auto [PsirV, PsirgradV, hessianV] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecV, wsV); 
+            auto [PsirL1, PsirgradL1, hessianL1] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecL1, wsL1);
+            auto [PsirL2, PsirgradL2, hessianL2] = isochoric::build_Psir_fgradHessian_autodiff(model, T, rhovecL2, wsL2);
 
             auto zV = rhovecV/rhovecV.sum(), zL1 = rhovecL1 / rhovecL1.sum(), zL2 = rhovecL2 / rhovecL2.sum();
             double RTL1 = model.R(zL1)*T, RTL2 = model.R(zL2)*T, RTV = model.R(zV)*T;
@@ -58,24 +61,28 @@ namespace teqp {
             Scalar pL1 = rhoL1 * RTL1 - PsirL1 + (rhovecL1.array() * PsirgradL1.array()).sum(); // The (array*array).sum is a dot product
             Scalar pL2 = rhoL2 * RTL2 - PsirL2 + (rhovecL2.array() * PsirgradL2.array()).sum(); // The (array*array).sum is a dot product
             Scalar pV = rhoV * RTV - PsirV + (rhovecV.array() * PsirgradV.array()).sum();
-            auto dpdrhovecL1 = RTL1 + (hessianL1 * rhovecL1.matrix()).array();
-            auto dpdrhovecL2 = RTL2 + (hessianL2 * rhovecL2.matrix()).array();
-            auto dpdrhovecV = RTV + (hessianV * rhovecV.matrix()).array();
+            dpdrhovecL1.noalias() = hessianL1 * rhovecL1.matrix(); dpdrhovecL1.array() += RTL1;
+            dpdrhovecL2.noalias() = hessianL2 * rhovecL2.matrix(); dpdrhovecL2.array() += RTL2;
+            dpdrhovecV.noalias() = hessianV * rhovecV.matrix(); dpdrhovecV.array() += RTV;
 
             // 2N rows are equality of chemical equilibria
-            r.head(N) = PsirgradV + RTV*log(rhovecV) - (PsirgradL1 + RTL1*log(rhovecL1));
-            r.segment(N,N) = PsirgradL1 + RTL1 * log(rhovecL1) - (PsirgradL2 + RTL2 * log(rhovecL2));
+            r.head(N) = PsirgradV.array() + RTV*log(rhovecV) - (PsirgradL1.array() + RTL1*log(rhovecL1));
+            r.segment(N,N) = PsirgradL1.array() + RTL1 * log(rhovecL1) - (PsirgradL2.array() + RTL2 * log(rhovecL2));
             // Followed by N pressure equilibria
             r(2*N) = pV - pL1;
             r(2*N+1) = pL1 - pL2;
 
-            // Chemical potential contributions in Jacobian
-            J.block(0,0,N,N) = HtotV;
-            J.block(0,N,N,N) = -HtotL1;
+            // Chemical potential contributions in Jacobian; the blocks are the Hessians of Psi in each phase, 
+            // the residual Hessians plus the ideal-gas contributions on the diagonal (as in build_Psi_Hessian_autodiff)
+            J.block(0,0,N,N) = hessianV;
+            J.block(0,0,N,N).diagonal().array() += RTV/rhovecV;
+            J.block(0,N,N,N) = -hessianL1;
+            J.block(0,N,N,N).diagonal().array() -= RTL1/rhovecL1;
             //J.block(0,2*N,N,N) = 0;  (following the pattern, to make clear the structure)
             //J.block(N,0,N,N) = 0;   (following the pattern, to make clear the structure)
-            J.block(N, N, N, N) = HtotL1;
-            J.block(N, 2 * N, N, N) = -HtotL2;
+            J.block(N, N, N, N) = -J.block(0, N, N, N);
+            J.block(N, 2 * N, N, N) = -hessianL2;
+            J.block(N, 2 * N, N, N).diagonal().array() -= RTL2/rhovecL2;
             // Pressure contributions in Jacobian
             J.block(2 * N, 0, 1, N) = dpdrhovecV.transpose();
             J.block(2 * N, N, 1, N) = -dpdrhovecL1.transpose();
@@ -83,17 +90,15 @@ namespace teqp {
             J.block(2 * N + 1, 2 * N, 1, N) = -dpdrhovecL2.transpose();
 
             // Solve for the step
-            Eigen::ArrayXd dx = J.colPivHouseholderQr().solve(-r);
+            stepsolver.solve(J, -r, dx);
             x.array() += dx;
 
-            auto xtol_threshold = (axtol + relxtol * x.array().cwiseAbs()).eval();
-            if ((dx.array() < xtol_threshold).all()) {
+            if ((dx.cwiseAbs() < axtol + relxtol * x.array().cwiseAbs()).all()) {
                 return_code = VLLE_return_code::xtol_satisfied;
                 break;
             }
 
-            auto error_threshold = (atol + reltol * r.array().cwiseAbs()).eval();
-            if ((r.array().cwiseAbs() < error_threshold).all()) {
+            if ((r.array().cwiseAbs() < atol + reltol * r.array().cwiseAbs()).all()) {
                 return_code = VLLE_return_code::functol_satisfied;
                 break;
             }
@@ -1,5 +1,11 @@
 #pragma once
 
+#include <cmath>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+
 #include "nlohmann/json.hpp"
 
 #include <Eigen/Dense>
@@ -8,6 +14,30 @@
 #include "teqp/exceptions.hpp"
 
 namespace teqp {
+    /// True if the model provides the saturated densities of the pure fluid from a superancillary, as superanc_rhoLV(T)
+    template<typename Model, typename = void>
+    struct has_superanc_rhoLV : std::false_type {};
+    template<typename Model>
+    struct has_superanc_rhoLV<Model, std::void_t<decltype(std::declval<const Model&>().superanc_rhoLV(1.0))>> : std::true_type {};
+
+    namespace detail {
+        /// The saturated densities from the superancillary of the model, or nothing if the model has none, 
+        /// is not a pure fluid, or T is outside the range of the superancillary
+        template<typename Model>
+        std::optional<std::tuple<double, double>> try_superanc_rhoLV(const Model& model, double T) {
+            if constexpr (has_superanc_rhoLV<Model>::value) {
+                try {
+                    auto [rhoL, rhoV] = model.superanc_rhoLV(T);
+                    if (std::isfinite(rhoL) && std::isfinite(rhoV)) {
+                        return std::make_tuple(static_cast<double>(rhoL), static_cast<double>(rhoV));
+                    }
+                }
+                catch (const std::invalid_argument&) {}
+            }
+            return std::nullopt;
+        }
+    }
+
     /**
     * Calculate the criticality conditions for a pure fluid and its Jacobian w.r.t. the temperature and density
     * for additional fine tuning with multi-variate rootfinding
@@ -87,6 +117,13 @@ namespace teqp {
         return std::make_tuple(x[0], x[1]);
     }
 
+    /**
+    * \brief The saturated liquid and vapor densities close to the critical point, from the critical point and the
+    * leading term of the expansion of the coexistence curve
+    *
+    * This is always the extrapolation, also for models with a superancillary; see superanc_or_extrapolate to use the
+    * superancillary when there is one
+    */
     template<typename Model, typename Scalar>
     Eigen::ArrayXd extrapolate_from_critical(const Model& model, const Scalar& Tc, const Scalar& rhoc, const Scalar& T) {
 
@@ -110,4 +147,23 @@ namespace teqp {
         auto rhovap = drhohat / sqrt(1 - T / Tc) + rhoc;
         return (Eigen::ArrayXd(2) << rholiq, rhovap).finished();
     }
+
+    /**
+    * \brief The saturated liquid and vapor densities from the superancillary of the model if it has one (see 
+    * has_superanc_rhoLV) and T is below Tc and in its range, or else from extrapolate_from_critical
+    *
+    * For the canonical cubics, the superancillary gives the saturated densities of the model to nearly double precision. 
+    * For SaturationSurrogateModel, it gives the densities of the surrogate, which are only as exact as the surrogate
+    */
+    template<typename Model, typename Scalar>
+    Eigen::ArrayXd superanc_or_extrapolate(const Model& model, const Scalar& Tc, const Scalar& rhoc, const Scalar& T) {
+        if constexpr (has_superanc_rhoLV<Model>::value && std::is_same_v<Scalar, double>) {
+            if (T < Tc) {
+                if (auto rhos = detail::try_superanc_rhoLV(model, T)) {
+                    return (Eigen::ArrayXd(2) << std::get<0>(*rhos), std::get<1>(*rhos)).finished();
+                }
+            }
+        }
+        return extrapolate_from_critical(model, Tc, rhoc, T);
+    }
 };
\ No newline at end of file
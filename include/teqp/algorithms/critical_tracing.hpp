@@ -1,7 +1,13 @@
 #pragma once
 
+#include <cmath>
 #include <fstream>
+#include <limits>
+#include <memory>
 #include <optional>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "nlohmann/json.hpp"
 
@@ -9,6 +15,7 @@
 #include "teqp/algorithms/rootfinding.hpp"
 #include "teqp/algorithms/critical_pure.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/parallel.hpp"
 
 // Imports from boost
 #include <boost/numeric/odeint/stepper/controlled_runge_kutta.hpp>
@@ -39,8 +46,195 @@ struct TCABOptions {
     bool pure_endpoint_polish = false; ///< If true, if the last step crossed into negative concentrations, try to interpolate to find the pure fluid endpoint hiding in the data
 };
 
+/// Selection of the derived quantities that are calculated at each point of a critical trace that is passed to an observer
+struct CriticalTraceColumns {
+    bool p = true; ///< The pressure
+    bool splus = true; ///< The scaled residual entropy \f$s^+\f$
+    bool derivatives = true; ///< The derivatives of T and the molar concentrations with respect to the tracing variable
+    bool criticality_conditions = true; ///< The two criticality conditions
+};
+
+/// One accepted point of a critical trace; the optional members are only populated if they were selected in the CriticalTraceColumns
+struct CriticalTracePoint {
+    double t; ///< The tracing variable
+    double T; ///< Temperature, in K
+    double c; ///< The direction of tracing, 1 or -1
+    Eigen::ArrayXd rhovec; ///< Molar concentrations, in mol/m^3
+    std::optional<double> p; ///< Pressure, in Pa
+    std::optional<double> splus; ///< The scaled residual entropy
+    std::optional<double> dTdt; ///< Derivative of T w.r.t. the tracing variable
+    std::optional<Eigen::ArrayXd> drhovecdt; ///< Derivatives of the molar concentrations w.r.t. the tracing variable
+    std::optional<Eigen::ArrayXd> criticality_conditions; ///< The two criticality conditions
+    std::optional<bool> locally_stable; ///< The local stability, if TCABOptions::calc_stability is true
+};
+
+/**
+* \brief Pass a point to an observer of a trace
+* 
+* The observer is called as observer(point). If it returns a bool, false requests that the tracing be stopped 
+* after this point; an observer returning void never stops the tracing
+* \returns true if the tracing should continue
+*/
+template<typename Observer, typename Point>
+bool notify_observer(const Observer& observer, const Point& point) {
+    if constexpr (std::is_same_v<std::invoke_result_t<const Observer&, const Point&>, bool>) {
+        return observer(point);
+    }
+    else {
+        observer(point);
+        return true;
+    }
+}
+
+namespace detail {
+    /// Append the entries of v to a set of columns, one column per entry; the columns are created on the first call
+    inline void append_to_columns(std::vector<std::vector<double>>& columns, const Eigen::ArrayXd& v) {
+        if (columns.empty()) {
+            columns.resize(v.size());
+        }
+        if (columns.size() != static_cast<std::size_t>(v.size())) {
+            throw teqp::InvalidArgument("Length of row (" + std::to_string(v.size()) + ") does not match the number of columns (" + std::to_string(columns.size()) + ")");
+        }
+        for (auto k = 0; k < v.size(); ++k) {
+            columns[k].push_back(v[k]);
+        }
+    }
+    /**
+    * \brief The eigenvalues and eigenvectors of a symmetric 2x2 matrix, in closed form
+    *
+    * The eigenvalues are sorted in increasing order and the eigenvectors are the columns of the matrix, as returned 
+    * by Eigen::SelfAdjointEigenSolver, though the signs of the eigenvectors may differ
+    */
+    inline auto sorted_symmetric_eigen_2x2(const Eigen::Matrix2d& H) {
+        const double a = H(0, 0), b = H(0, 1), c = H(1, 1);
+        const double mean = (a + c) / 2, radius = std::hypot((a - c) / 2, b);
+        Eigen::Vector2d eigenvalues(mean - radius, mean + radius);
+        // Of the two (parallel) candidates for the first eigenvector, take the longer one, for numerical stability
+        Eigen::Vector2d u0(eigenvalues[0] - c, b), u1(b, eigenvalues[0] - a);
+        Eigen::Vector2d v0 = (u0.squaredNorm() >= u1.squaredNorm()) ? u0 : u1;
+        double norm = v0.norm();
+        if (norm == 0) {
+            // A multiple of the identity matrix; any orthonormal pair is a solution
+            v0 << 1, 0;
+        }
+        else {
+            v0 /= norm;
+        }
+        Eigen::Matrix2d eigenvectors;
+        eigenvectors.col(0) = v0;
+        eigenvectors.col(1) << -v0[1], v0[0];
+        return std::make_tuple(eigenvalues, eigenvectors);
+    }
+
+    /// Gather the i-th entry of each of a set of columns into an array
+    inline Eigen::ArrayXd row_of_columns(const std::vector<std::vector<double>>& columns, std::size_t i) {
+        Eigen::ArrayXd v(columns.size());
+        for (auto k = 0U; k < columns.size(); ++k) {
+            v[k] = columns[k][i];
+        }
+        return v;
+    }
+}
+
+/// Convert a point of a critical trace into the JSON representation returned by trace_critical_arclength_binary; unpopulated quantities are skipped
+inline nlohmann::json critical_trace_point_to_JSON(const CriticalTracePoint& pt) {
+    nlohmann::json point = {
+        {"t", pt.t},
+        {"T / K", pt.T},
+        {"rho0 / mol/m^3", pt.rhovec[0]},
+        {"rho1 / mol/m^3", pt.rhovec[1]},
+        {"c", pt.c},
+    };
+    if (pt.splus) { point["s^+"] = pt.splus.value(); }
+    if (pt.p) { point["p / Pa"] = pt.p.value(); }
+    if (pt.dTdt) { point["dT/dt"] = pt.dTdt.value(); }
+    if (pt.drhovecdt) {
+        point["drho0/dt"] = pt.drhovecdt.value()[0];
+        point["drho1/dt"] = pt.drhovecdt.value()[1];
+    }
+    if (pt.criticality_conditions) {
+        point["lambda1"] = pt.criticality_conditions.value()[0];
+        point["dirderiv(lambda1)/dalpha"] = pt.criticality_conditions.value()[1];
+    }
+    if (pt.locally_stable) { point["locally stable"] = pt.locally_stable.value(); }
+    return point;
+}
+
+/**
+* \brief The points of a critical trace, stored column-wise
+*
+* Each quantity has its own contiguous column, so that post-processing does not need to pick the
+* values out of per-point objects. The vector quantities have one column per component. The columns
+* of quantities that were not selected in the CriticalTraceColumns are empty.
+*/
+struct CriticalTraceData {
+    std::vector<double> t, ///< The tracing variable
+        T, ///< Temperature, in K
+        c, ///< The direction of tracing
+        p, ///< Pressure, in Pa
+        splus, ///< The scaled residual entropy
+        dTdt, ///< Derivative of T w.r.t. the tracing variable
+        lambda1, ///< The first criticality condition
+        dirderiv_lambda1; ///< The second criticality condition
+    std::vector<std::vector<double>> rhovec, ///< Molar concentrations, in mol/m^3
+        drhovecdt; ///< Derivatives of the molar concentrations w.r.t. the tracing variable
+    std::vector<bool> locally_stable; ///< The local stability, if it was calculated
+
+    /// The number of points
+    std::size_t size() const { return T.size(); }
+
+    /// Append a point to the columns
+    void push_back(const CriticalTracePoint& pt) {
+        t.push_back(pt.t); T.push_back(pt.T); c.push_back(pt.c);
+        detail::append_to_columns(rhovec, pt.rhovec);
+        if (pt.p) { p.push_back(pt.p.value()); }
+        if (pt.splus) { splus.push_back(pt.splus.value()); }
+        if (pt.dTdt) { dTdt.push_back(pt.dTdt.value()); }
+        if (pt.drhovecdt) { detail::append_to_columns(drhovecdt, pt.drhovecdt.value()); }
+        if (pt.criticality_conditions) {
+            lambda1.push_back(pt.criticality_conditions.value()[0]);
+            dirderiv_lambda1.push_back(pt.criticality_conditions.value()[1]);
+        }
+        if (pt.locally_stable) { locally_stable.push_back(pt.locally_stable.value()); }
+    }
+
+    /// Reassemble the i-th point from the columns
+    CriticalTracePoint point(std::size_t i) const {
+        CriticalTracePoint pt{ t[i], T[i], c[i], detail::row_of_columns(rhovec, i) };
+        if (!p.empty()) { pt.p = p[i]; }
+        if (!splus.empty()) { pt.splus = splus[i]; }
+        if (!dTdt.empty()) { pt.dTdt = dTdt[i]; }
+        if (!drhovecdt.empty()) { pt.drhovecdt = detail::row_of_columns(drhovecdt, i); }
+        if (!lambda1.empty()) { pt.criticality_conditions = (Eigen::ArrayXd(2) << lambda1[i], dirderiv_lambda1[i]).finished(); }
+        if (!locally_stable.empty()) { pt.locally_stable = locally_stable[i]; }
+        return pt;
+    }
+
+    /// A view of the data as a JSON array with one object per point, as returned by trace_critical_arclength_binary
+    nlohmann::json to_JSON() const {
+        auto JSONdata = nlohmann::json::array();
+        for (auto i = 0U; i < size(); ++i) {
+            JSONdata.push_back(critical_trace_point_to_JSON(point(i)));
+        }
+        return JSONdata;
+    }
+};
+
+/**
+* \brief Tracing of critical curves and the underlying calculations with the Hessian of \f$\Psi\f$
+*
+* If VecType has a size known at compile time (Eigen::Array2d for a binary mixture), the Hessians, eigenvectors,
+* and other intermediate arrays have that fixed size as well, and the eigenvalue problem of a binary mixture
+* is solved in closed form
+*/
 template<typename Model, typename Scalar = double, typename VecType = Eigen::ArrayXd>
 struct CriticalTracing {
+
+    /// The number of components if it is known at compile time, otherwise Eigen::Dynamic
+    static constexpr int Ncomp = detail::compile_time_size_v<VecType>;
+    using ArrayN = Eigen::Array<double, Ncomp, 1>;
+    using MatrixNN = Eigen::Matrix<double, Ncomp, Ncomp>;
+
     /***
     * \brief Simple wrapper to sort the eigenvalues(and associated eigenvectors) in increasing order
     * \param H The matrix, in this case, the Hessian matrix of Psi w.r.t.the molar concentrations
@@ -57,19 +251,36 @@ struct CriticalTracing {
         return std::make_tuple(es.eigenvalues(), es.eigenvectors());
     }
 
+    /// The same as sorted_eigen, for a matrix of fixed size; the 2x2 case is solved in closed form
+    template<int N>
+    static auto sorted_eigen(const Eigen::Matrix<double, N, N>& H) {
+        if constexpr (N == 2) {
+            return detail::sorted_symmetric_eigen_2x2(H);
+        }
+        else {
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix<double, N, N>> es(H);
+            return std::make_tuple(es.eigenvalues(), es.eigenvectors());
+        }
+    }
+
     struct EigenData {
-        Eigen::ArrayXd v0, v1, eigenvalues;
-        Eigen::MatrixXd eigenvectorscols;
+        ArrayN v0, v1, eigenvalues;
+        MatrixNN eigenvectorscols;
     };
 
-    static auto eigen_problem(const Model& model, const Scalar T, const VecType& rhovec, const VecType& alignment_v0 = {}) {
+    /// The default alignment vector, which does not change the signs of the eigenvectors: empty, or zero if the size is fixed
+    static VecType no_alignment() {
+        return VecType::Zero((Ncomp == Eigen::Dynamic) ? 0 : Ncomp);
+    }
+
+    static auto eigen_problem(const Model& model, const Scalar T, const VecType& rhovec, const VecType& alignment_v0 = no_alignment()) {
 
         EigenData ed;
 
         auto N = rhovec.size();
-        Eigen::ArrayX<bool> mask = (rhovec != 0).eval();
+        Eigen::Array<bool, Ncomp, 1> mask = (rhovec != 0).eval();
 
-        using id = IsochoricDerivatives<decltype(model)>;
+        using id = IsochoricDerivatives<Model, Scalar, VecType>;
 
         // Build the Hessian for the residual part;
 #if defined(USE_AUTODIFF)
@@ -129,7 +340,15 @@ struct CriticalTracing {
             // We insist that there must be only one non-zero entry
             U.row(U.rows() - 1)(badindex) = 1.0;
 
-            ed.eigenvalues = eigenvalues;
+            if constexpr (Ncomp == Eigen::Dynamic) {
+                ed.eigenvalues = eigenvalues;
+            }
+            else {
+                // The storage has room for N eigenvalues; the one in the direction of the pure component goes 
+                // to infinity in the limit of infinite dilution
+                ed.eigenvalues.head(N - 1) = eigenvalues;
+                ed.eigenvalues(N - 1) = std::numeric_limits<double>::infinity();
+            }
             ed.eigenvectorscols = U.transpose();
         }
         else {
@@ -145,7 +364,7 @@ struct CriticalTracing {
     }
 
     struct psi1derivs {
-        Eigen::ArrayXd psir, psi0, tot;
+        Eigen::Array<double, 5, 1> psir, psi0, tot;
         EigenData ei;
     };
 
@@ -153,7 +372,7 @@ struct CriticalTracing {
         return eigen_problem(model, T, rhovec).eigenvalues[0];
     }
 
-    static auto get_derivs(const Model& model, const Scalar T, const VecType& rhovec, const VecType& alignment_v0 = {}) {
+    static auto get_derivs(const Model& model, const Scalar T, const VecType& rhovec, const VecType& alignment_v0 = no_alignment()) {
         auto molefrac = rhovec / rhovec.sum();
         auto R = model.R(molefrac);
 
@@ -161,7 +380,7 @@ struct CriticalTracing {
         auto ei = eigen_problem(model, T, rhovec, alignment_v0);
 
         // Ideal-gas contributions of psi0 w.r.t. sigma_1, in the same form as the residual part
-        Eigen::ArrayXd psi0_derivs(5); psi0_derivs.setZero();
+        Eigen::Array<double, 5, 1> psi0_derivs; psi0_derivs.setZero();
         psi0_derivs[0] = -1; // Placeholder, not needed
         psi0_derivs[1] = -1; // Placeholder, not needed
         for (auto i = 0; i < rhovec.size(); ++i) {
@@ -174,8 +393,9 @@ struct CriticalTracing {
 
 #if defined(USE_AUTODIFF)
         // Calculate the first through fourth derivative of Psi^r w.r.t. sigma_1
-        ArrayXdual4th v0(ei.v0.size()); for (auto i = 0; i < ei.v0.size(); ++i) { v0[i] = ei.v0[i]; }
-        ArrayXdual4th rhovecad(rhovec.size());  for (auto i = 0; i < rhovec.size(); ++i) { rhovecad[i] = rhovec[i]; }
+        Eigen::Array<dual4th, Ncomp, 1> v0, rhovecad; v0.resize(ei.v0.size()); rhovecad.resize(rhovec.size());
+        for (auto i = 0; i < ei.v0.size(); ++i) { v0[i] = ei.v0[i]; }
+        for (auto i = 0; i < rhovec.size(); ++i) { rhovecad[i] = rhovec[i]; }
         dual4th varsigma{ 0.0 };
         auto wrapper = [&rhovecad, &v0, &T, &model](const auto& sigma_1) {
             auto rhovecused = (rhovecad + sigma_1 * v0).eval();
@@ -184,7 +404,7 @@ struct CriticalTracing {
             return eval(model.alphar(T, rhotot, molefrac) * model.R(molefrac) * T * rhotot);
         };
         auto psir_derivs_ = derivatives(wrapper, wrt(varsigma), at(varsigma));
-        VecType psir_derivs; psir_derivs.resize(5);
+        Eigen::Array<double, 5, 1> psir_derivs;
         for (auto i = 0; i < 5; ++i) { psir_derivs[i] = psir_derivs_[i]; }
 
 #else
@@ -200,7 +420,7 @@ struct CriticalTracing {
             return model.alphar(T, rhotot, molefrac) * model.R(molefrac) * T * rhotot;
         };
         auto psir_derivs_ = diff_mcx1(wrapper, 0.0, 4, true);
-        VecType psir_derivs; psir_derivs.resize(5);
+        Eigen::Array<double, 5, 1> psir_derivs;
         for (auto i = 0; i < 5; ++i) { psir_derivs[i] = psir_derivs_[i]; }
 #endif
 
@@ -279,13 +499,13 @@ struct CriticalTracing {
         }
 
         // The columns of b are from Eq. 31 and Eq. 33
-        Eigen::MatrixXd b(2, 2);
+        Eigen::Matrix2d b;
         b << derivs[3], derivs[4],             // row is d^3\Psi/d\sigma_1^3, d^4\Psi/d\sigma_1^4
             deriv_sigma2[2], deriv_sigma2[3]; // row is d/d\sigma_2(d^3\Psi/d\sigma_1^3), d/d\sigma_2(d^3\Psi/d\sigma_1^3)
 
         auto LHS = (ei.eigenvectorscols * b).transpose();
-        Eigen::MatrixXd RHS(2, 1); RHS << -derivT[2], -derivT[3];
-        Eigen::MatrixXd drhovec_dT = LHS.colPivHouseholderQr().solve(RHS);
+        Eigen::Vector2d RHS; RHS << -derivT[2], -derivT[3];
+        Eigen::Matrix<double, Ncomp, (Ncomp == Eigen::Dynamic) ? Eigen::Dynamic : 1> drhovec_dT = LHS.colPivHouseholderQr().solve(RHS);
 
 #if defined(DEBUG_get_drhovec_dT_crit)
         std::cout << "LHS: " << LHS << std::endl;
@@ -306,7 +526,7 @@ struct CriticalTracing {
 
     static auto get_criticality_conditions(const Model& model, const Scalar T, const VecType& rhovec) {
         auto derivs = get_derivs(model, T, rhovec);
-        return (Eigen::ArrayXd(2) << derivs.tot[2], derivs.tot[3]).finished();
+        return (Eigen::Array2d() << derivs.tot[2], derivs.tot[3]).finished();
     }
 
     /**
@@ -414,11 +634,28 @@ struct CriticalTracing {
         return x;
     }
 
-    static auto trace_critical_arclength_binary(const Model& model, const Scalar& T0, const VecType& rhovec0, const std::optional<std::string>& filename_ = std::nullopt, const std::optional<TCABOptions> &options_ = std::nullopt) -> nlohmann::json {
+    /**
+    * \brief Trace the critical locus of a binary mixture, passing each accepted point to an observer
+    * 
+    * No JSON is built; the observer receives a CriticalTracePoint for each point, with the derived quantities 
+    * selected in columns, and can stream or aggregate the points as it sees fit. If the observer returns a bool, 
+    * returning false stops the tracing
+    * 
+    * \param model The model
+    * \param T0 The starting temperature
+    * \param rhovec0 The starting molar concentrations
+    * \param observer The callable receiving each point, as observer(const CriticalTracePoint&)
+    * \param columns The derived quantities to be calculated for each point
+    * \param filename_ If provided, the points are also written to this CSV file
+    * \param options_ The options for the tracing
+    * \returns The number of points passed to the observer
+    */
+    template<typename Observer>
+    static std::size_t trace_critical_arclength_binary_observed(const Model& model, const Scalar& T0, const VecType& rhovec0, const Observer& observer, const CriticalTraceColumns& columns = {}, const std::optional<std::string>& filename_ = std::nullopt, const std::optional<TCABOptions>& options_ = std::nullopt) {
         std::string filename = filename_.value_or("");
         TCABOptions options = options_.value_or(TCABOptions{});
 
-        VecType last_drhodt;
+        Eigen::ArrayXd last_drhodt; // Empty until the first derivative is stored
 
         // Typedefs for the types for odeint for simple Euler and RK45 integrators
         using state_type = std::vector<double>; 
@@ -430,7 +667,8 @@ struct CriticalTracing {
         auto dot = [](const auto& v1, const auto& v2) { return (v1 * v2).sum(); };
         auto norm = [](const auto& v) { return sqrt((v * v).sum()); };
 
-        auto JSONdata = nlohmann::json::array();
+        std::size_t Npoints = 0;
+        bool keep_going = true;
         std::ofstream ofs = (filename.empty()) ? std::ofstream() : std::ofstream(filename);
         
         double c = options.init_c; 
@@ -441,18 +679,18 @@ struct CriticalTracing {
         {
             // Unpack the inputs
             const double T = x[0];
-            const auto rhovec = Eigen::Map<const Eigen::ArrayXd>(&(x[0]) + 1, x.size() - 1);
+            const auto rhovec = Eigen::Map<const ArrayN>(&(x[0]) + 1, x.size() - 1);
             if (options.terminate_negative_density && rhovec.minCoeff() < 0) {
                 throw std::invalid_argument("Density is negative");
             }
             
             auto drhodT = get_drhovec_dT_crit(model, T, rhovec).array().eval();
             auto dTdt = 1.0 / norm(drhodT);
-            Eigen::ArrayXd drhodt = c * (drhodT * dTdt).eval();
+            ArrayN drhodt = c * (drhodT * dTdt).eval();
 
             dxdt[0] = c*dTdt;
 
-            auto drhodtview = Eigen::Map<Eigen::ArrayXd>(&(dxdt[0]) + 1, dxdt.size() - 1); 
+            auto drhodtview = Eigen::Map<ArrayN>(&(dxdt[0]) + 1, dxdt.size() - 1); 
             drhodtview = drhodt; // Copy values into the view
 
             if (last_drhodt.size() > 0) {
@@ -490,7 +728,7 @@ struct CriticalTracing {
         // Make variables T and rhovec references to the contents of x0 vector
         // The views are mutable (danger!)
         double& T = x0[0];
-        auto rhovec = Eigen::Map<Eigen::ArrayXd>(&(x0[0]) + 1, x0.size() - 1);
+        auto rhovec = Eigen::Map<ArrayN>(&(x0[0]) + 1, x0.size() - 1);
 
         auto store_drhodt = [&](const state_type& x0) {
             last_drhodt = extract_drhodt(get_dxdt(x0));
@@ -498,34 +736,30 @@ struct CriticalTracing {
 
         auto store_point = [&]() {
 
-            // Calculate some other parameters, for debugging, or scientific interest
-            auto rhotot = rhovec.sum();
-            using id = IsochoricDerivatives<decltype(model), Scalar, VecType>;
-            double p = rhotot * model.R(rhovec / rhovec.sum()) * T + id::get_pr(model, T, rhovec);
-            auto conditions = get_criticality_conditions(model, T, rhovec);
-            double splus = id::get_splus(model, T, rhovec);
-            auto dxdt = x0;
-            xprime(x0, dxdt, -1.0);
-
-            // Store the data in a JSON structure
-            nlohmann::json point = {
-                {"t", t},
-                {"T / K", T},
-                {"rho0 / mol/m^3", static_cast<double>(rhovec[0])},
-                {"rho1 / mol/m^3", static_cast<double>(rhovec[1])},
-                {"c", c},
-                {"s^+", splus},
-                {"p / Pa", p},
-                {"dT/dt", dxdt[0]},
-                {"drho0/dt", dxdt[1]},
-                {"drho1/dt", dxdt[2]},
-                {"lambda1", conditions[0]},
-                {"dirderiv(lambda1)/dalpha", conditions[1]},
-            };
+            // Calculate the selected derived quantities, for debugging, or scientific interest
+            using id = IsochoricDerivatives<Model, Scalar, VecType>;
+            CriticalTracePoint point{ t, T, c, rhovec };
+            if (columns.p) {
+                auto rhotot = rhovec.sum();
+                point.p = rhotot * model.R(rhovec / rhovec.sum()) * T + id::get_pr(model, T, rhovec);
+            }
+            if (columns.criticality_conditions) {
+                point.criticality_conditions = get_criticality_conditions(model, T, rhovec);
+            }
+            if (columns.splus) {
+                point.splus = id::get_splus(model, T, rhovec);
+            }
+            if (columns.derivatives) {
+                auto dxdt = x0;
+                xprime(x0, dxdt, -1.0);
+                point.dTdt = extract_dTdt(dxdt);
+                point.drhovecdt = extract_drhodt(dxdt);
+            }
             if (options.calc_stability) {
-                point["locally stable"] = is_locally_stable(model, T, rhovec, options.stability_rel_drho);
+                point.locally_stable = is_locally_stable(model, T, rhovec, options.stability_rel_drho);
             }
-            JSONdata.push_back(point);
+            Npoints++;
+            keep_going = notify_observer(observer, point);
         };
 
         // Line writer
@@ -533,7 +767,7 @@ struct CriticalTracing {
             std::stringstream out;
             auto rhotot = rhovec.sum();
             double z0 = rhovec[0] / rhotot;
-            using id = IsochoricDerivatives<decltype(model)>;
+            using id = IsochoricDerivatives<Model, Scalar, VecType>;
             auto conditions = get_criticality_conditions(model, T, rhovec);
             out << z0 << "," << rhovec[0] << "," << rhovec[1] << "," << T << "," << rhotot * model.R(rhovec / rhovec.sum()) * T + id::get_pr(model, T, rhovec) << "," << c << "," << dt << "," << conditions(0) << "," << conditions(1) << std::endl;
             std::string sout(out.str());
@@ -567,7 +801,9 @@ struct CriticalTracing {
             auto x_start_step = x0;
 
             if (iter == 0 && retry_count == 0) { 
-                store_point(); }
+                store_point(); 
+                if (!keep_going) { break; }
+            }
             
             if (options.integration_order == 5) {
                 auto res = controlled_step_result::fail;
@@ -716,6 +952,7 @@ struct CriticalTracing {
 
             if (!filename.empty()) { write_line(); }
             store_point();
+            if (!keep_going) { break; }
 
             if (counter_T_converged > options.small_T_count) {
                 if (options.verbosity > 10){
@@ -726,7 +963,7 @@ struct CriticalTracing {
         }
         // If the last step crosses a zero concentration, see if it corresponds to a pure fluid
         // and if so, iterate to find the pure fluid endpoint
-        if (options.pure_endpoint_polish) {
+        if (options.pure_endpoint_polish && keep_going) {
             // Simple Euler step t
             auto dxdt = get_dxdt(x0);
             auto drhodt = extract_drhodt(dxdt);
@@ -761,10 +998,135 @@ struct CriticalTracing {
                 store_point();
             }
         }
-        //auto N = JSONdata.size();
-        return JSONdata;
+        return Npoints;
+    }
+
+    /**
+    * \brief Trace the critical locus of a binary mixture, storing the points column-wise
+    * 
+    * See trace_critical_arclength_binary_observed for the meaning of the arguments
+    */
+    static CriticalTraceData trace_critical_arclength_binary_columnar(const Model& model, const Scalar& T0, const VecType& rhovec0, const CriticalTraceColumns& columns = {}, const std::optional<std::string>& filename_ = std::nullopt, const std::optional<TCABOptions>& options_ = std::nullopt) {
+        CriticalTraceData data;
+        trace_critical_arclength_binary_observed(model, T0, rhovec0, [&data](const CriticalTracePoint& pt) { data.push_back(pt); }, columns, filename_, options_);
+        return data;
+    }
+
+    /**
+    * \brief Trace the critical locus of a binary mixture, storing all the points in JSON
+    * 
+    * See trace_critical_arclength_binary_columnar for the version that stores the points column-wise, and 
+    * trace_critical_arclength_binary_observed for the version that passes each point to a callback instead
+    */
+    static auto trace_critical_arclength_binary(const Model& model, const Scalar& T0, const VecType& rhovec0, const std::optional<std::string>& filename_ = std::nullopt, const std::optional<TCABOptions> &options_ = std::nullopt) -> nlohmann::json {
+        return trace_critical_arclength_binary_columnar(model, T0, rhovec0, CriticalTraceColumns{}, filename_, options_).to_JSON();
     }
 
 }; // namespace VecType
 
+/// The outcome of one trace in a batch of critical locus traces
+struct CriticalTraceResult {
+    std::size_t index = 0; ///< The index of the job in the batch, or the index of the key when the jobs are built from keys
+    std::string label; ///< The label of the job, passed through unchanged
+    bool success = false; ///< True if the trace completed without throwing
+    nlohmann::json trace; ///< The trace, as returned by trace_critical_arclength_binary; null if the trace failed
+    std::string message; ///< The message of the exception if the trace failed
+};
+
+/// One trace to be carried out in a batch: the model (which may be shared between jobs) and the starting point
+template<typename Model>
+struct CriticalTraceJob {
+    std::string label; ///< A label to identify the job in the results, e.g., the names of the fluids
+    std::shared_ptr<const Model> model; ///< The model; only const methods are called, so it can be shared between jobs
+    double T0; ///< The starting temperature, in K
+    Eigen::ArrayXd rhovec0; ///< The starting molar concentrations, in mol/m^3
+    std::optional<std::string> filename = std::nullopt; ///< If provided, the trace is also written to this file
+    std::optional<TCABOptions> options = std::nullopt; ///< If not provided, the options of the batch are used
+};
+
+/**
+* \brief Carry out a batch of critical locus traces concurrently
+* 
+* The jobs are handed out dynamically to the threads, so a few long traces do not hold up the others. A trace 
+* that throws does not affect the other traces; the exception message is stored in its result
+* 
+* \param jobs The traces to be carried out
+* \param options The tracing options for jobs that do not specify their own
+* \param Nthreads The number of threads; if 0, the number of hardware threads
+* \returns One result per job, in the same order as the jobs
+*/
+template<typename Model>
+auto trace_critical_arclength_binary_batch(const std::vector<CriticalTraceJob<Model>>& jobs, const std::optional<TCABOptions>& options = std::nullopt, std::size_t Nthreads = 0) {
+    std::vector<CriticalTraceResult> results(jobs.size());
+    parallel_for_dynamic(jobs.size(), Nthreads, [&](std::size_t i) {
+        const auto& job = jobs[i];
+        auto& result = results[i];
+        result.index = i;
+        result.label = job.label;
+        try {
+            if (!job.model) {
+                throw teqp::InvalidArgument("No model was provided");
+            }
+            using ct = CriticalTracing<Model, double, Eigen::ArrayXd>;
+            result.trace = ct::trace_critical_arclength_binary(*job.model, job.T0, job.rhovec0, job.filename, (job.options) ? job.options : options);
+            result.success = true;
+        }
+        catch (const std::exception& e) {
+            result.message = e.what();
+        }
+    });
+    return results;
+}
+
+/**
+* \brief Build the jobs for each key (e.g., a pair of fluid names) and carry out all the traces concurrently
+*
+* Building the jobs (loading the model, finding the starting points) is also done in parallel. The function
+* make_jobs(key) returns a std::vector<CriticalTraceJob<Model>>; if it throws, a failed result with the index of 
+* the key is stored instead of the traces for that key. The results are grouped by key, in the order of the keys, 
+* and their index is the index of the key
+*
+* \param keys The keys, one per model
+* \param make_jobs The callable building the jobs for one key
+* \param options The tracing options for jobs that do not specify their own
+* \param Nthreads The number of threads; if 0, the number of hardware threads
+*/
+template<typename Key, typename JobFactory>
+auto trace_critical_arclength_binary_batch(const std::vector<Key>& keys, const JobFactory& make_jobs, const std::optional<TCABOptions>& options = std::nullopt, std::size_t Nthreads = 0) {
+    using Jobs = std::decay_t<decltype(make_jobs(keys[0]))>;
+    std::vector<Jobs> jobs_per_key(keys.size());
+    std::vector<std::optional<std::string>> errors(keys.size());
+    parallel_for_dynamic(keys.size(), Nthreads, [&](std::size_t i) {
+        try {
+            jobs_per_key[i] = make_jobs(keys[i]);
+        }
+        catch (const std::exception& e) {
+            errors[i] = e.what();
+        }
+    });
+
+    // Flatten the jobs, keeping track of where the failed keys go in the output
+    Jobs jobs;
+    for (const auto& j : jobs_per_key) {
+        jobs.insert(jobs.end(), j.begin(), j.end());
+    }
+    auto traced = trace_critical_arclength_binary_batch(jobs, options, Nthreads);
+
+    std::vector<CriticalTraceResult> results;
+    std::size_t ijob = 0;
+    for (auto i = 0U; i < keys.size(); ++i) {
+        if (errors[i]) {
+            CriticalTraceResult failed;
+            failed.index = i;
+            failed.message = errors[i].value();
+            results.push_back(failed);
+        }
+        for (auto k = 0U; k < jobs_per_key[i].size(); ++k, ++ijob) {
+            results.push_back(traced[ijob]);
+            results.back().index = i;
+        }
+    }
+    return results;
+}
+
 }; // namespace teqp
\ No newline at end of file
@@ -1,7 +1,49 @@
 #pragma once
 
+#include <Eigen/Dense>
+
 namespace teqp{
 
+/**
+* \brief Solve the linear systems of the steps of a Newton method, with storage that is allocated once, at construction
+*
+* The solution is the same as that of J.colPivHouseholderQr().solve(r), but the decomposition and the copy of the 
+* right-hand side are kept between calls, so that a solver loop can take its steps without allocating on the heap. 
+* N is the size of the system if it is known at compile time
+*/
+template<int N = Eigen::Dynamic>
+class NewtonStepSolver {
+private:
+    using MatrixType = Eigen::Matrix<double, N, N>;
+    Eigen::ColPivHouseholderQR<MatrixType> qr;
+    Eigen::Matrix<double, N, 1> c;
+public:
+    explicit NewtonStepSolver(Eigen::Index n) : qr(n, n) { c.resize(n); }
+
+    /// Solve J*dx = rhs for dx, which must already have the right size
+    template<typename JType, typename RhsType, typename DxType>
+    void solve(const JType& J, const RhsType& rhs, DxType& dx) {
+        qr.compute(J);
+        const Eigen::Index n = c.size(), nonzero_pivots = qr.nonzeroPivots();
+        c = rhs;
+        // Apply the Householder reflections of Q^T to the right-hand side one at a time; each is 
+        // I - tau*v*v^T, with v = [1, essential part]. This is what ColPivHouseholderQR::solve does,
+        // but without the temporaries that it allocates
+        const auto& QR = qr.matrixQR();
+        for (Eigen::Index k = 0; k < nonzero_pivots; ++k) {
+            const auto essential = QR.col(k).tail(n - k - 1);
+            const double tauw = qr.hCoeffs()(k) * (c(k) + essential.dot(c.tail(n - k - 1)));
+            c(k) -= tauw;
+            c.tail(n - k - 1) -= tauw * essential;
+        }
+        QR.topLeftCorner(nonzero_pivots, nonzero_pivots).template triangularView<Eigen::Upper>().solveInPlace(c.head(nonzero_pivots));
+        const auto& indices = qr.colsPermutation().indices();
+        for (Eigen::Index i = 0; i < n; ++i) {
+            dx(indices(i)) = (i < nonzero_pivots) ? c(i) : 0.0;
+        }
+    }
+};
+
 template<typename Callable, typename Inputs>
 auto NewtonRaphson(Callable f, const Inputs& args, double tol) {
     // Jacobian matrix
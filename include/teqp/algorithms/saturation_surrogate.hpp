@@ -0,0 +1,230 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "teqp/derivs.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/critical_pure.hpp"
+#include "teqp/models/cubicsuperancillary.hpp"
+
+namespace teqp {
+
+/// Controls of the construction of a SaturationSurrogate
+struct SaturationSurrogateOptions {
+    int Ndegree = 12; ///< The degree of the Chebyshev expansion in each interval
+    double rtol = 1e-12; ///< An interval is split until the last two Chebyshev coefficients are smaller than this (relative to the largest one for the densities, absolute for ln(p))
+    int max_depth = 20; ///< The maximum number of times an interval can be split in half
+    double Tc_margin = 1e-4; ///< The expansions end at Tc*(1-Tc_margin), because the saturation curve is singular at the critical point
+    int maxiter = 20; ///< The maximum number of Newton steps in each call of pure_VLE_T
+};
+
+/**
+* \brief Piecewise Chebyshev expansions of the saturated liquid and vapor densities and the vapor pressure of a pure fluid,
+* laid out like the superancillaries of the cubic equations of state (see CubicSuperAncillary::SuperAncillary)
+*
+* The expansions are in the temperature; the one for the pressure is of ln(p), so that the relative error is uniform
+* from the triple point, where the pressure is very small, to the critical point
+*/
+struct SaturationSurrogate {
+    const CubicSuperAncillary::SuperAncillary rhoL, ///< The saturated liquid density, in mol/m^3
+        rhoV, ///< The saturated vapor density, in mol/m^3
+        lnp; ///< The natural logarithm of the vapor pressure in Pa
+    const double Tmin, Tmax; ///< The range of temperature of the expansions, in K
+    const double rtol_achieved; ///< The largest magnitude of the last two Chebyshev coefficients (as for SaturationSurrogateOptions::rtol) in all the intervals; this estimates the relative error
+
+    /// The saturated liquid and vapor densities at the temperature T, in mol/m^3
+    auto rhoLV(double T) const { return std::make_tuple(rhoL.y(T), rhoV.y(T)); }
+
+    /// The vapor pressure at the temperature T, in Pa
+    double p(double T) const { return exp(lnp.y(T)); }
+
+    /// The number of intervals of the expansions
+    auto get_N_intervals() const { return rhoL.exps.size(); }
+};
+
+namespace detail {
+
+    /// The coefficients of the Chebyshev expansion through the values f at the Chebyshev-Lobatto nodes cos(pi*k/N), k = 0, ..., N
+    inline std::vector<double> Chebyshev_coeffs_Lobatto(const std::vector<double>& f) {
+        const auto N = static_cast<int>(f.size()) - 1;
+        std::vector<double> c(N + 1, 0.0);
+        for (auto j = 0; j <= N; ++j) {
+            double s = 0;
+            for (auto k = 0; k <= N; ++k) {
+                double w = (k == 0 || k == N) ? 0.5 : 1.0;
+                s += w * f[k] * cos(EIGEN_PI * j * k / N);
+            }
+            c[j] = 2.0 / N * s * ((j == 0 || j == N) ? 0.5 : 1.0);
+        }
+        return c;
+    }
+
+    /// The magnitude of the last two coefficients, relative to the largest one if relative is true
+    inline double Chebyshev_tail(const std::vector<double>& c, bool relative) {
+        double cmax = 0;
+        for (auto ci : c) { cmax = std::max(cmax, std::abs(ci)); }
+        const auto N = c.size() - 1;
+        return std::max(std::abs(c[N - 1]), std::abs(c[N])) / (relative ? cmax : 1.0);
+    }
+}
+
+/**
+* \brief Build piecewise Chebyshev expansions of the saturation curve of a pure fluid with adaptive splitting of the intervals
+*
+* The saturation states at the nodes are obtained with pure_VLE_T. Starting from the critical point (extrapolated down to
+* Tc*(1-Tc_margin) with superanc_or_extrapolate, so from the superancillary if the model has one), each state is solved starting from the closest state solved before;
+* if that fails, the state halfway is solved first. The range [Tmin, Tc*(1-Tc_margin)] is split in half until the
+* expansions of rhoL, rhoV and ln(p) in each interval have converged to options.rtol (or options.max_depth is reached)
+*
+* \param model The model of the pure fluid
+* \param Tmin The lowest temperature, for instance the triple point, in K
+* \param Tc The critical temperature of the model, in K
+* \param rhoc The critical density of the model, in mol/m^3
+*/
+template<typename Model>
+SaturationSurrogate build_saturation_surrogate(const Model& model, double Tmin, double Tc, double rhoc, const SaturationSurrogateOptions& options = {}) {
+    const double Tmax = Tc * (1 - options.Tc_margin);
+    if (!(Tmin < Tmax)) {
+        throw InvalidArgument("Tmin of " + std::to_string(Tmin) + " K must be below the critical temperature");
+    }
+    using tdx = TDXDerivatives<Model, double, Eigen::ArrayXd>;
+    const auto z = (Eigen::ArrayXd(1) << 1.0).finished();
+    const double R = model.R(z);
+
+    // The solved saturation states, keyed by temperature, as liquid density, vapor density and ln(p)
+    std::map<double, std::array<double, 3>> states;
+    auto try_solve = [&](double T, double rhoL0, double rhoV0, std::array<double, 3>& state) {
+        try {
+            auto rhos = pure_VLE_T(model, T, rhoL0, rhoV0, options.maxiter);
+            auto resid = IsothermPureVLEResiduals<Model>(model, T);
+            auto r = resid.call(rhos);
+            if (!rhos.isFinite().all() || !(rhos[0] > rhos[1] * (1 + 1e-6)) || rhos[1] <= 0
+                || std::abs(r[0]) > 1e-8 * rhos[0] || std::abs(r[1]) > 1e-8) {
+                return false;
+            }
+            // The pressure of the vapor is much less sensitive to the error in its density than that of the liquid
+            double p = rhos[1] * R * T * (1.0 + tdx::get_Ar01(model, T, rhos[1], z));
+            if (!(p > 0)) { return false; }
+            state = { rhos[0], rhos[1], log(p) };
+            return true;
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    };
+    auto solve = [&](double T, int depth, const auto& self) -> std::array<double, 3> {
+        if (auto it = states.find(T); it != states.end()) {
+            return it->second;
+        }
+        // Continue from the closest temperature that has been solved
+        auto hi = states.lower_bound(T);
+        auto nearest = (hi == states.end() || (hi != states.begin() && T - std::prev(hi)->first < hi->first - T)) ? std::prev(hi) : hi;
+        std::array<double, 3> state;
+        if (try_solve(T, nearest->second[0], nearest->second[1], state)) {
+            states[T] = state;
+            return state;
+        }
+        if (depth > 40) {
+            throw IterationFailure("Could not solve for the saturation state at T=" + std::to_string(T) + " K");
+        }
+        self((T + nearest->first) / 2, depth + 1, self);
+        return self(T, depth + 1, self);
+    };
+
+    {
+        auto rhos0 = superanc_or_extrapolate(model, Tc, rhoc, Tmax);
+        std::array<double, 3> state;
+        if (!try_solve(Tmax, rhos0[0], rhos0[1], state)) {
+            throw IterationFailure("Could not solve for the saturation state at T=" + std::to_string(Tmax) + " K, close to the critical point");
+        }
+        states[Tmax] = state;
+    }
+
+    // Fit the intervals from the critical point down, so that the states are solved in the order of decreasing temperature
+    std::array<std::vector<CubicSuperAncillary::Chebyshev>, 3> exps;
+    double worst_tail = 0;
+    const int N = options.Ndegree;
+    auto fit = [&](double Ta, double Tb, int depth, const auto& self) -> void {
+        std::array<std::vector<double>, 3> f;
+        for (auto k = 0; k <= N; ++k) {
+            double T = (Ta + Tb) / 2 + (Tb - Ta) / 2 * cos(EIGEN_PI * k / N); // From Tb down to Ta
+            auto state = solve(T, 0, solve);
+            for (auto i = 0; i < 3; ++i) { f[i].push_back(state[i]); }
+        }
+        std::array<std::vector<double>, 3> c;
+        double tail = 0;
+        for (auto i = 0; i < 3; ++i) {
+            c[i] = detail::Chebyshev_coeffs_Lobatto(f[i]);
+            // An absolute error in ln(p) is a relative error in p
+            tail = std::max(tail, detail::Chebyshev_tail(c[i], i != 2));
+        }
+        if (tail > options.rtol && depth < options.max_depth) {
+            double Tmid = (Ta + Tb) / 2;
+            self(Tmid, Tb, depth + 1, self);
+            self(Ta, Tmid, depth + 1, self);
+            return;
+        }
+        worst_tail = std::max(worst_tail, tail);
+        for (auto i = 0; i < 3; ++i) {
+            exps[i].push_back(CubicSuperAncillary::Chebyshev{ c[i], Ta, Tb });
+        }
+    };
+    fit(Tmin, Tmax, 0, fit);
+
+    // SuperAncillary finds the interval by bisection, so they must be in the order of increasing temperature
+    auto increasing = [](const auto& e) { return CubicSuperAncillary::SuperAncillary{ { e.rbegin(), e.rend() } }; };
+    return SaturationSurrogate{ increasing(exps[0]), increasing(exps[1]), increasing(exps[2]), Tmin, Tmax, worst_tail };
+}
+
+/**
+* \brief A pure fluid model together with the surrogate of its saturation curve
+*
+* The model is evaluated as usual; superanc_rhoLV gives the saturated densities from the surrogate, so pure_VLE_T_superanc
+* and superanc_or_extrapolate use them (see has_superanc_rhoLV), as they do for the superancillaries of the cubics. 
+* extrapolate_from_critical and pure_VLE_T do not use the surrogate
+*
+* The wrapper is meant for the VLE of the pure fluid: it forwards R, alphar and, if the model has it, get_meta. Any other 
+* method of the model (e.g., get_a and get_b of a cubic) is reached through the member model
+*/
+template<typename Model>
+class SaturationSurrogateModel {
+public:
+    const Model model;
+    const SaturationSurrogate surrogate;
+
+    SaturationSurrogateModel(const Model& model, SaturationSurrogate&& surrogate) : model(model), surrogate(std::move(surrogate)) {};
+
+    template<typename MoleFractions>
+    auto R(const MoleFractions& molefrac) const {
+        return model.R(molefrac);
+    }
+    template<typename TType, typename RhoType, typename MoleFractions>
+    auto alphar(const TType& T, const RhoType& rho, const MoleFractions& molefrac) const {
+        return model.alphar(T, rho, molefrac);
+    }
+    /// The metadata of the model, for models that have it
+    template<typename M = Model>
+    auto get_meta() const -> decltype(std::declval<const M&>().get_meta()) {
+        return model.get_meta();
+    }
+    /// The saturated liquid and vapor densities from the surrogate; throws std::invalid_argument outside of its range
+    auto superanc_rhoLV(double T) const {
+        return surrogate.rhoLV(T);
+    }
+};
+
+/// Build the saturation surrogate of a pure fluid model (see build_saturation_surrogate) and keep it with the model
+template<typename Model>
+auto with_saturation_surrogate(const Model& model, double Tmin, double Tc, double rhoc, const SaturationSurrogateOptions& options = {}) {
+    return SaturationSurrogateModel<Model>(model, build_saturation_surrogate(model, Tmin, Tc, rhoc, options));
+}
+
+}; /* namespace teqp */
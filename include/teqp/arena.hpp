@@ -0,0 +1,169 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "Eigen/Dense"
+
+namespace teqp {
+
+    /**
+    * \brief A bump allocator for the temporary arrays that are made in the evaluation of a model
+    *
+    * Memory is handed out from large blocks by moving an offset forward. It is given back all at once by rewinding
+    * to a marker taken earlier, which keeps the blocks, so once the arena has grown to the size needed by one evaluation,
+    * the following evaluations do not allocate on the heap at all. Objects that are not trivially destructible (for instance
+    * multiprecision numbers) are destroyed when the arena is rewound past them.
+    *
+    * An arena must only be used from one thread at a time; see thread_arena
+    */
+    class BumpArena {
+    public:
+        /// A position in the arena, from mark(), to which it can later be rewound
+        struct Marker {
+            std::size_t block = 0, offset = 0, ncleanups = 0;
+        };
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> data;
+            std::size_t size;
+        };
+        struct Cleanup {
+            void* p;
+            std::size_t n;
+            void (*destroy)(void*, std::size_t);
+        };
+        std::vector<Block> blocks;
+        std::vector<Cleanup> cleanups;
+        std::size_t iblock = 0, offset = 0;
+        std::size_t Nheap = 0;
+        const std::size_t min_block_size;
+
+        /// Try to fit the allocation into block i at the given offset, returning nullptr if it does not fit
+        std::byte* try_block(std::size_t i, std::size_t start, std::size_t bytes, std::size_t alignment) {
+            auto base = reinterpret_cast<std::uintptr_t>(blocks[i].data.get());
+            std::size_t aligned = (base + start + alignment - 1) / alignment * alignment - base;
+            if (aligned + bytes > blocks[i].size) { return nullptr; }
+            iblock = i; offset = aligned + bytes;
+            return blocks[i].data.get() + aligned;
+        }
+    public:
+        explicit BumpArena(std::size_t min_block_size = 16 * 1024) : min_block_size(min_block_size) {}
+        BumpArena(const BumpArena&) = delete;
+        BumpArena& operator=(const BumpArena&) = delete;
+        ~BumpArena() { rewind(Marker{}); }
+
+        /// Allocate uninitialized storage; the blocks already held are used before a new one is made
+        void* allocate(std::size_t bytes, std::size_t alignment) {
+            for (auto i = iblock; i < blocks.size(); ++i) {
+                if (auto p = try_block(i, (i == iblock) ? offset : 0, bytes, alignment)) { return p; }
+            }
+            // Grow geometrically, so that the number of blocks stays small
+            std::size_t size = std::max(min_block_size, bytes + alignment);
+            if (!blocks.empty()) { size = std::max(size, 2 * blocks.back().size); }
+            blocks.push_back(Block{ std::make_unique<std::byte[]>(size), size });
+            ++Nheap;
+            return try_block(blocks.size() - 1, 0, bytes, alignment);
+        }
+
+        /// Allocate and default-construct n objects of type T
+        template<typename T>
+        T* make_array(std::size_t n) {
+            T* p = static_cast<T*>(allocate(std::max<std::size_t>(n, 1) * sizeof(T), alignof(T)));
+            std::uninitialized_default_construct_n(p, n);
+            if constexpr (!std::is_trivially_destructible_v<T>) {
+                cleanups.push_back(Cleanup{ p, n, [](void* p, std::size_t n) { std::destroy_n(static_cast<T*>(p), n); } });
+            }
+            return p;
+        }
+
+        Marker mark() const { return { iblock, offset, cleanups.size() }; }
+
+        /// Destroy everything allocated since the marker was taken and make the memory available again
+        void rewind(const Marker& m) {
+            while (cleanups.size() > m.ncleanups) {
+                auto& c = cleanups.back();
+                c.destroy(c.p, c.n);
+                cleanups.pop_back();
+            }
+            iblock = m.block; offset = m.offset;
+        }
+
+        /// The number of blocks that the arena has allocated on the heap over its lifetime
+        std::size_t heap_allocations() const { return Nheap; }
+
+        /// The total number of bytes in the blocks held by the arena
+        std::size_t capacity() const {
+            std::size_t c = 0;
+            for (const auto& b : blocks) { c += b.size; }
+            return c;
+        }
+    };
+
+    namespace detail {
+        /// The arena plugged into this thread with UseArena, or nullptr
+        inline BumpArena*& plugged_arena() {
+            thread_local BumpArena* arena = nullptr;
+            return arena;
+        }
+    }
+
+    /**
+    * \brief The arena used for the temporaries of the models on the calling thread
+    *
+    * Each thread has its own arena, so a model that is shared between threads can use it without locking. An arena
+    * owned by the caller can be plugged in instead with UseArena
+    */
+    inline BumpArena& thread_arena() {
+        if (auto p = detail::plugged_arena()) { return *p; }
+        thread_local BumpArena arena;
+        return arena;
+    }
+
+    /// Plug an arena owned by the caller into the calling thread for the lifetime of this object
+    class UseArena {
+    private:
+        BumpArena* previous;
+    public:
+        explicit UseArena(BumpArena& arena) : previous(std::exchange(detail::plugged_arena(), &arena)) {}
+        UseArena(const UseArena&) = delete;
+        UseArena& operator=(const UseArena&) = delete;
+        ~UseArena() { detail::plugged_arena() = previous; }
+    };
+
+    /**
+    * \brief The scope of the temporaries of one evaluation
+    *
+    * The arrays made by the scope are Eigen::Map views into the arena; they are valid until the scope is destroyed, when
+    * the arena is rewound to where it was when the scope was made. Scopes can be nested, for instance if one model
+    * is evaluated inside another
+    */
+    class ArenaScope {
+    private:
+        BumpArena& arena;
+        const BumpArena::Marker marker;
+    public:
+        explicit ArenaScope(BumpArena& arena = thread_arena()) : arena(arena), marker(arena.mark()) {}
+        ArenaScope(const ArenaScope&) = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+        ~ArenaScope() { arena.rewind(marker); }
+
+        /// A column array of n default-constructed entries of type T
+        template<typename T>
+        auto array(Eigen::Index n) {
+            return Eigen::Map<Eigen::Array<T, Eigen::Dynamic, 1>>(arena.make_array<T>(static_cast<std::size_t>(n)), n);
+        }
+
+        /// A column-major matrix of rows x cols default-constructed entries of type T
+        template<typename T>
+        auto matrix(Eigen::Index rows, Eigen::Index cols) {
+            return Eigen::Map<Eigen::Matrix<T, Eigen::Dynamic, Eigen::Dynamic>>(arena.make_array<T>(static_cast<std::size_t>(rows * cols)), rows, cols);
+        }
+    };
+}
@@ -3,9 +3,12 @@
 #include <complex>
 #include <map>
 #include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "teqp/types.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/parallel.hpp"
 
 #include "MultiComplex/MultiComplex.hpp"
 
@@ -109,7 +112,81 @@ struct AlphaCallWrapper {
     }
 };
 
-enum class ADBackends { autodiff, multicomplex, complex_step };
+enum class ADBackends { autodiff, multicomplex, complex_step, analytic };
+
+namespace detail {
+
+    /// The number of entries of a vector type that is known at compile time, or Eigen::Dynamic if it is only known at runtime
+    template<typename VectorType, typename = void>
+    struct compile_time_size { static constexpr int value = Eigen::Dynamic; };
+
+    template<typename VectorType>
+    struct compile_time_size<VectorType, std::void_t<decltype(VectorType::SizeAtCompileTime)>> { static constexpr int value = VectorType::SizeAtCompileTime; };
+
+    template<typename VectorType>
+    constexpr int compile_time_size_v = compile_time_size<std::decay_t<VectorType>>::value;
+
+    /**
+    * \brief The value, gradient, and Hessian of a function of a vector, written into storage owned by the caller
+    *
+    * This is the same calculation as autodiff::hessian with second-order dual numbers, one evaluation per entry 
+    * in the upper triangle of the Hessian. The point is passed in xdual as unseeded dual numbers; the seeds are set 
+    * and cleared again in place, so that nothing is allocated on the heap. g and H must already have the right size
+    */
+    template<typename Function, typename DualArray, typename GradType, typename HessianType>
+    void fgradHessian_inplace(const Function& f, DualArray& xdual, double& u, GradType& g, HessianType& H) {
+        const auto N = xdual.size();
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = i; j < N; ++j) {
+                seed_dual_level<1>(xdual[i]);
+                seed_dual_level<2>(xdual[j]);
+                auto val = f(xdual);
+                xdual[i] = get_dual_component(xdual[i], 0U);
+                xdual[j] = get_dual_component(xdual[j], 0U);
+                H(i, j) = get_dual_component(val, 3U);
+                H(j, i) = H(i, j);
+                if (i == j) {
+                    g[i] = get_dual_component(val, 1U);
+                    u = get_dual_component(val, 0U);
+                }
+            }
+        }
+    }
+
+    /// The gradient of a function of a vector, written into storage owned by the caller; as fgradHessian_inplace, but with first-order dual numbers
+    template<typename Function, typename DualArray, typename GradType>
+    void gradient_inplace(const Function& f, DualArray& xdual, GradType& g) {
+        for (auto i = 0; i < xdual.size(); ++i) {
+            seed_dual_level<1>(xdual[i]);
+            g[i] = get_dual_component(f(xdual), 1U);
+            xdual[i] = get_dual_component(xdual[i], 0U);
+        }
+    }
+
+    /// The value, gradient, and Hessian of a function of a vector with N entries, N known at compile time, without heap allocation
+    template<int N, typename Function, typename VectorType>
+    auto fixed_size_fgradHessian(const Function& f, const VectorType& x) {
+        static_assert(N != Eigen::Dynamic, "The size must be known at compile time");
+        Eigen::Array<dual2nd, N, 1> xdual;
+        for (auto i = 0; i < N; ++i) { xdual[i] = x[i]; }
+        double u = 0.0;
+        Eigen::Matrix<double, N, 1> g;
+        Eigen::Matrix<double, N, N> H;
+        fgradHessian_inplace(f, xdual, u, g, H);
+        return std::make_tuple(u, g, H);
+    }
+
+    /// The gradient of a function of a vector with N entries, N known at compile time; as autodiff::gradient but without heap allocation
+    template<int N, typename Function, typename VectorType>
+    auto fixed_size_gradient(const Function& f, const VectorType& x) {
+        static_assert(N != Eigen::Dynamic, "The size must be known at compile time");
+        Eigen::Array<dual, N, 1> xdual;
+        for (auto i = 0; i < N; ++i) { xdual[i] = x[i]; }
+        Eigen::Matrix<double, N, 1> g;
+        gradient_inplace(f, xdual, g);
+        return g;
+    }
+}
 
 template<typename Model, typename Scalar = double, typename VectorType = Eigen::ArrayXd>
 struct TDXDerivatives {
@@ -209,11 +286,18 @@ struct TDXDerivatives {
     * \f]
     *
     * Note: none of the intermediate derivatives are returned, although they are calculated
+    *
+    * With ADBackends::analytic, the model must provide the closed-form derivatives with respect to tau and delta
+    * (see MultiFluid::alphar_taudeltaderivs), and iT+iD may be at most 4; only the derivatives up to order iT+iD are calculated
     */
     template<int iT, int iD, ADBackends be>
     static auto get_Arxy(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
         auto wrapper = AlphaCallWrapper<0, decltype(model)>(model);
-        if constexpr (iT == 0 && iD == 0) {
+        if constexpr (be == ADBackends::analytic) {
+            static_assert(iT + iD <= 4, "Closed-form derivatives are only available up to fourth order");
+            return static_cast<Scalar>(model.alphar_taudeltaderivs(T, rho, molefrac, iT + iD)(iT, iD));
+        }
+        else if constexpr (iT == 0 && iD == 0) {
             return wrapper.alpha(T, rho, molefrac);
         }
         else {
@@ -240,6 +324,39 @@ struct TDXDerivatives {
         }
     }
 
+    /**
+    * Calculate all the derivatives \f$\Lambda^{\rm r}_{ij}\f$ for \f$0 \leq i \leq {\rm maxT}\f$ and \f$0 \leq j \leq {\rm maxD}\f$
+    * from a single evaluation of alphar, where
+    * \f[
+    * \Lambda^{\rm r}_{ij} = (1/T)^i\rho^j\left(\frac{\partial^{i+j}(\alpha^r)}{\partial(1/T)^i\partial\rho^j}\right)
+    * \f]
+    *
+    * The model is evaluated once with a nested dual number of order maxT+maxD, with 1/T seeded in the outer maxT levels and
+    * \f$\rho\f$ in the inner maxD levels; every mixed partial derivative is one of the components of the result.
+    * As the cost grows as 2^(maxT+maxD), this is best for low orders where many derivatives are needed at once.
+    *
+    * \return An array with maxT+1 rows and maxD+1 columns, with element (i,j) equal to \f$\Lambda^{\rm r}_{ij}\f$
+    */
+    template<int maxT, int maxD>
+    static auto get_Ar_bundle(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
+        static_assert(maxT >= 0 && maxD >= 0 && maxT + maxD > 0);
+        using adtype = autodiff::HigherOrderDual<maxT + maxD, double>;
+        adtype Trecipad = 1.0 / T, rhoad = rho;
+        detail::seed_dual_levels<1, maxT>(Trecipad);
+        detail::seed_dual_levels<maxT + 1, maxT + maxD>(rhoad);
+        adtype val = eval(model.alphar(eval(1.0 / Trecipad), rhoad, molefrac));
+
+        Eigen::Array<double, maxT + 1, maxD + 1> o;
+        for (auto i = 0; i <= maxT; ++i) {
+            for (auto j = 0; j <= maxD; ++j) {
+                // The first i levels of 1/T, and the first j levels of rho
+                unsigned int mask = ((1U << i) - 1U) | (((1U << j) - 1U) << maxT);
+                o(i, j) = powi(1.0 / T, i) * powi(rho, j) * detail::get_dual_component(val, mask);
+            }
+        }
+        return o;
+    }
+
     template<ADBackends be = ADBackends::autodiff>
     static auto get_Ar10(const Model& model, const Scalar &T, const Scalar &rho, const VectorType& molefrac) {
         return get_Arxy<1, 0, be>(model, T, rho, molefrac);
@@ -283,6 +400,14 @@ struct TDXDerivatives {
             }
             return o;
         }
+        else if constexpr (be == ADBackends::analytic) {
+            static_assert(Nderiv <= 4, "Closed-form derivatives are only available up to fourth order");
+            auto ders = model.alphar_taudeltaderivs(T, rho, molefrac, Nderiv);
+            for (auto n = 0; n <= Nderiv; ++n) {
+                o[n] = ders(0, n);
+            }
+            return o;
+        }
         else {
             using fcn_t = std::function<mcx::MultiComplex<Scalar>(const mcx::MultiComplex<Scalar>&)>;
             bool and_val = true;
@@ -339,6 +464,45 @@ struct TDXDerivatives {
         }
     }
 
+    /**
+    * Calculate the derivative \f$\Lambda^{\rm r}_{xy}\f$ for a batch of state points, writing into caller-owned storage
+    *
+    * The inputs are in structure-of-arrays form: T[i], rho[i] and the i-th row of the composition matrix z
+    * define the i-th state point.  If z has only one row, that composition is used for all the state points.
+    *
+    * \param model The model to be evaluated
+    * \param T The temperatures, in K
+    * \param rho The molar densities, in mol/m^3
+    * \param z The mole fractions, one row per state point (or a single row)
+    * \param out The output buffer, must already have the same size as T
+    * \param Nthreads The number of threads to split the work over (0 for the number of hardware threads)
+    */
+    template<int iT, int iD, ADBackends be = ADBackends::autodiff, typename TVec, typename RhoVec, typename ZMat, typename OutVec>
+    static void get_Arxy_batch(const Model& model, const TVec& T, const RhoVec& rho, const ZMat& z, OutVec&& out, std::size_t Nthreads = 1) {
+        const auto N = static_cast<std::size_t>(T.size());
+        if (static_cast<std::size_t>(rho.size()) != N) {
+            throw teqp::InvalidArgument("Lengths of T and rho are not the same in get_Arxy_batch");
+        }
+        if (static_cast<std::size_t>(out.size()) != N) {
+            throw teqp::InvalidArgument("Length of out is not the same as the length of T in get_Arxy_batch");
+        }
+        if (z.rows() != 1 && static_cast<std::size_t>(z.rows()) != N) {
+            throw teqp::InvalidArgument("Number of rows in z must be either 1 or the length of T in get_Arxy_batch");
+        }
+        const bool fixed_composition = (z.rows() == 1);
+        auto eval_chunk = [&](std::size_t ibegin, std::size_t iend) {
+            // Each thread gets its own buffer for the mole fractions, assigned in-place for each point
+            VectorType molefrac = z.row(0).transpose();
+            for (auto i = ibegin; i < iend; ++i) {
+                if (!fixed_composition) {
+                    molefrac = z.row(i).transpose();
+                }
+                out[i] = get_Arxy<iT, iD, be>(model, T[i], rho[i], molefrac);
+            }
+        };
+        parallel_for_chunks(N, Nthreads, eval_chunk);
+    }
+
     template<ADBackends be = ADBackends::autodiff>
     static auto get_neff(const Model& model, const Scalar& T, const Scalar& rho, const VectorType& molefrac) {
         auto Ar01 = get_Ar01<be>(model, T, rho, molefrac);
@@ -514,9 +678,47 @@ struct VirialDerivatives {
 };
 
 
+/**
+* \brief Derivatives with respect to the molar concentrations
+*
+* If the number of components is known at compile time (e.g., VectorType is Eigen::Array2d), the Hessians, gradients,
+* and other vector-valued results have fixed size as well, and are calculated without any heap allocation
+*/
 template<typename Model, typename Scalar = double, typename VectorType = Eigen::ArrayXd>
 struct IsochoricDerivatives{
 
+    /// The number of components if it is known at compile time, otherwise Eigen::Dynamic
+    static constexpr int Ncomp = detail::compile_time_size_v<VectorType>;
+
+    /**
+    * \brief Storage owned by the caller for the overloads of the builders that take a workspace
+    *
+    * The arrays are sized for the number of components on first use and are only reallocated if that number changes, so 
+    * a solver that keeps one workspace per phase does not allocate on the heap after its first iteration (unless the model 
+    * itself does). The results of the last call are held in the workspace and are overwritten by the next call
+    */
+    struct Workspace {
+        Eigen::Array<dual2nd, Ncomp, 1> rhovec2nd, ///< The molar concentrations, as second-order dual numbers
+            molefrac2nd; ///< The mole fractions, as second-order dual numbers
+        Eigen::Array<dual, Ncomp, 1> rhovec1st, ///< The molar concentrations, as first-order dual numbers
+            molefrac1st; ///< The mole fractions, as first-order dual numbers
+        double Psir = 0.0; ///< \f$\Psi^{\rm r}\f$
+        double dPsirdT = 0.0; ///< \f$\partial\Psi^{\rm r}/\partial T\f$ at constant molar concentrations
+        Eigen::Matrix<double, Ncomp, 1> gradient; ///< The gradient of \f$\Psi^{\rm r}\f$ w.r.t. the molar concentrations
+        Eigen::Matrix<double, Ncomp, Ncomp> Hessian; ///< The Hessian of \f$\Psi^{\rm r}\f$ (or \f$\Psi\f$) w.r.t. the molar concentrations
+        Eigen::Array<double, Ncomp, 1> d2PsirdTdrhoi; ///< \f$\partial^2\Psi^{\rm r}/\partial T\partial\rho_i\f$
+
+        Workspace() { resize((Ncomp == Eigen::Dynamic) ? 0 : Ncomp); }
+        explicit Workspace(Eigen::Index N) { resize(N); }
+
+        /// Size the arrays for N components; does nothing if they already have that size
+        void resize(Eigen::Index N) {
+            if (Hessian.rows() == N) { return; }
+            rhovec2nd.resize(N); molefrac2nd.resize(N); rhovec1st.resize(N); molefrac1st.resize(N);
+            gradient.resize(N); Hessian.resize(N, N); d2PsirdTdrhoi.resize(N);
+        }
+    };
+
     /***
     * \brief Calculate the residual entropy (s^+ = -sr/R) from derivatives of alphar
     */
@@ -593,15 +795,20 @@ struct IsochoricDerivatives{
         // Double derivatives in each component's concentration
         // N^N matrix (symmetric)
 
-        dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
-        ArrayXdual2nd g;
-        ArrayXdual2nd rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
-        auto hfunc = [&model, &T](const ArrayXdual2nd& rho_) {
-            auto rhotot_ = rho_.sum();
-            auto molefrac = (rho_ / rhotot_).eval();
-            return eval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
-        };
-        return autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g).eval(); // evaluate the function value u, its gradient, and its Hessian matrix H
+        if constexpr (Ncomp != Eigen::Dynamic) {
+            return std::get<2>(build_Psir_fgradHessian_autodiff(model, T, rho));
+        }
+        else {
+            dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
+            ArrayXdual2nd g;
+            ArrayXdual2nd rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
+            auto hfunc = [&model, &T](const ArrayXdual2nd& rho_) {
+                auto rhotot_ = rho_.sum();
+                auto molefrac = (rho_ / rhotot_).eval();
+                return eval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
+            };
+            return autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g).eval(); // evaluate the function value u, its gradient, and its Hessian matrix H
+        }
     }
 
     /***
@@ -613,20 +820,46 @@ struct IsochoricDerivatives{
         // Double derivatives in each component's concentration
         // N^N matrix (symmetric)
 
-        dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
-        ArrayXdual g;
-        ArrayXdual2nd rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
-        auto hfunc = [&model, &T](const ArrayXdual2nd& rho_) {
+        using ArrayNdual2nd = Eigen::Array<dual2nd, Ncomp, 1>;
+        auto hfunc = [&model, &T](const ArrayNdual2nd& rho_) {
             auto rhotot_ = rho_.sum();
             auto molefrac = (rho_ / rhotot_).eval();
             return eval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
         };
-        // Evaluate the function value u, its gradient, and its Hessian matrix H
-        Eigen::MatrixXd H = autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g); 
-        // Remove autodiff stuff from the numerical values
-        auto f = getbaseval(u);
-        auto gg = g.cast<double>().eval();
-        return std::make_tuple(f, gg, H);
+        if constexpr (Ncomp != Eigen::Dynamic) {
+            return detail::fixed_size_fgradHessian<Ncomp>(hfunc, rho);
+        }
+        else {
+            dual2nd u; // the output scalar u = f(x), evaluated together with Hessian below
+            ArrayXdual g;
+            ArrayXdual2nd rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
+            // Evaluate the function value u, its gradient, and its Hessian matrix H
+            Eigen::MatrixXd H = autodiff::hessian(hfunc, wrt(rhovecc), at(rhovecc), u, g);
+            // Remove autodiff stuff from the numerical values
+            auto f = getbaseval(u);
+            auto gg = g.cast<double>().eval();
+            return std::make_tuple(f, gg, H);
+        }
+    }
+
+    /***
+    * \brief Calculate the function value, gradient, and Hessian of Psir = ar*rho w.r.t. the molar concentrations, in a workspace
+    *
+    * The results are stored in the Psir, gradient and Hessian members of the workspace, and a tuple of references to them is returned, 
+    * so that the call can be used in the same way as the overload without the workspace. rho may be any Eigen array expression, 
+    * for instance a Map into the unknowns of a solver
+    */
+    template<typename RhoType>
+    static auto build_Psir_fgradHessian_autodiff(const Model& model, const Scalar& T, const RhoType& rho, Workspace& ws) {
+        ws.resize(rho.size());
+        for (auto i = 0; i < rho.size(); ++i) { ws.rhovec2nd[i] = rho[i]; }
+        auto hfunc = [&model, &T, &ws](const Eigen::Array<dual2nd, Ncomp, 1>& rho_) {
+            auto rhotot_ = rho_.sum();
+            ws.molefrac2nd = rho_ / rhotot_;
+            return eval(model.alphar(T, rhotot_, ws.molefrac2nd) * model.R(ws.molefrac2nd) * T * rhotot_);
+        };
+        detail::fgradHessian_inplace(hfunc, ws.rhovec2nd, ws.Psir, ws.gradient, ws.Hessian);
+        return std::forward_as_tuple(std::as_const(ws.Psir), std::as_const(ws.gradient), std::as_const(ws.Hessian));
     }
 
     /***
@@ -638,12 +871,23 @@ struct IsochoricDerivatives{
         auto rhotot_ = rho.sum();
         auto molefrac = (rho / rhotot_).eval();
         auto H = build_Psir_Hessian_autodiff(model, T, rho).eval();
-        for (auto i = 0; i < 2; ++i) {
+        for (auto i = 0; i < rho.size(); ++i) {
             H(i, i) += model.R(molefrac) * T / rho[i];
         }
         return H;
     }
 
+    /// As build_Psi_Hessian_autodiff, but the Hessian is calculated in the Hessian member of the workspace, which is returned
+    template<typename RhoType>
+    static const auto& build_Psi_Hessian_autodiff(const Model& model, const Scalar& T, const RhoType& rho, Workspace& ws) {
+        build_Psir_fgradHessian_autodiff(model, T, rho, ws);
+        auto R = model.R(rho / rho.sum());
+        for (auto i = 0; i < rho.size(); ++i) {
+            ws.Hessian(i, i) += R * T / rho[i];
+        }
+        return std::as_const(ws.Hessian);
+    }
+
     /***
     * \brief Calculate the Hessian of Psir = ar*rho w.r.t. the molar concentrations (residual contribution only)
     *
@@ -672,14 +916,34 @@ struct IsochoricDerivatives{
     * Uses autodiff to calculate derivatives
     */
     static auto build_Psir_gradient_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
-        ArrayXdual rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
-        auto psirfunc = [&model, &T](const ArrayXdual& rho_) {
+        using ArrayNdual = Eigen::Array<dual, Ncomp, 1>;
+        auto psirfunc = [&model, &T](const ArrayNdual& rho_) {
             auto rhotot_ = rho_.sum();
             auto molefrac = (rho_ / rhotot_).eval();
             return eval(model.alphar(T, rhotot_, molefrac) * model.R(molefrac) * T * rhotot_);
         };
-        auto val = autodiff::gradient(psirfunc, wrt(rhovecc), at(rhovecc)).eval(); // evaluate the gradient
-        return val;
+        if constexpr (Ncomp != Eigen::Dynamic) {
+            return detail::fixed_size_gradient<Ncomp>(psirfunc, rho);
+        }
+        else {
+            ArrayXdual rhovecc(rho.size()); for (auto i = 0; i < rho.size(); ++i) { rhovecc[i] = rho[i]; }
+            auto val = autodiff::gradient(psirfunc, wrt(rhovecc), at(rhovecc)).eval(); // evaluate the gradient
+            return val;
+        }
+    }
+
+    /// As build_Psir_gradient_autodiff, but the gradient is calculated in the gradient member of the workspace, which is returned
+    template<typename RhoType>
+    static const auto& build_Psir_gradient_autodiff(const Model& model, const Scalar& T, const RhoType& rho, Workspace& ws) {
+        ws.resize(rho.size());
+        for (auto i = 0; i < rho.size(); ++i) { ws.rhovec1st[i] = rho[i]; }
+        auto psirfunc = [&model, &T, &ws](const Eigen::Array<dual, Ncomp, 1>& rho_) {
+            auto rhotot_ = rho_.sum();
+            ws.molefrac1st = rho_ / rhotot_;
+            return eval(model.alphar(T, rhotot_, ws.molefrac1st) * model.R(ws.molefrac1st) * T * rhotot_);
+        };
+        detail::gradient_inplace(psirfunc, ws.rhovec1st, ws.gradient);
+        return std::as_const(ws.gradient);
     }
 
     /***
@@ -772,11 +1036,11 @@ struct IsochoricDerivatives{
     }
 
     static auto build_d2PsirdTdrhoi_autodiff(const Model& model, const Scalar& T, const VectorType& rho) {
-        Eigen::ArrayXd deriv(rho.size());
+        Eigen::Array<double, Ncomp, 1> deriv; deriv.resize(rho.size());
         // d^2psir/dTdrho_i
         for (auto i = 0; i < rho.size(); ++i) {
             auto psirfunc = [&model, &rho, i](const auto& T, const auto& rhoi) {
-                ArrayXdual2nd rhovecc(rho.size()); for (auto j = 0; j < rho.size(); ++j) { rhovecc[j] = rho[j]; }
+                Eigen::Array<dual2nd, Ncomp, 1> rhovecc; rhovecc.resize(rho.size()); for (auto j = 0; j < rho.size(); ++j) { rhovecc[j] = rho[j]; }
                 rhovecc[i] = rhoi;
                 auto rhotot_ = rhovecc.sum();
                 auto molefrac = (rhovecc / rhotot_).eval();
@@ -789,6 +1053,30 @@ struct IsochoricDerivatives{
         return deriv;
     }
 
+    /**
+    * \brief As build_d2PsirdTdrhoi_autodiff, but calculated in the d2PsirdTdrhoi member of the workspace, which is returned
+    * 
+    * The temperature derivative of Psir at constant molar concentrations is obtained along the way, and is stored in the dPsirdT member
+    */
+    template<typename RhoType>
+    static const auto& build_d2PsirdTdrhoi_autodiff(const Model& model, const Scalar& T, const RhoType& rho, Workspace& ws) {
+        ws.resize(rho.size());
+        for (auto i = 0; i < rho.size(); ++i) { ws.rhovec2nd[i] = rho[i]; }
+        dual2nd Tdual = T;
+        detail::seed_dual_level<1>(Tdual);
+        for (auto i = 0; i < rho.size(); ++i) {
+            // T is seeded at the first level and rho_i at the second, so the mixed component is the cross derivative
+            detail::seed_dual_level<2>(ws.rhovec2nd[i]);
+            auto rhotot_ = ws.rhovec2nd.sum();
+            ws.molefrac2nd = ws.rhovec2nd / rhotot_;
+            auto val = eval(model.alphar(Tdual, rhotot_, ws.molefrac2nd) * model.R(ws.molefrac2nd) * Tdual * rhotot_);
+            ws.d2PsirdTdrhoi[i] = detail::get_dual_component(val, 3U);
+            ws.dPsirdT = detail::get_dual_component(val, 1U);
+            ws.rhovec2nd[i] = rho[i];
+        }
+        return std::as_const(ws.d2PsirdTdrhoi);
+    }
+
     /***
     * \brief Calculate the temperature derivative of the chemical potential of each component
     * \note: Some contributions to the ideal gas part are missing (reference state and cp0), but are not relevant to phase equilibria
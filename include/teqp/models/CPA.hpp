@@ -1,9 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+
 #include "nlohmann/json.hpp"
+#include "teqp/types.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/arena.hpp"
 
 namespace teqp {
 
+struct ModelSerializer;
+
 namespace CPA {
 
 template<typename X> auto POW2(X x) { return x * x; };
@@ -22,11 +33,39 @@ inline auto get_association_classes(const std::string& s) {
     }
 }
 
+/// The kinds of association sites; a positive site (H) only bonds with a negative one (lone pair) and vice versa, and an amphoteric site bonds with any site
+enum class site_types { amphoteric, positive, negative };
+
+/// The kinds of the sites of each association scheme, in the order of the site fractions of XA_calc_pure
+inline std::vector<site_types> get_site_types(association_classes cl) {
+    switch (cl) {
+    case association_classes::a1A: return { site_types::amphoteric };
+    case association_classes::a2B: return { site_types::negative, site_types::positive };
+    case association_classes::a3B: return { site_types::negative, site_types::negative, site_types::positive };
+    case association_classes::a4C: return { site_types::negative, site_types::negative, site_types::positive, site_types::positive };
+    case association_classes::not_associating: return {};
+    default: throw std::invalid_argument("Bad association class");
+    }
+}
+
+/// Whether sites of these two kinds can bond with each other
+inline bool can_bond(site_types a, site_types b) {
+    return a == site_types::amphoteric || b == site_types::amphoteric || a != b;
+}
+
 enum class radial_dist { CS, KG, OT };
+inline auto get_radial_dist_flag(const std::string& s) {
+    if (s == "CS") { return radial_dist::CS; }
+    else if (s == "KG") { return radial_dist::KG; }
+    else if (s == "OT") { return radial_dist::OT; }
+    else {
+        throw std::invalid_argument("bad radial_dist flag:" + s);
+    }
+}
 
-/// Function that calculates the association binding strength between site A of molecule i and site B on molecule j
-template<typename BType, typename TType, typename RhoType, typename VecType>
-inline auto get_DeltaAB_pure(radial_dist dist, double epsABi, double betaABi, BType b_cubic, TType RT, RhoType rhomolar, const VecType& molefrac) {
+/// The contact value of the radial distribution function
+template<typename BType, typename RhoType>
+inline auto get_radial_dist(radial_dist dist, BType b_cubic, RhoType rhomolar) {
 
     using eta_type = std::common_type_t<decltype(rhomolar), decltype(b_cubic)>;
     eta_type eta;
@@ -54,6 +93,14 @@ inline auto get_DeltaAB_pure(radial_dist dist, double epsABi, double betaABi, BT
             throw std::invalid_argument("Bad radial_dist");
         }
     }
+    return g_vm_ref;
+}
+
+/// Function that calculates the association binding strength between site A of molecule i and site B on molecule j
+template<typename BType, typename TType, typename RhoType, typename VecType>
+inline auto get_DeltaAB_pure(radial_dist dist, double epsABi, double betaABi, BType b_cubic, TType RT, RhoType rhomolar, const VecType& molefrac) {
+
+    auto g_vm_ref = get_radial_dist(dist, b_cubic, rhomolar);
 
     // Calculate the association strength between site Ai and Bi for a pure compent
     auto DeltaAiBj = forceeval(g_vm_ref*(exp(epsABi/RT) - 1.0)*b_cubic* betaABi);
@@ -67,17 +114,17 @@ inline auto get_DeltaAB_pure(radial_dist dist, double epsABi, double betaABi, BT
 /// 
 
 template<typename BType, typename TType, typename RhoType, typename VecType>
-inline auto XA_calc_pure(int N_sites, association_classes scheme, double epsABi, double betaABi, const BType b_cubic, const TType RT, const RhoType rhomolar, const VecType& molefrac) {
+inline auto XA_calc_pure(int N_sites, association_classes scheme, radial_dist dist, double epsABi, double betaABi, const BType b_cubic, const TType RT, const RhoType rhomolar, const VecType& molefrac) {
 
     // Matrix XA(A, j) that contains all of the fractions of sites A not bonded to other active sites for each molecule i
     // Start values for the iteration(set all sites to non - bonded, = 1)
     using result_type = std::common_type_t<decltype(RT), decltype(rhomolar), decltype(molefrac[0])>;
-    Eigen::Array<result_type, Eigen::Dynamic, Eigen::Dynamic> XA;  // A maximum of 4 association sites(A, B, C, D)
+    // A maximum of 4 association sites(A, B, C, D), so the storage is fixed in size and not on the heap
+    Eigen::Array<result_type, Eigen::Dynamic, Eigen::Dynamic, Eigen::ColMajor, 4, 1> XA;
     XA.resize(N_sites, 1);
     XA.setOnes();
 
     // Get the association strength between the associating sites
-    auto dist = radial_dist::KG; // TODO: pass this in
     auto DeltaAiBj = get_DeltaAB_pure(dist, epsABi, betaABi, b_cubic, RT, rhomolar, molefrac);
 
     if (scheme == association_classes::a1A) { // Acids
@@ -114,6 +161,219 @@ inline auto XA_calc_pure(int N_sites, association_classes scheme, double epsABi,
     return XA;
 };
 
+/// Controls of the iterative solution for the site fractions of mixtures in XA_calc_mixture
+struct AssociationSolverOptions {
+    int max_substitutions = 5; ///< The maximum number of successive substitution steps taken before switching to Newton's method, when there is no starting value
+    double substitution_tol = 1e-3; ///< Switch to Newton's method once the largest change of a site fraction in a substitution step is smaller than this
+    int maxiter = 100; ///< The maximum number of Newton steps in double precision
+    double tol = 1e-14; ///< Converged when the largest Newton step is smaller than this
+    int N_exact_steps = 3; ///< The number of Newton steps taken in the scalar type of the inputs, after convergence in double precision
+};
+
+namespace detail {
+    /// Solve A*x = b in place (b is overwritten with x, A with its factorization) by Gaussian elimination without pivoting, for any scalar type
+    template<typename MatrixType, typename VectorType>
+    void solve_nopivot_inplace(MatrixType& A, VectorType& b) {
+        const auto n = A.rows();
+        for (auto k = 0; k < n; ++k) {
+            for (auto i = k + 1; i < n; ++i) {
+                auto f = forceeval(A(i, k) / A(k, k));
+                for (auto j = k + 1; j < n; ++j) {
+                    A(i, j) = A(i, j) - f * A(k, j);
+                }
+                b(i) = b(i) - f * b(k);
+            }
+        }
+        for (auto i = n - 1; i >= 0; --i) {
+            for (auto j = i + 1; j < n; ++j) {
+                b(i) = b(i) - A(i, j) * b(j);
+            }
+            b(i) = b(i) / A(i, i);
+        }
+    }
+
+    /**
+    * \brief One Newton step for the site fractions
+    *
+    * The residuals are g_a = 1/X_a - 1 - sum_b K_ab*X_b with K_ab = rho*Delta_ab*x_b, so the Jacobian is 
+    * -(diag(1/X_a^2) + K). Like the Hessian of the Q function of Michelsen (Ind. Eng. Chem. Res., 2006) it is similar 
+    * to a symmetric definite matrix, so it can be factored without pivoting. A is work space of the size of K
+    */
+    template<typename KType, typename XType, typename AType, typename StepType>
+    void association_Newton_step(const KType& K, const XType& X, AType& A, StepType& dX) {
+        const auto n = X.size();
+        for (auto a = 0; a < n; ++a) {
+            dX(a) = 1.0 / X(a) - 1.0;
+            for (auto b = 0; b < n; ++b) {
+                dX(a) = dX(a) - K(a, b) * X(b);
+                A(a, b) = K(a, b);
+            }
+            A(a, a) = A(a, a) + 1.0 / (X(a) * X(a));
+        }
+        solve_nopivot_inplace(A, dX);
+    }
+}
+
+/**
+* \brief The fractions of the association sites not bonded to other sites, for mixtures with cross association
+*
+* Solves X_a = 1/(1 + rho*sum_b x_b*Delta_ab*X_b) for all the sites of all the components together (see Michelsen and 
+* Hendriks, Fluid Phase Equilib., 2001). The iterations are carried out in double precision: a few steps of successive 
+* substitution if there is no starting value, then Newton's method with the analytic Jacobian. From the converged values, a
+* few more Newton steps are taken in the scalar type of the inputs; each one doubles the order up to which the derivatives
+* carried by autodiff (or complex step) types are exact, so the derivatives of the solution are exact too.
+*
+* \param Delta The association strengths of each pair of sites, in m^3/mol
+* \param xsite The mole fraction of the component that carries each site
+* \param rhomolar The molar density, in mol/m^3
+* \param Xd In: the starting values, if start_given is true; out: the converged site fractions in double precision
+* \param start_given True if Xd holds starting values, for instance the solution of a nearby state point
+* \param X Out: the site fractions in the scalar type of the inputs; must already have one entry per site
+* \returns The number of iterations (substitutions and Newton steps) in double precision
+*/
+template<typename DeltaType, typename XSiteType, typename RhoType, typename XdType, typename XType>
+int XA_calc_mixture(const DeltaType& Delta, const XSiteType& xsite, const RhoType& rhomolar, XdType& Xd, bool start_given, XType& X, const AssociationSolverOptions& options = {}) {
+    const auto n = xsite.size();
+    using Scalar = std::decay_t<decltype(X[0])>;
+    ArenaScope scratch;
+
+    auto Kd = scratch.matrix<double>(n, n), Ad = scratch.matrix<double>(n, n);
+    auto dXd = scratch.array<double>(n);
+    const double rhod = getbaseval(rhomolar);
+    for (auto a = 0; a < n; ++a) {
+        for (auto b = 0; b < n; ++b) {
+            Kd(a, b) = rhod * getbaseval(Delta(a, b)) * getbaseval(xsite[b]);
+        }
+    }
+
+    int iter = 0;
+    if (!start_given) {
+        Xd.setOnes();
+        for (auto k = 0; k < options.max_substitutions; ++k, ++iter) {
+            dXd.matrix().noalias() = Kd * Xd.matrix();
+            dXd = 1.0 / (1.0 + dXd) - Xd;
+            Xd += dXd;
+            if (dXd.abs().maxCoeff() < options.substitution_tol) { break; }
+        }
+    }
+    for (auto k = 0; k < options.maxiter; ++k, ++iter) {
+        detail::association_Newton_step(Kd, Xd, Ad, dXd);
+        for (auto a = 0; a < n; ++a) {
+            // Keep the site fractions positive; a step that would not is cut back
+            Xd[a] = (Xd[a] + dXd[a] > 0) ? Xd[a] + dXd[a] : 0.2 * Xd[a];
+        }
+        if (dXd.abs().maxCoeff() < options.tol) { break; }
+    }
+    if (!Xd.isFinite().all()) {
+        throw teqp::IterationFailure("Site fractions are not finite");
+    }
+
+    if constexpr (std::is_same_v<Scalar, double>) {
+        X = Xd;
+    }
+    else {
+        auto K = scratch.matrix<Scalar>(n, n), A = scratch.matrix<Scalar>(n, n);
+        auto dX = scratch.array<Scalar>(n);
+        for (auto a = 0; a < n; ++a) {
+            X[a] = Xd[a];
+            for (auto b = 0; b < n; ++b) {
+                K(a, b) = rhomolar * Delta(a, b) * xsite[b];
+            }
+        }
+        for (auto k = 0; k < options.N_exact_steps; ++k) {
+            detail::association_Newton_step(K, X, A, dX);
+            for (auto a = 0; a < n; ++a) {
+                X[a] = X[a] + dX[a];
+            }
+        }
+    }
+    return iter;
+}
+
+/**
+* \brief The site fractions of the last few solutions, to start the next solutions from
+*
+* In a solver loop, the model is evaluated many times at nearby state points, often alternating between phases, so
+* a few solutions are kept. A solution is used if it belongs to the same owner (the model) and is within T_reltol in
+* temperature and molefrac_abstol in each mole fraction; of those, the closest one in density, temperature and
+* composition is used. It is only a starting value, so the tolerances only decide how often the store is used.
+*
+* A store can be held by the caller and passed to CPAAssociation::XA_calc, in which case the results only depend on
+* the evaluations made with that store. Models with warm starts turned on (see CPAAssociation::set_warm_start) use
+* the store of the thread instead, so a model shared between threads needs no locking
+*/
+class XAWarmStart {
+public:
+    double T_reltol = 0.05; ///< The largest relative difference in temperature for a stored solution to be used
+    double molefrac_abstol = 0.05; ///< The largest difference in each mole fraction for a stored solution to be used
+private:
+    struct Entry {
+        const void* owner = nullptr;
+        double T = 0, rhomolar = 0;
+        std::vector<double> molefrac, X;
+        std::size_t last_used = 0;
+    };
+    std::array<Entry, 4> entries;
+    std::size_t counter = 0;
+
+    /// The distance of the entry from the state point, or a negative value if it belongs to another owner or is outside of the tolerances
+    template<typename VecType>
+    double distance(const Entry& e, const void* owner, double T, double rhomolar, const VecType& molefrac) const {
+        if (e.owner != owner || e.molefrac.size() != static_cast<std::size_t>(molefrac.size())) { return -1; }
+        double dT = std::abs(T / e.T - 1.0), dx = 0;
+        if (dT > T_reltol) { return -1; }
+        for (auto i = 0; i < molefrac.size(); ++i) {
+            dx = std::max(dx, std::abs(e.molefrac[i] - getbaseval(molefrac[i])));
+        }
+        if (dx > molefrac_abstol) { return -1; }
+        return std::abs(std::log(e.rhomolar / rhomolar)) + dT + dx;
+    }
+public:
+    /// Copy the closest stored solution for this owner into X; returns false if there is none within the tolerances and of the right size
+    template<typename VecType, typename XdType>
+    bool find(const void* owner, double T, double rhomolar, const VecType& molefrac, XdType& X) {
+        Entry* best = nullptr;
+        double best_distance = 0;
+        for (auto& e : entries) {
+            auto d = distance(e, owner, T, rhomolar, molefrac);
+            if (d >= 0 && e.X.size() == static_cast<std::size_t>(X.size()) && (best == nullptr || d < best_distance)) {
+                best = &e;
+                best_distance = d;
+            }
+        }
+        if (best == nullptr) { return false; }
+        best->last_used = ++counter;
+        for (auto i = 0; i < X.size(); ++i) { X[i] = best->X[i]; }
+        return true;
+    }
+    /// Store a solution, replacing the one for this owner within 1% of this state point, or else the least recently used one
+    template<typename VecType, typename XdType>
+    void store(const void* owner, double T, double rhomolar, const VecType& molefrac, const XdType& X) {
+        Entry* slot = &entries[0];
+        for (auto& e : entries) {
+            auto d = distance(e, owner, T, rhomolar, molefrac);
+            if (d >= 0 && d < 0.01) { slot = &e; break; }
+            if (e.last_used < slot->last_used) { slot = &e; }
+        }
+        slot->owner = owner;
+        slot->T = T;
+        slot->rhomolar = rhomolar;
+        slot->molefrac.resize(molefrac.size());
+        for (auto i = 0; i < molefrac.size(); ++i) { slot->molefrac[i] = getbaseval(molefrac[i]); }
+        slot->X.assign(X.data(), X.data() + X.size());
+        slot->last_used = ++counter;
+    }
+    /// Forget all the stored solutions
+    void clear() {
+        entries = {};
+        counter = 0;
+    }
+    static XAWarmStart& thread_instance() {
+        thread_local XAWarmStart store;
+        return store;
+    }
+};
+
 enum class cubic_flag {not_set, PR, SRK};
 inline auto get_cubic_flag(const std::string& s) {
     if (s == "PR") { return cubic_flag::PR; }
@@ -130,6 +390,7 @@ private:
     double delta_1, delta_2;
     std::valarray<std::valarray<double>> k_ij;
     double R_gas;
+    friend struct teqp::ModelSerializer; // For binary serialization, see teqp/serialization.hpp
 
 public:
     CPACubic(cubic_flag flag, const std::valarray<double> &a0, const std::valarray<double> &bi, const std::valarray<double> &c1, const std::valarray<double> &Tc, double R_gas) : a0(a0), bi(bi), c1(c1), Tc(Tc), R_gas(R_gas) {
@@ -147,6 +408,9 @@ public:
     template<typename VecType>
     auto R(const VecType& molefrac) const { return R_gas; }
 
+    /// The co-volume parameters of the components
+    const auto& get_bi() const { return bi; }
+
     template<typename TType>
     auto get_ai(TType T, int i) const {
         return a0[i] * POW2(1.0 + c1[i]*(1.0 - sqrt(T / Tc[i])));
@@ -186,6 +450,14 @@ private:
     const std::valarray<double> epsABi, betaABi;
     const std::vector<int> N_sites; 
     const double R_gas;
+    const radial_dist dist; ///< The contact value of the radial distribution function used in the association strengths
+    friend struct teqp::ModelSerializer; // For binary serialization, see teqp/serialization.hpp
+
+    // The sites of all the components in one list, for mixtures
+    std::vector<std::size_t> site_component; ///< The index of the component that carries each site
+    Eigen::ArrayXXd eps_sites, ///< The association energy of each pair of sites, in J/mol (CR-1 combining rule: arithmetic mean)
+        betab_sites; ///< beta*b of each pair of sites, in m^3/mol (geometric mean of beta, arithmetic mean of b), zero if they cannot bond
+    bool warm_start = false;
 
     auto get_N_sites(const std::vector<association_classes> &classes) {
         std::vector<int> N_sites_out;
@@ -195,6 +467,7 @@ private:
             case association_classes::a2B: return 2;
             case association_classes::a3B: return 3;
             case association_classes::a4C: return 4;
+            case association_classes::not_associating: return 0;
             default: throw std::invalid_argument("Bad association class");
             }
         };
@@ -204,21 +477,137 @@ private:
         return N_sites_out;
     }
 
+    /// Tabulate the parameters of each pair of sites of all the components
+    void build_site_tables() {
+        std::vector<site_types> types;
+        for (auto i = 0U; i < classes.size(); ++i) {
+            for (auto t : get_site_types(classes[i])) {
+                types.push_back(t);
+                site_component.push_back(i);
+            }
+        }
+        const auto& bi = cubic.get_bi();
+        const auto n = types.size();
+        eps_sites.resize(n, n);
+        betab_sites.resize(n, n);
+        for (auto a = 0U; a < n; ++a) {
+            for (auto b = 0U; b < n; ++b) {
+                auto i = site_component[a], j = site_component[b];
+                eps_sites(a, b) = (epsABi[i] + epsABi[j]) / 2.0;
+                betab_sites(a, b) = can_bond(types[a], types[b]) ? sqrt(betaABi[i] * betaABi[j]) * (bi[i] + bi[j]) / 2.0 : 0.0;
+            }
+        }
+    }
+
+public:
+    CPAAssociation(const Cubic &&cubic, const std::vector<association_classes>& classes, const std::valarray<double> &epsABi, const std::valarray<double> &betaABi, double R_gas, radial_dist dist = radial_dist::KG) 
+        : cubic(cubic), classes(classes), epsABi(epsABi), betaABi(betaABi), N_sites(get_N_sites(classes)), R_gas(R_gas), dist(dist) {
+        build_site_tables();
+    };
+
+    /**
+    * \brief Whether the site fractions of mixtures are solved for starting from the closest of the last few solutions
+    * of this model on the same thread (see XAWarmStart)
+    * 
+    * Off by default. This saves iterations in solver loops, but the results can then differ in the last bits depending 
+    * on what was evaluated before on the thread. It can also be turned on with the "warm_start" key of the JSON passed 
+    * to CPAfactory. For reuse that only depends on the caller, pass an XAWarmStart to XA_calc instead
+    */
+    void set_warm_start(bool enabled) { warm_start = enabled; }
+    bool get_warm_start() const { return warm_start; }
+
+    /// The fractions of the sites that are not bonded, for mixtures, in the order of the sites of each component (the same as for XA_calc_pure)
+    template<typename TType, typename RhoType, typename VecType>
+    auto XA_calc(const TType& T, const RhoType& rhomolar, const VecType& molefrac, const AssociationSolverOptions& options = {}) const {
+        using return_type = std::common_type_t<decltype(T), decltype(rhomolar), decltype(molefrac[0])>;
+        Eigen::ArrayX<return_type> X(site_component.size());
+        Eigen::ArrayXd Xd(site_component.size());
+        XA_calc_mixture_impl(T, rhomolar, molefrac, Xd, X, options, warm_start ? &XAWarmStart::thread_instance() : nullptr);
+        return X;
+    }
+
+    /// As XA_calc, starting from the closest solution in the store held by the caller (if any), and adding this solution to it
+    template<typename TType, typename RhoType, typename VecType>
+    auto XA_calc(const TType& T, const RhoType& rhomolar, const VecType& molefrac, XAWarmStart& warm, const AssociationSolverOptions& options = {}) const {
+        using return_type = std::common_type_t<decltype(T), decltype(rhomolar), decltype(molefrac[0])>;
+        Eigen::ArrayX<return_type> X(site_component.size());
+        Eigen::ArrayXd Xd(site_component.size());
+        XA_calc_mixture_impl(T, rhomolar, molefrac, Xd, X, options, &warm);
+        return X;
+    }
+
+    /// The number of association sites of all the components together
+    auto get_N_sites_total() const { return static_cast<Eigen::Index>(site_component.size()); }
+
+    /// The association strength of each pair of sites and the mole fraction of the component carrying each site, the inputs of XA_calc_mixture
+    template<typename TType, typename RhoType, typename VecType, typename DeltaType, typename XSiteType>
+    void build_Delta_sites(const TType& T, const RhoType& rhomolar, const VecType& molefrac, DeltaType& Delta, XSiteType& xsite) const {
+        const auto n = get_N_sites_total();
+        auto [a_cubic, b_cubic] = cubic.get_ab(T, molefrac);
+        auto RT = forceeval(R_gas * T); // R times T
+        auto g_vm_ref = get_radial_dist(dist, b_cubic, rhomolar);
+        for (auto a = 0; a < n; ++a) {
+            xsite[a] = molefrac[site_component[a]];
+            for (auto b = 0; b < n; ++b) {
+                if (betab_sites(a, b) == 0.0) {
+                    Delta(a, b) = 0.0;
+                }
+                else {
+                    Delta(a, b) = g_vm_ref * (exp(eps_sites(a, b) / RT) - 1.0) * betab_sites(a, b);
+                }
+            }
+        }
+    }
+
+private:
+    /// The site fractions of a mixture; if warm is not null, the solution starts from it and is stored in it
+    template<typename TType, typename RhoType, typename VecType, typename XdType, typename XType>
+    int XA_calc_mixture_impl(const TType& T, const RhoType& rhomolar, const VecType& molefrac, XdType& Xd, XType& X, const AssociationSolverOptions& options, XAWarmStart* warm) const {
+        using return_type = std::decay_t<decltype(X[0])>;
+        const auto n = get_N_sites_total();
+        ArenaScope scratch;
+        auto Delta = scratch.matrix<return_type>(n, n);
+        auto xsite = scratch.array<return_type>(n);
+        build_Delta_sites(T, rhomolar, molefrac, Delta, xsite);
+
+        const double Td = getbaseval(T), rhod = getbaseval(rhomolar);
+        bool start_given = warm != nullptr && warm->find(this, Td, rhod, molefrac, Xd);
+        auto iter = XA_calc_mixture(Delta, xsite, rhomolar, Xd, start_given, X, options);
+        if (warm != nullptr) {
+            warm->store(this, Td, rhod, molefrac, Xd);
+        }
+        return iter;
+    }
+
 public:
-    CPAAssociation(const Cubic &&cubic, const std::vector<association_classes>& classes, const std::valarray<double> &epsABi, const std::valarray<double> &betaABi, double R_gas) 
-        : cubic(cubic), classes(classes), epsABi(epsABi), betaABi(betaABi), N_sites(get_N_sites(classes)), R_gas(R_gas) {};
 
     template<typename TType, typename RhoType, typename VecType>
     auto alphar(const TType& T, const RhoType& rhomolar, const VecType& molefrac) const {
+        using return_type = std::common_type_t<decltype(T), decltype(rhomolar), decltype(molefrac[0])>;
+        return_type alpha_r_asso = 0.0;
+
+        if (N_sites.size() > 1) {
+            // Mixture, with cross association; the site fractions are solved for iteratively
+            ArenaScope scratch;
+            auto X = scratch.array<return_type>(site_component.size());
+            auto Xd = scratch.array<double>(site_component.size());
+            XA_calc_mixture_impl(T, rhomolar, molefrac, Xd, X, AssociationSolverOptions{}, warm_start ? &XAWarmStart::thread_instance() : nullptr);
+            for (auto a = 0U; a < site_component.size(); ++a) {
+                alpha_r_asso += forceeval(molefrac[site_component[a]] * (log(X[a]) - X[a] / 2.0 + 0.5));
+            }
+            return forceeval(alpha_r_asso);
+        }
+        if (N_sites[0] == 0) {
+            return forceeval(alpha_r_asso);
+        }
+
         // Calculate a and b of the mixture
         auto [a_cubic, b_cubic] = cubic.get_ab(T, molefrac);
 
         // Calculate the fraction of sites not bonded with other active sites
         auto RT = forceeval(R_gas * T); // R times T
-        auto XA = XA_calc_pure(N_sites[0], classes[0], epsABi[0], betaABi[0], b_cubic, RT, rhomolar, molefrac);
+        auto XA = XA_calc_pure(N_sites[0], classes[0], dist, epsABi[0], betaABi[0], b_cubic, RT, rhomolar, molefrac);
 
-        using return_type = std::common_type_t<decltype(T), decltype(rhomolar), decltype(molefrac[0])>;
-        return_type alpha_r_asso = 0.0;
         auto i = 0;
         for (auto xi : molefrac){ // loop over all components
             auto XAi = XA.col(i);
@@ -286,7 +675,16 @@ inline auto CPAfactory(const nlohmann::json &j){
             classes.push_back(get_association_classes(p["class"]));
             i++;
         }
-        return CPAAssociation(std::move(cubic), classes, epsABi, betaABi, j["R_gas / J/mol/K"]);
+        // The radial distribution function of Kontogeorgis et al. (KG) unless another one is given
+        auto dist = radial_dist::KG;
+        if (j.contains("radial_dist")) {
+            dist = get_radial_dist_flag(j["radial_dist"]);
+        }
+        auto assoc = CPAAssociation(std::move(cubic), classes, epsABi, betaABi, j["R_gas / J/mol/K"], dist);
+        if (j.contains("warm_start")) {
+            assoc.set_warm_start(j["warm_start"]);
+        }
+        return assoc;
     };
 	return CPAEOS(build_cubic(j), build_assoc(build_cubic(j), j));
 }
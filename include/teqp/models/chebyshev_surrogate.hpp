@@ -0,0 +1,300 @@
+#pragma once
+
+/*
+A tabulated surrogate of a model at fixed composition, as two-dimensional Chebyshev expansions in tau and delta
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "teqp/types.hpp"
+#include "teqp/exceptions.hpp"
+#include "teqp/arena.hpp"
+#include "teqp/derivs.hpp"
+#include "teqp/parallel.hpp"
+
+#include <Eigen/Dense>
+
+namespace teqp {
+
+/// Controls of the construction of a ChebyshevSurrogate
+struct ChebyshevSurrogateOptions {
+    int Ntau = 16; ///< The degree of the expansions in tau
+    int Ndelta = 24; ///< The degree of the expansions in delta
+    int Npatches_tau = 1; ///< The number of patches (each with its own expansion) along tau
+    int Npatches_delta = 4; ///< The number of patches along delta
+    int Ncheck = 6; ///< The number of points along tau and along delta in each patch at which the errors are checked
+};
+
+/**
+* \brief The largest absolute deviations of the surrogate from the model at the check points, for the derivatives \f$\Lambda^{\rm r}_{ij}\f$ of TDXDerivatives
+*
+* These are estimates, not bounds: the deviations are sampled at ChebyshevSurrogateOptions::Ncheck x Ncheck points
+* in each patch, and may be larger between them. ChebyshevSurrogate::get_tails gives the size of the last
+* coefficients of each patch, which shows whether the expansions have converged
+*/
+struct ChebyshevSurrogateErrors {
+    double Ar00 = 0, Ar01 = 0, Ar10 = 0, Ar02 = 0, Ar11 = 0, Ar20 = 0;
+};
+
+class ChebyshevSurrogate;
+template<typename Model>
+ChebyshevSurrogate build_Chebyshev_surrogate(const Model& model, const Eigen::ArrayXd& z, double Tmin, double Tmax, double rhomin, double rhomax, const ChebyshevSurrogateOptions& options = {}, std::size_t Nthreads = 0);
+
+/**
+* \brief A model that evaluates \f$\alpha^{\rm r}\f$ of another model at fixed composition from tabulated expansions
+*
+* The window \f$[T_{\rm min}, T_{\rm max}]\times[\rho_{\rm min}, \rho_{\rm max}]\f$ is mapped to \f$\tau = T_{\rm max}/T\f$
+* and \f$\delta = \rho/\rho_{\rm max}\f$ and split into rectangular patches, and in each patch \f$\alpha^{\rm r}\f$ is a
+* tensor product Chebyshev expansion in \f$\tau\f$ and \f$\delta\f$. The expansions are polynomials, so alphar can be
+* evaluated with all the numerical types of TDXDerivatives; the closed-form derivatives are also available with
+* ADBackends::analytic (see alphar_taudeltaderivs).
+*
+* The composition is fixed: alphar checks that the mole fractions are those of the table, and derivatives with
+* respect to composition (e.g., from IsochoricDerivatives) are not represented. Evaluation outside the window throws.
+* Use build_Chebyshev_surrogate to make one
+*/
+class ChebyshevSurrogate {
+private:
+    Eigen::ArrayXd z; ///< The mole fractions of the table
+    double Rvalue; ///< The gas constant of the model at the composition of the table
+    double Tmin, Tmax, rhomin, rhomax;
+    double tau_min, tau_max, delta_min, delta_max;
+    int Npatches_tau, Npatches_delta;
+    std::vector<Eigen::ArrayXXd> coeffs; ///< The coefficients of each patch (row index of tau, column of delta), patch (p, q) at p*Npatches_delta + q
+    ChebyshevSurrogateErrors errors;
+
+    template<typename Model>
+    friend ChebyshevSurrogate build_Chebyshev_surrogate(const Model&, const Eigen::ArrayXd&, double, double, double, double, const ChebyshevSurrogateOptions&, std::size_t);
+
+    ChebyshevSurrogate(const Eigen::ArrayXd& z, double R, double Tmin, double Tmax, double rhomin, double rhomax, int Npatches_tau, int Npatches_delta)
+        : z(z), Rvalue(R), Tmin(Tmin), Tmax(Tmax), rhomin(rhomin), rhomax(rhomax),
+        tau_min(1.0), tau_max(Tmax / Tmin), delta_min(rhomin / rhomax), delta_max(1.0),
+        Npatches_tau(Npatches_tau), Npatches_delta(Npatches_delta), coeffs(Npatches_tau* Npatches_delta) {}
+
+    /// The index of the patch along one direction, and its bounds
+    static auto locate(double v, double vmin, double vmax, int Npatches, const char* name) {
+        const double tol = 1e-12 * (vmax - vmin);
+        if (!(v >= vmin - tol && v <= vmax + tol)) {
+            throw InvalidArgument(std::string(name) + " of " + std::to_string(v) + " is outside of the window [" + std::to_string(vmin) + ", " + std::to_string(vmax) + "] of the surrogate");
+        }
+        const double width = (vmax - vmin) / Npatches;
+        int i = std::clamp(static_cast<int>((v - vmin) / width), 0, Npatches - 1);
+        return std::make_tuple(i, vmin + i * width, vmin + (i + 1) * width);
+    }
+
+    template<typename VecType>
+    void check_composition(const VecType& molefrac) const {
+        if (static_cast<Eigen::Index>(molefrac.size()) != z.size()) {
+            throw InvalidArgument("The surrogate is for " + std::to_string(z.size()) + " components");
+        }
+        for (auto i = 0; i < z.size(); ++i) {
+            if (std::abs(static_cast<double>(getbaseval(molefrac[i])) - z[i]) > 1e-12) {
+                throw InvalidArgument("The surrogate is only valid for the composition it was built for");
+            }
+        }
+    }
+
+    /// Evaluate a tensor product Chebyshev expansion with Clenshaw's method, in x for each row and then in y
+    template<typename XType, typename YType>
+    static auto Clenshaw2D(const Eigen::ArrayXXd& C, const XType& x, const YType& y) {
+        using result_t = std::common_type_t<XType, YType>;
+        const auto Nx = C.rows() - 1, Ny = C.cols() - 1;
+        auto row = [&](Eigen::Index i) {
+            YType b1 = 0.0, b2 = 0.0;
+            for (auto k = Ny; k >= 1; --k) {
+                YType b0 = forceeval(2.0 * y * b1 - b2 + C(i, k));
+                b2 = b1; b1 = b0;
+            }
+            return forceeval(y * b1 - b2 + C(i, 0));
+        };
+        result_t u1 = 0.0, u2 = 0.0;
+        for (auto i = Nx; i >= 1; --i) {
+            result_t u0 = forceeval(2.0 * x * u1 - u2 + row(i));
+            u2 = u1; u1 = u0;
+        }
+        return forceeval(x * u1 - u2 + row(0));
+    }
+
+    /// Column d of the result holds the d-th derivatives of T_0(x), ..., T_N(x), for d = 0, ..., 4
+    template<typename MatrixType>
+    static void Chebyshev_basis_derivs(double x, MatrixType& B) {
+        const auto N = B.rows() - 1;
+        B.setZero();
+        B(0, 0) = 1;
+        if (N == 0) { return; }
+        B(1, 0) = x; B(1, 1) = 1;
+        for (auto k = 2; k <= N; ++k) {
+            for (auto d = 0; d <= 4; ++d) {
+                // Differentiate T_k = 2x T_{k-1} - T_{k-2} d times
+                B(k, d) = 2 * x * B(k - 1, d) - B(k - 2, d) + ((d > 0) ? 2.0 * d * B(k - 1, d - 1) : 0.0);
+            }
+        }
+    }
+
+public:
+    template<class VecType>
+    auto R(const VecType& /*molefrac*/) const {
+        return Rvalue;
+    }
+
+    template<typename TType, typename RhoType, typename VecType>
+    auto alphar(const TType& T, const RhoType& rho, const VecType& molefrac) const {
+        check_composition(molefrac);
+        auto tau = forceeval(Tmax / T);
+        auto delta = forceeval(rho / rhomax);
+        auto [p, ta, tb] = locate(getbaseval(tau), tau_min, tau_max, Npatches_tau, "tau");
+        auto [q, da, db] = locate(getbaseval(delta), delta_min, delta_max, Npatches_delta, "delta");
+        auto x = forceeval((2.0 * tau - (ta + tb)) / (tb - ta));
+        auto y = forceeval((2.0 * delta - (da + db)) / (db - da));
+        return Clenshaw2D(coeffs[p * Npatches_delta + q], x, y);
+    }
+
+    /**
+    * \brief Closed-form derivatives of the surrogate with respect to \f$\tau\f$ and \f$\delta\f$, in double precision
+    *
+    * Element (i,j) is \f$\tau^i\delta^j\partial^{i+j}\alpha^{\rm r}/\partial\tau^i\partial\delta^j\f$ for \f$i+j\leq 4\f$,
+    * laid out as the TauDeltaDerivs of the multifluid model, so this is what TDXDerivatives uses for ADBackends::analytic.
+    * Only the elements with \f$i+j\leq\f$ order are calculated; the others are zero
+    */
+    template<typename MoleFracType>
+    auto alphar_taudeltaderivs(const double T, const double rho, const MoleFracType& molefrac, int order = 4) const {
+        check_composition(molefrac);
+        const double tau = Tmax / T, delta = rho / rhomax;
+        auto [p, ta, tb] = locate(tau, tau_min, tau_max, Npatches_tau, "tau");
+        auto [q, da, db] = locate(delta, delta_min, delta_max, Npatches_delta, "delta");
+        const auto& C = coeffs[p * Npatches_delta + q];
+
+        ArenaScope scratch;
+        auto Bx = scratch.matrix<double>(C.rows(), 5), By = scratch.matrix<double>(C.cols(), 5), CBy = scratch.matrix<double>(C.rows(), 5);
+        Chebyshev_basis_derivs((2.0 * tau - (ta + tb)) / (tb - ta), Bx);
+        Chebyshev_basis_derivs((2.0 * delta - (da + db)) / (db - da), By);
+        CBy.noalias() = C.matrix() * By;
+        const double sx = 2.0 / (tb - ta) * tau, sy = 2.0 / (db - da) * delta; // Chain rule, and the factors of tau and delta
+
+        Eigen::Array<double, 5, 5> o = Eigen::Array<double, 5, 5>::Zero();
+        for (auto i = 0; i <= order; ++i) {
+            for (auto j = 0; i + j <= order; ++j) {
+                o(i, j) = powi(sx, i) * powi(sy, j) * Bx.col(i).dot(CBy.col(j));
+            }
+        }
+        return o;
+    }
+
+    /// The largest deviations from the model at the check points, see ChebyshevSurrogateErrors; estimates, not bounds
+    const auto& get_errors() const { return errors; }
+
+    /// For each patch (in the order of coeffs), the largest magnitude of the coefficients of the highest degree in tau 
+    /// or in delta; if the expansions have converged, this is of the order of the truncation error of alphar in the patch
+    std::vector<double> get_tails() const {
+        std::vector<double> tails;
+        for (const auto& C : coeffs) {
+            tails.push_back(std::max(C.row(C.rows() - 1).abs().maxCoeff(), C.col(C.cols() - 1).abs().maxCoeff()));
+        }
+        return tails;
+    }
+
+    /// The window of the surrogate, as Tmin, Tmax (in K), rhomin and rhomax (in mol/m^3)
+    auto get_window() const { return std::make_tuple(Tmin, Tmax, rhomin, rhomax); }
+
+    /// The number of coefficients in all the patches
+    auto get_N_coeffs() const {
+        std::size_t N = 0;
+        for (const auto& C : coeffs) { N += C.size(); }
+        return N;
+    }
+};
+
+namespace detail {
+    /// The matrix that takes the values at the Chebyshev-Lobatto nodes cos(pi*k/N), k = 0, ..., N to the coefficients of the expansion
+    inline Eigen::MatrixXd Chebyshev_Lobatto_matrix(int N) {
+        Eigen::MatrixXd M(N + 1, N + 1);
+        for (auto j = 0; j <= N; ++j) {
+            for (auto k = 0; k <= N; ++k) {
+                double w = ((k == 0 || k == N) ? 0.5 : 1.0) * ((j == 0 || j == N) ? 0.5 : 1.0);
+                M(j, k) = 2.0 / N * w * cos(EIGEN_PI * j * k / N);
+            }
+        }
+        return M;
+    }
+}
+
+/**
+* \brief Tabulate a model at fixed composition in a window of temperature and density, see ChebyshevSurrogate
+*
+* The model is evaluated at the Chebyshev-Lobatto nodes of all the patches, in parallel; only const methods of the
+* model are called, so it is shared by the threads. The surrogate is then compared with the model at
+* options.Ncheck x options.Ncheck points inside each patch (also in parallel), which gives get_errors(). Those are the
+* largest deviations at the sampled points, so estimates of the errors rather than bounds; see also get_tails()
+*
+* \param model The model to tabulate
+* \param z The mole fractions
+* \param Tmin, Tmax The range of temperature, in K
+* \param rhomin, rhomax The range of molar density, in mol/m^3
+* \param options The degrees of the expansions and the numbers of patches
+* \param Nthreads The number of threads; if 0, the number of hardware threads
+*/
+template<typename Model>
+ChebyshevSurrogate build_Chebyshev_surrogate(const Model& model, const Eigen::ArrayXd& z, double Tmin, double Tmax, double rhomin, double rhomax, const ChebyshevSurrogateOptions& options, std::size_t Nthreads) {
+    if (!(0 < Tmin && Tmin < Tmax) || !(0 <= rhomin && rhomin < rhomax)) {
+        throw InvalidArgument("The window of the surrogate must have Tmin < Tmax and rhomin < rhomax");
+    }
+    if (options.Ntau < 1 || options.Ndelta < 1 || options.Npatches_tau < 1 || options.Npatches_delta < 1) {
+        throw InvalidArgument("The degrees and the numbers of patches of the surrogate must be at least one");
+    }
+    ChebyshevSurrogate s(z, model.R(z), Tmin, Tmax, rhomin, rhomax, options.Npatches_tau, options.Npatches_delta);
+    const int Nt = options.Ntau, Nd = options.Ndelta, Pt = options.Npatches_tau, Pd = options.Npatches_delta;
+    const double dtau = (s.tau_max - s.tau_min) / Pt, ddelta = (s.delta_max - s.delta_min) / Pd;
+
+    // The values of alphar at the nodes; all the nodes of all the patches are handed out to the threads together
+    std::vector<Eigen::MatrixXd> F(Pt * Pd, Eigen::MatrixXd(Nt + 1, Nd + 1));
+    const std::size_t Nnodes_patch = (Nt + 1) * (Nd + 1);
+    parallel_for_chunks(F.size() * Nnodes_patch, Nthreads, [&](std::size_t ibegin, std::size_t iend) {
+        for (auto n = ibegin; n < iend; ++n) {
+            const auto ipatch = static_cast<int>(n / Nnodes_patch), inode = static_cast<int>(n % Nnodes_patch);
+            const int p = ipatch / Pd, q = ipatch % Pd, k = inode / (Nd + 1), l = inode % (Nd + 1);
+            const double ta = s.tau_min + p * dtau, da = s.delta_min + q * ddelta;
+            const double tau = ta + dtau / 2 * (1 + cos(EIGEN_PI * k / Nt)), delta = da + ddelta / 2 * (1 + cos(EIGEN_PI * l / Nd));
+            F[ipatch](k, l) = getbaseval(model.alphar(Tmax / tau, delta * rhomax, z));
+        }
+    });
+    const auto Mt = detail::Chebyshev_Lobatto_matrix(Nt), Md = detail::Chebyshev_Lobatto_matrix(Nd);
+    for (auto ipatch = 0U; ipatch < F.size(); ++ipatch) {
+        s.coeffs[ipatch] = (Mt * F[ipatch] * Md.transpose()).array();
+    }
+
+    // Compare with the model at points that are not nodes
+    const int Nc = options.Ncheck;
+    std::vector<ChebyshevSurrogateErrors> errors(Pt * Pd * Nc * Nc);
+    parallel_for_chunks(errors.size(), Nthreads, [&](std::size_t ibegin, std::size_t iend) {
+        using tdxm = TDXDerivatives<Model, double, Eigen::ArrayXd>;
+        using tdxs = TDXDerivatives<ChebyshevSurrogate, double, Eigen::ArrayXd>;
+        for (auto n = ibegin; n < iend; ++n) {
+            const auto ipatch = static_cast<int>(n / (Nc * Nc)), ipoint = static_cast<int>(n % (Nc * Nc));
+            const int p = ipatch / Pd, q = ipatch % Pd, k = ipoint / Nc, l = ipoint % Nc;
+            const double ta = s.tau_min + p * dtau, da = s.delta_min + q * ddelta;
+            const double tau = ta + dtau / 2 * (1 + cos(EIGEN_PI * (k + 0.5) / Nc)), delta = da + ddelta / 2 * (1 + cos(EIGEN_PI * (l + 0.5) / Nc));
+            const double T = Tmax / tau, rho = delta * rhomax;
+            auto& e = errors[n];
+            e.Ar00 = std::abs(tdxm::get_Ar00(model, T, rho, z) - tdxs::get_Ar00(s, T, rho, z));
+            e.Ar01 = std::abs(tdxm::get_Ar01(model, T, rho, z) - tdxs::get_Ar01(s, T, rho, z));
+            e.Ar10 = std::abs(tdxm::get_Ar10(model, T, rho, z) - tdxs::get_Ar10(s, T, rho, z));
+            e.Ar02 = std::abs(tdxm::get_Ar02(model, T, rho, z) - tdxs::get_Ar02(s, T, rho, z));
+            e.Ar11 = std::abs(tdxm::get_Ar11(model, T, rho, z) - tdxs::get_Ar11(s, T, rho, z));
+            e.Ar20 = std::abs(tdxm::get_Ar20(model, T, rho, z) - tdxs::get_Ar20(s, T, rho, z));
+        }
+    });
+    for (const auto& e : errors) {
+        s.errors.Ar00 = std::max(s.errors.Ar00, e.Ar00);
+        s.errors.Ar01 = std::max(s.errors.Ar01, e.Ar01);
+        s.errors.Ar10 = std::max(s.errors.Ar10, e.Ar10);
+        s.errors.Ar02 = std::max(s.errors.Ar02, e.Ar02);
+        s.errors.Ar11 = std::max(s.errors.Ar11, e.Ar11);
+        s.errors.Ar20 = std::max(s.errors.Ar20, e.Ar20);
+    }
+    return s;
+}
+
+}; // namespace teqp
@@ -11,6 +11,7 @@ Implementations of the canonical cubic equations of state
 #include "teqp/types.hpp"
 #include "teqp/constants.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/arena.hpp"
 #include "cubicsuperancillary.hpp"
 
 #include "nlohmann/json.hpp"
@@ -27,6 +28,7 @@ class BasicAlphaFunction {
 private:
     NumType Tci, ///< The critical temperature
         mi;  ///< The "m" parameter
+    friend struct ModelSerializer; // For binary serialization, see teqp/serialization.hpp
 public:
     BasicAlphaFunction(NumType Tci, NumType mi) : Tci(Tci), mi(mi) {};
 
@@ -47,8 +49,10 @@ protected:
     int superanc_index; 
     const AlphaFunctions alphas;
     Eigen::ArrayXXd kmat;
+    bool kmat_is_zero = true; ///< True if all the interaction parameters are zero, so the mixing rule for a is rank one
 
     nlohmann::json meta;
+    friend struct ModelSerializer; // For binary serialization, see teqp/serialization.hpp
 
     template<typename TType, typename IndexType>
     auto get_ai(TType T, IndexType i) const { return ai[i]; }
@@ -66,6 +70,7 @@ protected:
         else if (kmat.cols() != N) {
             throw teqp::InvalidArgument("kmat needs to be a square matrix the same size as the number of components [" + std::to_string(N) + "]");
         }
+        kmat_is_zero = (kmat == 0.0).all();
     };
 
 public:
@@ -106,21 +111,45 @@ public:
         return Ru;
     }
 
+    /**
+    * \brief The attraction parameter of the mixture, a = sum_i sum_j x_i*x_j*(1-k_ij)*sqrt(a_i*alpha_i*a_j*alpha_j)
+    *
+    * The alpha functions and the square roots are only evaluated once per component. With w_i = x_i*sqrt(a_i*alpha_i),
+    * a = (sum_i w_i)^2 - sum_i sum_j w_i*k_ij*w_j, so without interaction parameters the cost is linear in the number of 
+    * components, and otherwise it is one pass over k_ij with no transcendental functions
+    */
     template<typename TType, typename CompType>
     auto get_a(TType T, const CompType& molefracs) const {
-        std::common_type_t<TType, decltype(molefracs[0])> a_ = 0.0;
-        auto ai = this->ai;
-        for (auto i = 0; i < molefracs.size(); ++i) {
+        using result_t = std::common_type_t<TType, decltype(molefracs[0])>;
+        const auto N = static_cast<Eigen::Index>(molefracs.size());
+        ArenaScope scratch;
+        auto w = scratch.array<result_t>(N);
+        result_t sumw = 0.0;
+        for (auto i = 0; i < N; ++i) {
             auto alphai = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[i]));
-            auto ai_ = forceeval(ai[i] * alphai);
-            for (auto j = 0; j < molefracs.size(); ++j) {
-                auto alphaj = forceeval(std::visit([&](auto& t) { return t(T); }, alphas[j]));
-                auto aj_ = ai[j] * alphaj;
-                auto aij = forceeval((1 - kmat(i,j)) * sqrt(ai_ * aj_));
-                a_ = a_ + molefracs[i] * molefracs[j] * aij;
+            w[i] = forceeval(molefracs[i] * sqrt(ai[i] * alphai));
+            sumw = sumw + w[i];
+        }
+        result_t a_ = forceeval(sumw * sumw);
+        if (kmat_is_zero) {
+            return a_;
+        }
+        if constexpr (std::is_same_v<result_t, double>) {
+            auto Kw = scratch.array<double>(N);
+            Kw.matrix().noalias() = kmat.matrix() * w.matrix();
+            return forceeval(a_ - (w * Kw).sum());
+        }
+        else {
+            // The kernel is symmetrized, so each pair is visited once; k_ij and k_ji need not be equal
+            for (auto i = 0; i < N; ++i) {
+                result_t row = kmat(i, i) * w[i];
+                for (auto j = 0; j < i; ++j) {
+                    row = row + (kmat(i, j) + kmat(j, i)) * w[j];
+                }
+                a_ = a_ - w[i] * row;
             }
+            return forceeval(a_);
         }
-        return forceeval(a_);
     }
 
     template<typename TType, typename CompType>
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "nlohmann/json.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "teqp/filesystem.hpp"
+#include "teqp/json_tools.hpp"
+#include "teqp/models/multifluid_reducing.hpp"
+
+namespace teqp {
+
+/**
+* \brief A library of pure fluid JSON data, loaded once and indexed by all the identifiers of the fluids
+*
+* All the files in the dev/fluids folder of the root are parsed at construction. Each fluid can then be
+* looked up by the stem of its file name, the absolute path of its file, its NAME, CAS number, REFPROP name
+* or any of its ALIASES. The binary interaction parameter and departure function collections in the dev/mixtures
+* folder are also loaded if they exist, so that models can be built without touching the filesystem again.
+*
+* The mixture collections are indexed by pair of identifiers and by departure function name once, when the library
+* is loaded, so that building many models from one library does not search the collections each time.
+*
+* The parsed data can be written to a single binary (CBOR) file with to_binary and reloaded with from_binary, so that
+* the fluid files do not need to be shipped. Reloading takes about as long as parsing the JSON files; the speedup in
+* building models comes from the in-memory index, not from the file format.
+*/
+class FluidLibrary {
+private:
+    std::string root;
+    std::vector<nlohmann::json> fluids; ///< The parsed JSON data of each fluid
+    std::vector<std::string> paths; ///< The absolute path of the file that each fluid was loaded from
+    std::unordered_map<std::string, std::size_t> index; ///< Map from identifier to the index of the fluid
+    reducing::BinaryPairIndex BIPindex{ nlohmann::json() }; ///< The binary interaction parameters, indexed by pair
+    reducing::DepartureFunctionIndex depindex{ nlohmann::json() }; ///< The departure functions, indexed by name
+
+    FluidLibrary() = default;
+
+    void add_identifier(const std::string& identifier, std::size_t i) {
+        auto it = index.find(identifier);
+        if (it != index.end() && it->second != i) {
+            throw std::invalid_argument("Duplicated identifier [" + identifier + "] found in files: " + paths[it->second] + " and " + paths[i]);
+        }
+        index[identifier] = i;
+    }
+
+    /// Build the index from the loaded fluids, with the same rules for the identifiers as build_alias_map
+    void build_index() {
+        index.clear();
+        for (auto i = 0U; i < fluids.size(); ++i) {
+            const auto& info = fluids[i].at("INFO");
+            add_identifier(std::filesystem::path(paths[i]).stem().string(), i);
+            add_identifier(paths[i], i);
+            add_identifier(info.at("NAME"), i);
+            add_identifier(info.at("CAS"), i);
+            std::string REFPROP_name = info.at("REFPROP_NAME");
+            if (REFPROP_name != "N/A") {
+                add_identifier(REFPROP_name, i);
+            }
+            for (std::string alias : info.at("ALIASES")) {
+                add_identifier(alias, i);
+            }
+        }
+    }
+
+public:
+    /// Load and index all the fluids below the root (the folder containing dev/fluids and dev/mixtures)
+    explicit FluidLibrary(const std::string& root) : root(root) {
+        for (const auto& path : get_files_in_folder(root + "/dev/fluids", ".json")) {
+            fluids.push_back(load_a_JSON_file(path.string()));
+            paths.push_back(std::filesystem::absolute(path).string());
+        }
+        auto load_if_exists = [](const std::string& path) {
+            return (std::filesystem::is_regular_file(path)) ? load_a_JSON_file(path) : nlohmann::json();
+        };
+        BIPindex = reducing::BinaryPairIndex(load_if_exists(root + "/dev/mixtures/mixture_binary_pairs.json"));
+        depindex = reducing::DepartureFunctionIndex(load_if_exists(root + "/dev/mixtures/mixture_departure_functions.json"));
+        build_index();
+    }
+
+    /// Write the parsed data to a binary (CBOR) file that can be reloaded with from_binary
+    void to_binary(const std::string& path) const {
+        nlohmann::json j = {
+            {"root", root},
+            {"fluids", fluids},
+            {"paths", paths},
+            {"BIP", BIPindex.get_collection()},
+            {"departure", depindex.get_collection()}
+        };
+        auto bytes = nlohmann::json::to_cbor(j);
+        std::ofstream ofs(path, std::ios::binary);
+        if (!ofs) {
+            throw std::invalid_argument("File stream cannot be opened for writing: " + path);
+        }
+        ofs.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+
+    /// Load a library that was written with to_binary
+    static FluidLibrary from_binary(const std::string& path) {
+        std::ifstream ifs(path, std::ios::binary);
+        if (!ifs) {
+            throw std::invalid_argument("File stream cannot be opened from: " + path);
+        }
+        std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        nlohmann::json j;
+        try {
+            j = nlohmann::json::from_cbor(bytes);
+        }
+        catch (...) {
+            throw std::invalid_argument("File at " + path + " is not a valid binary fluid library");
+        }
+        FluidLibrary lib;
+        lib.root = j.at("root");
+        lib.fluids = j.at("fluids").get<std::vector<nlohmann::json>>();
+        lib.paths = j.at("paths").get<std::vector<std::string>>();
+        lib.BIPindex = reducing::BinaryPairIndex(j.at("BIP"));
+        lib.depindex = reducing::DepartureFunctionIndex(j.at("departure"));
+        lib.build_index();
+        return lib;
+    }
+
+    /**
+    * \brief Get the library for the given root, shared by the whole process
+    *
+    * The library is loaded on the first call for a root and the same instance is returned on all the
+    * following calls; this function may be called from several threads at once
+    */
+    static std::shared_ptr<const FluidLibrary> get_shared(const std::string& root) {
+        static std::mutex mutex;
+        static std::map<std::string, std::shared_ptr<const FluidLibrary>> libraries;
+        auto key = std::filesystem::weakly_canonical(root).string();
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = libraries.find(key);
+        if (it == libraries.end()) {
+            it = libraries.emplace(key, std::make_shared<const FluidLibrary>(root)).first;
+        }
+        return it->second;
+    }
+
+    /// The root that the library was loaded from
+    const std::string& get_root() const { return root; }
+    /// The number of fluids in the library
+    std::size_t size() const { return fluids.size(); }
+    /// The index of the fluid with this identifier, if there is one
+    std::optional<std::size_t> find(const std::string& identifier) const {
+        auto it = index.find(identifier);
+        if (it == index.end()) { return std::nullopt; }
+        return it->second;
+    }
+    /// True if a fluid with this identifier is in the library
+    bool contains(const std::string& identifier) const { return index.count(identifier) > 0; }
+
+    /// The JSON data of the fluid with this identifier
+    const nlohmann::json& get_fluid_JSON(const std::string& identifier) const {
+        auto i = find(identifier);
+        if (!i) {
+            throw std::invalid_argument("Unable to find the fluid [" + identifier + "] in the library at: " + root);
+        }
+        return fluids[i.value()];
+    }
+    /// The absolute path of the file for the fluid with this identifier
+    const std::string& get_path(const std::string& identifier) const {
+        auto i = find(identifier);
+        if (!i) {
+            throw std::invalid_argument("Unable to find the fluid [" + identifier + "] in the library at: " + root);
+        }
+        return paths[i.value()];
+    }
+
+    /// The collection of binary interaction parameters; null if the file was not found
+    const nlohmann::json& get_BIP_collection() const { return BIPindex.get_collection(); }
+    /// The collection of departure functions; null if the file was not found
+    const nlohmann::json& get_departure_collection() const { return depindex.get_collection(); }
+    /// The index of the binary interaction parameters
+    const reducing::BinaryPairIndex& get_BIP_index() const { return BIPindex; }
+    /// The index of the departure functions
+    const reducing::DepartureFunctionIndex& get_departure_index() const { return depindex; }
+};
+
+}; // namespace teqp
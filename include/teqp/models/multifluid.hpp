@@ -7,12 +7,15 @@
 #include <cmath>
 #include <optional>
 #include <variant>
+#include <type_traits>
+#include <utility>
 
 #include "teqp/types.hpp"
 #include "teqp/constants.hpp"
 #include "teqp/filesystem.hpp"
 #include "teqp/json_tools.hpp"
 #include "teqp/exceptions.hpp"
+#include "teqp/models/fluid_library.hpp"
 
 #include "MultiComplex/MultiComplex.hpp"
 
@@ -44,6 +47,7 @@ class CorrespondingStatesContribution {
 
 private:
     const EOSCollection EOSs;
+    friend struct ModelSerializer; // For binary serialization, see teqp/serialization.hpp
 public:
     CorrespondingStatesContribution(EOSCollection&& EOSs) : EOSs(EOSs) {};
 
@@ -58,6 +62,38 @@ public:
         return forceeval(alphar);
     }
 
+    /// The tau-only factors of each of the pure fluid EOS at fixed tau, to be passed to alphar_taufactors
+    auto get_taufactors(double tau) const {
+        std::vector<std::vector<Eigen::ArrayXd>> factors;
+        for (const auto& EOS : EOSs) {
+            factors.emplace_back(EOS.get_taufactors(tau));
+        }
+        return factors;
+    }
+
+    /// Evaluate the contribution at fixed tau and composition given the tau-only factors from get_taufactors
+    template<typename TauFactors, typename DeltaType, typename MoleFractions>
+    auto alphar_taufactors(const TauFactors& factors, const DeltaType& delta, const MoleFractions& molefracs) const {
+        using resulttype = std::common_type_t<decltype(delta), decltype(molefracs[0])>; // Type promotion, without the const-ness
+        resulttype alphar = 0.0;
+        auto N = molefracs.size();
+        for (auto i = 0; i < N; ++i) {
+            alphar = alphar + molefracs[i] * EOSs[i].alphar_taufactors(factors[i], delta);
+        }
+        return forceeval(alphar);
+    }
+
+    /// Closed-form derivatives of the contribution with respect to tau and delta, see TauDeltaDerivs
+    template<typename MoleFractions>
+    auto alphar_taudeltaderivs(double tau, double delta, const MoleFractions& molefracs, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        auto N = molefracs.size();
+        for (auto i = 0; i < N; ++i) {
+            o += static_cast<double>(molefracs[i]) * EOSs[i].alphar_taudeltaderivs(tau, delta, order);
+        }
+        return o;
+    }
+
     template<typename TauType, typename DeltaType>
     auto alphari(const TauType& tau, const DeltaType& delta, std::size_t i) const {
         return EOSs[i].alphar(tau, delta);
@@ -74,6 +110,7 @@ class DepartureContribution {
 private:
     const FCollection F;
     const DepartureFunctionCollection funcs;
+    friend struct ModelSerializer; // For binary serialization, see teqp/serialization.hpp
 public:
     DepartureContribution(FCollection&& F, DepartureFunctionCollection&& funcs) : F(F), funcs(funcs) {};
 
@@ -90,6 +127,52 @@ public:
         return forceeval(alphar);
     }
 
+    /// The tau-only factors of each of the departure functions at fixed tau, to be passed to alphar_taufactors
+    /// Only the upper triangle (j > i) is populated, and pairs with F(i,j) = 0 are skipped
+    auto get_taufactors(double tau) const {
+        auto N = funcs.size();
+        std::vector<std::vector<std::vector<Eigen::ArrayXd>>> factors(N, std::vector<std::vector<Eigen::ArrayXd>>(N));
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = i + 1; j < N; ++j) {
+                if (F(i, j) != 0.0) {
+                    factors[i][j] = funcs[i][j].get_taufactors(tau);
+                }
+            }
+        }
+        return factors;
+    }
+
+    /// Evaluate the contribution at fixed tau and composition given the tau-only factors from get_taufactors
+    template<typename TauFactors, typename DeltaType, typename MoleFractions>
+    auto alphar_taufactors(const TauFactors& factors, const DeltaType& delta, const MoleFractions& molefracs) const {
+        using resulttype = std::common_type_t<decltype(delta), decltype(molefracs[0])>; // Type promotion, without the const-ness
+        resulttype alphar = 0.0;
+        auto N = molefracs.size();
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = i + 1; j < N; ++j) {
+                if (F(i, j) != 0.0) {
+                    alphar = alphar + molefracs[i] * molefracs[j] * F(i, j) * funcs[i][j].alphar_taufactors(factors[i][j], delta);
+                }
+            }
+        }
+        return forceeval(alphar);
+    }
+
+    /// Closed-form derivatives of the contribution with respect to tau and delta, see TauDeltaDerivs
+    template<typename MoleFractions>
+    auto alphar_taudeltaderivs(double tau, double delta, const MoleFractions& molefracs, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        auto N = molefracs.size();
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = i + 1; j < N; ++j) {
+                if (F(i, j) != 0.0) {
+                    o += static_cast<double>(molefracs[i] * molefracs[j] * F(i, j)) * funcs[i][j].alphar_taudeltaderivs(tau, delta, order);
+                }
+            }
+        }
+        return o;
+    }
+
     /// Call a single departure term at i,j 
     template<typename TauType, typename DeltaType>
     auto get_alpharij(const int i, const int j,     const TauType& tau, const DeltaType& delta) const {
@@ -148,8 +231,108 @@ public:
         auto val = corr.alphar(tau, delta, molefrac) + dep.alphar(tau, delta, molefrac);
         return forceeval(val);
     }
+
+    /**
+    * \brief Closed-form derivatives of \f$\alpha^{\rm r}\f$ with respect to \f$\tau\f$ and \f$\delta\f$, in double precision
+    * 
+    * Element (i,j) of the returned TauDeltaDerivs is \f$\tau^i\delta^j\partial^{i+j}\alpha^{\rm r}/\partial\tau^i\partial\delta^j\f$ for \f$i+j\leq 4\f$.
+    * As \f$\tau\f$ is proportional to \f$1/T\f$ and \f$\delta\f$ to \f$\rho\f$ at fixed composition, this is 
+    * also \f$\Lambda^{\rm r}_{ij}\f$, which is how TDXDerivatives uses it for ADBackends::analytic.
+    * Only the elements with \f$i+j\leq\f$ order are calculated; the others are zero
+    */
+    template<typename MoleFracType>
+    auto alphar_taudeltaderivs(const double T, const double rho, const MoleFracType& molefrac, int order = 4) const {
+        double Tred = getbaseval(redfunc.get_Tr(molefrac));
+        double rhored = getbaseval(redfunc.get_rhor(molefrac));
+        double tau = Tred / T, delta = rho / rhored;
+        TauDeltaDerivs o = corr.alphar_taudeltaderivs(tau, delta, molefrac, order) + dep.alphar_taudeltaderivs(tau, delta, molefrac, order);
+        return o;
+    }
+
+    /**
+    * \brief Bind the model to a fixed temperature and composition
+    * 
+    * The reducing temperature and density and the tau-only factors of all the terms are calculated once, and the 
+    * returned object can be evaluated for many densities at only the cost of the delta-dependent parts.
+    * See MultiFluidBoundState for the limitations
+    */
+    template<typename MoleFracType>
+    auto bind(const double T, const MoleFracType& molefrac) const;
 };
 
+/**
+* \brief A MultiFluid model bound to a fixed temperature and composition
+*
+* The bound state holds a reference to the model, so the model must outlive it.  
+* 
+* The alphar(T, rho, molefrac) method is provided so that the bound state can be used in place of the model
+* in density-only routines (for instance TDXDerivatives::get_Ar0n or TDXDerivatives::get_Arxy<0, n>). The temperature 
+* must be a plain double equal to the bound temperature, and the mole fractions must be the bound ones; otherwise an exception is thrown.
+*/
+template<typename Model>
+class MultiFluidBoundState {
+private:
+    const Model& model;
+    using CorrFactors = decltype(std::declval<const Model&>().corr.get_taufactors(1.0));
+    using DepFactors = decltype(std::declval<const Model&>().dep.get_taufactors(1.0));
+public:
+    const double T;
+    const Eigen::ArrayXd molefrac;
+    const double Tred, rhored, tau;
+private:
+    const CorrFactors corrfactors;
+    const DepFactors depfactors;
+    /// Throw if the mole fractions are not the bound ones (to within 1e-12), because the bound ones are always used
+    template<typename MoleFracType>
+    void check_composition(const MoleFracType& molefrac_) const {
+        static_assert(std::is_arithmetic_v<std::decay_t<decltype(molefrac_[0])>>, "Derivatives with respect to composition are not possible with a bound state");
+        if (static_cast<Eigen::Index>(molefrac_.size()) != molefrac.size()) {
+            throw teqp::InvalidArgument("Length of mole_fractions (" + std::to_string(molefrac_.size()) + ") is not the number of bound mole fractions (" + std::to_string(molefrac.size()) + ")");
+        }
+        for (auto i = 0; i < molefrac.size(); ++i) {
+            if (std::abs(molefrac_[i] - molefrac[i]) > 1e-12) {
+                throw teqp::InvalidArgument("The mole fractions are not the bound ones");
+            }
+        }
+    }
+public:
+    template<typename MoleFracType>
+    MultiFluidBoundState(const Model& model, const double T, const MoleFracType& molefrac) 
+        : model(model), T(T), molefrac(molefrac),
+          Tred(model.redfunc.get_Tr(this->molefrac)), rhored(model.redfunc.get_rhor(this->molefrac)), tau(Tred / T),
+          corrfactors(model.corr.get_taufactors(tau)), depfactors(model.dep.get_taufactors(tau)) {};
+
+    template<class VecType>
+    auto R(const VecType& molefrac) const {
+        return model.R(molefrac);
+    }
+
+    /// Evaluate alphar at the bound temperature and composition
+    template<typename RhoType>
+    auto alphar(const RhoType& rho) const {
+        auto delta = forceeval(rho / rhored);
+        auto val = model.corr.alphar_taufactors(corrfactors, delta, molefrac) + model.dep.alphar_taufactors(depfactors, delta, molefrac);
+        return forceeval(val);
+    }
+
+    /// The model-like interface, for use in density-only derivative routines
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar(const TType& T_, const RhoType& rho, const MoleFracType& molefrac_) const {
+        static_assert(std::is_arithmetic_v<TType>, "Derivatives with respect to temperature are not possible with a bound state");
+        if (T_ != T) {
+            throw teqp::InvalidArgument("Temperature of " + std::to_string(T_) + " K is not the bound temperature of " + std::to_string(T) + " K");
+        }
+        check_composition(molefrac_);
+        return alphar(rho);
+    }
+};
+
+template<typename CorrespondingTerm, typename DepartureTerm>
+template<typename MoleFracType>
+auto MultiFluid<CorrespondingTerm, DepartureTerm>::bind(const double T, const MoleFracType& molefrac) const {
+    return MultiFluidBoundState<MultiFluid<CorrespondingTerm, DepartureTerm>>(*this, T, molefrac);
+}
+
 
 /***
 * \brief Get the JSON data structure for a given departure function
@@ -423,18 +606,25 @@ inline auto build_departure_function(const nlohmann::json& j) {
     return dep;
 }
 
-inline auto get_departure_function_matrix(const nlohmann::json& depcollection, const nlohmann::json& BIPcollection, const std::vector<std::string>& components, const nlohmann::json& flags) {
+/// Build the matrix of departure functions; the collections are either the JSON data, or a reducing::DepartureFunctionIndex and a reducing::BinaryPairIndex
+template<typename DepartureCollection, typename BIPCollection>
+inline auto get_departure_function_matrix(const DepartureCollection& depcollection, const BIPCollection& BIPcollection, const std::vector<std::string>& components, const nlohmann::json& flags) {
 
     // Allocate the matrix with default models
     std::vector<std::vector<DepartureTerms>> funcs(components.size()); for (auto i = 0; i < funcs.size(); ++i) { funcs[i].resize(funcs.size()); }
 
     // Load the collection of data on departure functions
 
-    auto get_departure_json = [&depcollection](const std::string& Name) {
-        for (auto& el : depcollection) {
-            if (el["Name"] == Name) { return el; }
+    auto get_departure_json = [&depcollection](const std::string& Name) -> nlohmann::json {
+        if constexpr (std::is_same_v<DepartureCollection, reducing::DepartureFunctionIndex>) {
+            return depcollection.get(Name);
+        }
+        else {
+            for (auto& el : depcollection) {
+                if (el["Name"] == Name) { return el; }
+            }
+            throw std::invalid_argument("Bad departure function name: " + Name);
         }
-        throw std::invalid_argument("Bad departure function name: "+Name);
     };
 
     auto funcsmeta = nlohmann::json::object();
@@ -728,8 +918,8 @@ inline auto collect_identifiers(const std::vector<nlohmann::json>& pureJSON)
 }
 
 /// Iterate over the possible options for identifiers to determine which one will satisfy all the binary pairs
-template<typename mapvecstring>
-inline auto select_identifier(const nlohmann::json& BIPcollection, const mapvecstring& identifierset, const nlohmann::json& flags){
+template<typename BIPCollection, typename mapvecstring>
+inline auto select_identifier(const BIPCollection& BIPcollection, const mapvecstring& identifierset, const nlohmann::json& flags){
     for (const auto &ident: identifierset){
         std::string key; std::vector<std::string> identifiers;
         std::tie(key, identifiers) = ident;
@@ -789,8 +979,12 @@ inline auto build_alias_map(const std::string& root) {
     return aliasmap;
 }
 
-/// Internal method for actually constructing the model with the provided JSON data structures
-inline auto _build_multifluid_model(const std::vector<nlohmann::json> &pureJSON, const nlohmann::json& BIPcollection, const nlohmann::json& depcollection, const nlohmann::json& flags = {}) {
+/**
+* \brief Internal method for actually constructing the model with the provided JSON data of the pure fluids and indexed mixture parameters
+* 
+* The indices can be built once and reused for any number of models
+*/
+inline auto _build_multifluid_model(const std::vector<nlohmann::json> &pureJSON, const reducing::BinaryPairIndex& BIPcollection, const reducing::DepartureFunctionIndex& depcollection, const nlohmann::json& flags = {}) {
 
     auto [Tc, vc] = reducing::get_Tcvc(pureJSON);
     auto EOSs = get_EOSs(pureJSON);
@@ -821,6 +1015,12 @@ inline auto _build_multifluid_model(const std::vector<nlohmann::json> &pureJSON,
     return model;
 }
 
+/// Internal method for actually constructing the model with the provided JSON data structures
+inline auto _build_multifluid_model(const std::vector<nlohmann::json> &pureJSON, const nlohmann::json& BIPcollection, const nlohmann::json& depcollection, const nlohmann::json& flags = {}) {
+    // Each pair is looked up several times, so indexing the collections is cheaper than searching them
+    return _build_multifluid_model(pureJSON, reducing::BinaryPairIndex(BIPcollection), reducing::DepartureFunctionIndex(depcollection), flags);
+}
+
 /// A builder function where the JSON-formatted strings are provided explicitly rather than file paths
 inline auto build_multifluid_JSONstr(const std::vector<std::string>& componentJSON, const std::string& BIPJSON, const std::string& departureJSON, const nlohmann::json& flags = {}) {
 
@@ -851,24 +1051,50 @@ inline auto build_multifluid_model(const std::vector<std::string>& components, c
         pureJSON = collect_component_json(components, coolprop_root);
     }
     catch(...){
-        // Lookup the absolute paths for each component
-        auto aliasmap = build_alias_map(coolprop_root);
-        std::vector<std::string> abspaths;
+        // Backup lookup of the aliases in the fluid library, which is only loaded once per root
+        const auto library = FluidLibrary::get_shared(coolprop_root);
+        pureJSON.clear();
         for (auto c : components) {
             // Allow matching of absolute paths first
             if (std::filesystem::is_regular_file(c)) {
-                abspaths.push_back(c);
+                pureJSON.push_back(load_a_JSON_file(c));
             }
             else {
-                abspaths.push_back(aliasmap[c]);
+                pureJSON.push_back(library->get_fluid_JSON(c));
             }
         }
-        // Backup lookup with absolute paths resolved for each component
-        pureJSON = collect_component_json(abspaths, coolprop_root);
     }
     return _build_multifluid_model(pureJSON, BIPcollection, depcollection, flags);
 }
 
+/**
+* \brief Build a model from the fluids and mixture parameters held in memory by a FluidLibrary
+* 
+* The components can be any of the identifiers known to the library (file stem, name, CAS number, REFPROP name, 
+* alias), or paths to JSON files. Unless they are provided, the binary interaction parameters and 
+* departure functions are those of the library.
+*/
+inline auto build_multifluid_model(const std::vector<std::string>& components, const FluidLibrary& library, const nlohmann::json& flags = {}, const std::optional<nlohmann::json>& BIPcollection = std::nullopt, const std::optional<nlohmann::json>& depcollection = std::nullopt) {
+    std::vector<nlohmann::json> pureJSON;
+    for (auto c : components) {
+        if (!library.contains(c) && std::filesystem::is_regular_file(c)) {
+            pureJSON.push_back(load_a_JSON_file(c));
+        }
+        else {
+            pureJSON.push_back(library.get_fluid_JSON(c));
+        }
+    }
+    const auto& BIP = (BIPcollection) ? BIPcollection.value() : library.get_BIP_collection();
+    const auto& dep = (depcollection) ? depcollection.value() : library.get_departure_collection();
+    if (BIP.is_null() || dep.is_null()) {
+        throw std::invalid_argument("The fluid library at " + library.get_root() + " has no binary interaction parameters or departure functions and none were provided");
+    }
+    if (!BIPcollection && !depcollection) {
+        return _build_multifluid_model(pureJSON, library.get_BIP_index(), library.get_departure_index(), flags);
+    }
+    return _build_multifluid_model(pureJSON, BIP, dep, flags);
+}
+
 /**
 * \brief Load a model from a JSON data structure
 * 
@@ -1,9 +1,138 @@
 #pragma once
 
+#include <array>
+#include <variant>
+
 #include "teqp/types.hpp"
 
 namespace teqp {
 
+/**
+The derivatives of a term (or sum of terms) with respect to tau and delta, evaluated in closed form; element (i,j) is
+\f[
+\tau^i\delta^j\left(\frac{\partial^{i+j}\alpha^{\rm r}}{\partial\tau^i\partial\delta^j}\right)
+\f]
+and only the elements with \f$i+j\leq 4\f$ are populated; the others are zero. The functions that return a TauDeltaDerivs
+take the highest order that is needed (at most 4), and only populate the elements with \f$i+j\leq\f$ that order
+*/
+using TauDeltaDerivs = Eigen::Array<double, 5, 5>;
+
+namespace taudelta {
+
+    /**
+    A function \f$\phi(x)\f$ and its scaled derivatives; element k is \f$x^k\phi^{(k)}(x)\f$ for k in [0,4]
+    */
+    using Scaled = std::array<double, 5>;
+
+    /// The function \f$cx^l\f$, for \f$x\geq 0\f$
+    inline Scaled power(double x, double c, double l) {
+        Scaled o;
+        double f = (x == 0) ? (l == 0 ? c : 0.0) : c * std::pow(x, l), ff = 1.0;
+        for (auto k = 0; k < 5; ++k) {
+            o[k] = f * ff;
+            ff *= (l - k);
+        }
+        return o;
+    }
+
+    /// The function \f$c(x-x_0)^2\f$
+    inline Scaled quadratic(double x, double c, double x0) {
+        return { c * (x - x0) * (x - x0), 2.0 * c * (x - x0) * x, 2.0 * c * x * x, 0.0, 0.0 };
+    }
+
+    /// The function \f$c(x-x_0)\f$
+    inline Scaled linear(double x, double c, double x0) {
+        return { c * (x - x0), c * x, 0.0, 0.0, 0.0 };
+    }
+
+    /// The function \f$1/(\beta(x-x_0)^2+b)\f$
+    inline Scaled reciprocal_quadratic(double x, double beta, double x0, double b) {
+        double q = beta * (x - x0) * (x - x0) + b, q1 = 2.0 * beta * (x - x0), q2 = 2.0 * beta;
+        double r = 1.0 / q;
+        return {
+            r,
+            x * (-q1 * r * r),
+            x * x * (2.0 * q1 * q1 * r * r * r - q2 * r * r),
+            x * x * x * (-6.0 * q1 * q1 * q1 * pow2(r * r) + 6.0 * q1 * q2 * r * r * r),
+            pow2(x * x) * (24.0 * pow2(q1 * q1) * pow2(r * r) * r - 36.0 * q1 * q1 * q2 * pow2(r * r) + 6.0 * q2 * q2 * r * r * r)
+        };
+    }
+
+    /// The sum of two functions
+    inline Scaled sum(const Scaled& a, const Scaled& b) {
+        return { a[0] + b[0], a[1] + b[1], a[2] + b[2], a[3] + b[3], a[4] + b[4] };
+    }
+
+    /**
+    The scaled derivatives \f$x^k (\exp(\phi))^{(k)}/\exp(\phi)\f$, from the complete Bell polynomials in the scaled derivatives of \f$\phi\f$
+    */
+    inline Scaled exp_factors(const Scaled& a) {
+        return {
+            1.0,
+            a[1],
+            a[1] * a[1] + a[2],
+            a[1] * a[1] * a[1] + 3.0 * a[1] * a[2] + a[3],
+            pow2(a[1] * a[1]) + 6.0 * a[1] * a[1] * a[2] + 4.0 * a[1] * a[3] + 3.0 * a[2] * a[2] + a[4]
+        };
+    }
+
+    /**
+    Add the contribution of one separable term \f$n\tau^t\delta^d\exp(g(\tau)+h(\delta))\f$ to the derivatives
+    \param order The highest order i+j of the derivatives that are added
+    \param g The function of tau and its scaled derivatives
+    \param h The function of delta and its scaled derivatives
+    */
+    inline void add_separable(TauDeltaDerivs& o, int order, double n, double t, double d, double lntau, double delta, double lndelta, const Scaled& g, const Scaled& h) {
+        // The scaled derivatives of t*ln(tau) are t*(-1)^(k-1)*(k-1)!, and similarly for delta
+        const double logfactors[5] = { 0.0, 1.0, -1.0, 2.0, -6.0 };
+        Scaled gt, hd;
+        for (auto k = 1; k < 5; ++k) {
+            gt[k] = t * logfactors[k] + g[k];
+            hd[k] = d * logfactors[k] + h[k];
+        }
+        double F = (delta == 0) ? n * exp(t * lntau + g[0] + h[0]) * powi(delta, static_cast<int>(d)) : n * exp(t * lntau + d * lndelta + g[0] + h[0]);
+        auto Bt = exp_factors(gt), Bd = exp_factors(hd);
+        for (auto i = 0; i <= order; ++i) {
+            for (auto j = 0; i + j <= order; ++j) {
+                o(i, j) += F * Bt[i] * Bd[j];
+            }
+        }
+    }
+
+    /// Mixed derivative of order (i,j) of the term, evaluated with autodiff, for the terms that do not separate
+    template<int i, int j, typename Term>
+    double autodiff_element(const Term& term, double tau, double delta) {
+        if constexpr (i + j == 0) {
+            return term.alphar(tau, delta);
+        }
+        else {
+            using adtype = autodiff::HigherOrderDual<i + j, double>;
+            adtype tauad = tau, deltaad = delta;
+            detail::seed_dual_levels<1, i>(tauad);
+            detail::seed_dual_levels<i + 1, i + j>(deltaad);
+            adtype val = term.alphar(tauad, deltaad);
+            return powi(tau, i) * powi(delta, j) * detail::get_dual_component(val, (1U << (i + j)) - 1U);
+        }
+    }
+
+    /// Fill in the derivatives with \f$i+j\leq\f$ order with autodiff, starting from element (i,j)
+    template<int i = 0, int j = 0, typename Term>
+    void fill_autodiff(TauDeltaDerivs& o, const Term& term, double tau, double delta, int order) {
+        o(i, j) = autodiff_element<i, j>(term, tau, delta);
+        if constexpr (i + j < 4) {
+            if (i + j < order) {
+                fill_autodiff<i, j + 1>(o, term, tau, delta, order);
+                return;
+            }
+        }
+        if constexpr (i < 4) {
+            if (i < order) {
+                fill_autodiff<i + 1, 0>(o, term, tau, delta, order);
+            }
+        }
+    }
+}
+
 /**
 \f$ \alpha^{\rm r}=\displaystyle\sum_i n_i \delta^{d_i} \tau^{t_i}\f$
 */
@@ -29,6 +158,39 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The tau-only part of each term at fixed tau, to be passed to alphar_taufactors
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return n * (t * log(tau)).exp();
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        DeltaType r = 0.0;
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(d[i] * lndelta);
+            }
+        }
+        return forceeval(r);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double lntau = log(tau), lndelta = (delta == 0) ? 0.0 : log(delta);
+        for (auto i = 0; i < n.size(); ++i) {
+            taudelta::add_separable(o, order, n[i], t[i], d[i], lntau, delta, lndelta, taudelta::Scaled{}, taudelta::Scaled{});
+        }
+        return o;
+    }
 };
 
 /**
@@ -59,6 +221,45 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The tau-only part of each term at fixed tau, to be passed to alphar_taufactors
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return n * (t * log(tau)).exp();
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        DeltaType r = 0.0;
+        if (l_i.size() == 0 && n.size() > 0) {
+            throw std::invalid_argument("l_i cannot be zero length if some terms are provided");
+        }
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(-c[i] * powi(delta, l_i[i])) * powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(d[i] * lndelta - c[i] * powi(delta, l_i[i]));
+            }
+        }
+        return forceeval(r);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        if (l_i.size() == 0 && n.size() > 0) {
+            throw std::invalid_argument("l_i cannot be zero length if some terms are provided");
+        }
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double lntau = log(tau), lndelta = (delta == 0) ? 0.0 : log(delta);
+        for (auto i = 0; i < n.size(); ++i) {
+            taudelta::add_separable(o, order, n[i], t[i], d[i], lntau, delta, lndelta, taudelta::Scaled{}, taudelta::power(delta, -c[i], l_i[i]));
+        }
+        return o;
+    }
 };
 
 /**
@@ -86,6 +287,42 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The tau-only part of each term at fixed tau, to be passed to alphar_taufactors
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return n * (t * log(tau)).exp();
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        DeltaType r = 0.0;
+        if (l_i.size() == 0 && n.size() > 0) {
+            throw std::invalid_argument("l_i cannot be zero length if some terms are provided");
+        }
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(-g[i] * powi(delta, l_i[i])) * powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(d[i] * lndelta - g[i] * powi(delta, l_i[i]));
+            }
+        }
+        return forceeval(r);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double lntau = log(tau), lndelta = (delta == 0) ? 0.0 : log(delta);
+        for (auto i = 0; i < n.size(); ++i) {
+            taudelta::add_separable(o, order, n[i], t[i], d[i], lntau, delta, lndelta, taudelta::Scaled{}, taudelta::power(delta, -g[i], l_i[i]));
+        }
+        return o;
+    }
 };
 
 /**
@@ -116,6 +353,45 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The tau-only part of each term at fixed tau, to be passed to alphar_taufactors
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return n * (t * log(tau) - gt * pow(tau, lt)).exp();
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        DeltaType r = 0.0;
+        if (ld_i.size() == 0 && n.size() > 0) {
+            throw std::invalid_argument("ld_i cannot be zero length if some terms are provided");
+        }
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * powi(delta, static_cast<int>(d[i])) * exp(-gd[i] * powi(delta, ld_i[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(d[i] * lndelta - gd[i] * powi(delta, ld_i[i]));
+            }
+        }
+        return forceeval(r);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        if (ld_i.size() == 0 && n.size() > 0) {
+            throw std::invalid_argument("ld_i cannot be zero length if some terms are provided");
+        }
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double lntau = log(tau), lndelta = (delta == 0) ? 0.0 : log(delta);
+        for (auto i = 0; i < n.size(); ++i) {
+            taudelta::add_separable(o, order, n[i], t[i], d[i], lntau, delta, lndelta, taudelta::power(tau, -gt[i], lt[i]), taudelta::power(delta, -gd[i], ld_i[i]));
+        }
+        return o;
+    }
 };
 
 /**
@@ -143,6 +419,40 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The tau-only part of each term at fixed tau, to be passed to alphar_taufactors
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return n * (t * log(tau) - beta * (tau - gamma).square()).exp();
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        DeltaType r = 0.0;
+        auto square = [](auto x) { return x * x; };
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(-eta[i] * square(delta - epsilon[i])) * powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(d[i] * lndelta - eta[i] * square(delta - epsilon[i]));
+            }
+        }
+        return forceeval(r);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double lntau = log(tau), lndelta = (delta == 0) ? 0.0 : log(delta);
+        for (auto i = 0; i < n.size(); ++i) {
+            taudelta::add_separable(o, order, n[i], t[i], d[i], lntau, delta, lndelta, taudelta::quadratic(tau, -beta[i], gamma[i]), taudelta::quadratic(delta, -eta[i], epsilon[i]));
+        }
+        return o;
+    }
 };
 
 /**
@@ -170,6 +480,40 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The tau-only part of each term at fixed tau, to be passed to alphar_taufactors
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return n * (t * log(tau)).exp();
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        DeltaType r = 0.0;
+        auto square = [](auto x) { return x * x; };
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(-eta[i] * square(delta - epsilon[i]) - beta[i] * (delta - gamma[i])) * powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(d[i] * lndelta - eta[i] * square(delta - epsilon[i]) - beta[i] * (delta - gamma[i]));
+            }
+        }
+        return forceeval(r);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double lntau = log(tau), lndelta = (delta == 0) ? 0.0 : log(delta);
+        for (auto i = 0; i < n.size(); ++i) {
+            taudelta::add_separable(o, order, n[i], t[i], d[i], lntau, delta, lndelta, taudelta::Scaled{}, taudelta::sum(taudelta::quadratic(delta, -eta[i], epsilon[i]), taudelta::linear(delta, -beta[i], gamma[i])));
+        }
+        return o;
+    }
 };
 
 
@@ -198,6 +542,39 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The tau-only part of each term at fixed tau, to be passed to alphar_taufactors
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return n * (t * log(tau) - pow(tau, m)).exp();
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        DeltaType r = 0.0;
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(-powi(delta, l_i[i])) * powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(d[i] * lndelta - powi(delta, l_i[i]));
+            }
+        }
+        return forceeval(r);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double lntau = log(tau), lndelta = (delta == 0) ? 0.0 : log(delta);
+        for (auto i = 0; i < n.size(); ++i) {
+            taudelta::add_separable(o, order, n[i], t[i], d[i], lntau, delta, lndelta, taudelta::power(tau, -1.0, m[i]), taudelta::power(delta, -1.0, l_i[i]));
+        }
+        return o;
+    }
 };
 
 /**
@@ -226,6 +603,40 @@ public:
         }
         return forceeval(r);
     }
+
+    /// The tau-only part of each term at fixed tau, to be passed to alphar_taufactors
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return n * (t * log(tau) + 1.0 / (beta * (tau - gamma).square() + b)).exp();
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        DeltaType r = 0.0;
+        auto square = [](auto x) { return x * x; };
+        if (getbaseval(delta) == 0) {
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(-eta[i] * square(delta - epsilon[i])) * powi(delta, static_cast<int>(d[i]));
+            }
+        }
+        else {
+            DeltaType lndelta = log(delta);
+            for (auto i = 0; i < n.size(); ++i) {
+                r = r + A[i] * exp(d[i] * lndelta - eta[i] * square(delta - epsilon[i]));
+            }
+        }
+        return forceeval(r);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double lntau = log(tau), lndelta = (delta == 0) ? 0.0 : log(delta);
+        for (auto i = 0; i < n.size(); ++i) {
+            taudelta::add_separable(o, order, n[i], t[i], d[i], lntau, delta, lndelta, taudelta::reciprocal_quadratic(tau, beta[i], gamma[i], b[i]), taudelta::quadratic(delta, -eta[i], epsilon[i]));
+        }
+        return o;
+    }
 };
 
 /**
@@ -253,15 +664,16 @@ public:
     }
 
     /// Clenshaw evaluation of one dimensional flattening of the Chebyshev expansion
+    /// The work arrays are local (not static) so that the evaluation is re-entrant
     template<typename MatType, typename XType>
     static auto Clenshaw1DByRow(const MatType& c, const XType &ind) {
         int N = static_cast<int>(c.rows()) - 1;
         constexpr int Cols = MatType::ColsAtCompileTime;
         using NumType = std::common_type_t<typename MatType::Scalar, XType>;
-        static Eigen::Array<NumType, 1, Cols> u_k, u_kp1, u_kp2;
-        // Not statically sized, need to resize
+        Eigen::Array<NumType, 1, Cols> u_k, u_kp1, u_kp2;
+        // Not statically sized, need to resize; there is one entry per column
         if constexpr (Cols == Eigen::Dynamic) {
-            int M = static_cast<int>(c.rows());
+            int M = static_cast<int>(c.cols());
             u_k.resize(M); 
             u_kp1.resize(M);
             u_kp2.resize(M);
@@ -276,7 +688,8 @@ public:
                 u_kp2 = u_kp1; u_kp1 = u_k;
             }
         }
-        return (u_k - u_kp2) / 2.0;
+        // Evaluate before returning; the expression would otherwise refer to the local work arrays
+        return ((u_k - u_kp2) / 2.0).eval();
     }
 
     /** Clenshaw evaluation of the complete expansion
@@ -296,6 +709,52 @@ public:
         DeltaType y = (2.0*delta - (deltamax + deltamin)) / (deltamax - deltamin);
         return forceeval(Clenshaw2DEigen(a, forceeval(x), forceeval(y)));
     }
+
+    /// The tau and delta dependence do not factor, so the only tau-only part is tau itself
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return Eigen::ArrayXd::Constant(1, tau);
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        return alphar(A[0], delta);
+    }
+
+    /// Coefficients of the derivative of a Chebyshev expansion with respect to its argument, along the columns (the first argument, tau) of the matrix
+    static Eigen::ArrayXXd diff_cols(const Eigen::ArrayXXd& c) {
+        auto N = c.cols();
+        Eigen::ArrayXXd o = Eigen::ArrayXXd::Zero(c.rows(), N);
+        if (N >= 2) {
+            o.col(N - 2) = 2.0 * (N - 1) * c.col(N - 1);
+            for (auto j = N - 3; j >= 0; --j) {
+                o.col(j) = o.col(j + 2) + 2.0 * (j + 1) * c.col(j + 1);
+            }
+        }
+        return o;
+    }
+
+    /// Coefficients of the derivative of a Chebyshev expansion with respect to its argument, along the rows (the second argument, delta) of the matrix
+    static Eigen::ArrayXXd diff_rows(const Eigen::ArrayXXd& c) {
+        return diff_cols(c.transpose()).transpose();
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs; the expansion is differentiated term-by-term
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        double x = (2.0 * tau - (taumax + taumin)) / (taumax - taumin), dxdtau = 2.0 / (taumax - taumin);
+        double y = (2.0 * delta - (deltamax + deltamin)) / (deltamax - deltamin), dydelta = 2.0 / (deltamax - deltamin);
+        Eigen::ArrayXXd ai = a;
+        for (auto i = 0; i <= order; ++i) {
+            Eigen::ArrayXXd aij = ai;
+            for (auto j = 0; i + j <= order; ++j) {
+                o(i, j) = powi(tau * dxdtau, i) * powi(delta * dydelta, j) * Clenshaw2DEigen(aij, x, y);
+                aij = diff_rows(aij);
+            }
+            ai = diff_cols(ai);
+        }
+        return o;
+    }
 };
 
 /**
@@ -307,6 +766,20 @@ public:
     auto alphar(const TauType& tau, const DeltaType& delta) const {
         return static_cast<std::common_type_t<TauType, DeltaType>>(0.0);
     }
+
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return {};
+    }
+
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        return static_cast<DeltaType>(0.0);
+    }
+
+    /// Closed-form derivatives with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        return TauDeltaDerivs::Zero();
+    }
 };
 
 class NonAnalyticEOSTerm {
@@ -339,11 +812,35 @@ public:
             return static_cast<decltype(outval)>(0.0);
         }
     }
+
+    /// The tau and delta dependence do not factor, so the only tau-only part is tau itself
+    Eigen::ArrayXd get_taufactors(double tau) const {
+        return Eigen::ArrayXd::Constant(1, tau);
+    }
+
+    /// Evaluate the term at fixed tau, given the tau-only parts from get_taufactors
+    template<typename DeltaType>
+    auto alphar_taufactors(const Eigen::ArrayXd& A, const DeltaType& delta) const {
+        return alphar(A[0], delta);
+    }
+
+    /// Derivatives with respect to tau and delta, see TauDeltaDerivs; tau and delta do not separate in this term, so autodiff is used
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        taudelta::fill_autodiff(o, *this, tau, delta, order);
+        return o;
+    }
 };
 
+/**
+ A container of the terms of one EOS, stored as a vector of variants in the order they were added
 
+ The terms are not regrouped by type or packed into a contiguous coefficient arena: each container
+ holds about one instance of each term type, and alphar is bound by the one exp per coefficient, so a
+ type-grouped layout measured no faster on the 21 GERG-2008 components.
+*/
 template<typename... Args>
-class EOSTermContainer {  
+class EOSTermContainer {
 private:
     using varEOSTerms = std::variant<Args...>;
     std::vector<varEOSTerms> coll;
@@ -351,6 +848,9 @@ public:
 
     auto size() const { return coll.size(); }
 
+    /// The terms, in the order they were added
+    const auto& get_terms() const { return coll; }
+
     template<typename Instance>
     auto add_term(Instance&& instance) {
         coll.emplace_back(std::move(instance));
@@ -365,6 +865,36 @@ public:
         }
         return ar;
     }
+
+    /// Closed-form derivatives of the sum of the terms with respect to tau and delta, see TauDeltaDerivs
+    TauDeltaDerivs alphar_taudeltaderivs(double tau, double delta, int order = 4) const {
+        TauDeltaDerivs o = TauDeltaDerivs::Zero();
+        for (const auto& term : coll) {
+            o += std::visit([&](auto& t) { return t.alphar_taudeltaderivs(tau, delta, order); }, term);
+        }
+        return o;
+    }
+
+    /// The tau-only parts of each term at fixed tau, to be passed to alphar_taufactors
+    auto get_taufactors(double tau) const {
+        std::vector<Eigen::ArrayXd> factors;
+        factors.reserve(coll.size());
+        for (const auto& term : coll) {
+            factors.emplace_back(std::visit([&](auto& t) { return t.get_taufactors(tau); }, term));
+        }
+        return factors;
+    }
+
+    /// Evaluate all the terms at fixed tau, given the tau-only parts from get_taufactors; only delta is variable
+    template <class Delta>
+    auto alphar_taufactors(const std::vector<Eigen::ArrayXd>& factors, const Delta& delta) const {
+        Delta ar = 0.0;
+        for (auto i = 0U; i < coll.size(); ++i) {
+            Delta contrib = std::visit([&](auto& t) -> Delta { return t.alphar_taufactors(factors[i], delta); }, coll[i]);
+            ar = ar + contrib;
+        }
+        return ar;
+    }
 };
 
 using EOSTerms = EOSTermContainer<JustPowerEOSTerm, PowerEOSTerm, GaussianEOSTerm, NonAnalyticEOSTerm, Lemmon2005EOSTerm, GaoBEOSTerm, ExponentialEOSTerm>;
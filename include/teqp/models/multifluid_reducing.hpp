@@ -1,35 +1,140 @@
 #pragma once
 
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "nlohmann/json.hpp"
+
 #include "teqp/types.hpp"
 
 namespace teqp {
 
     namespace reducing {
 
-        inline auto get_BIPdep(const nlohmann::json& collection, const std::vector<std::string>& identifiers, const nlohmann::json& flags) {
+        /// Convert a string to upper case, for the case-insensitive matching of the names of the fluids
+        inline std::string upper_case(const std::string& s) { 
+            auto data = s; 
+            std::for_each(data.begin(), data.end(), [](char& c) { c = ::toupper(c); }); 
+            return data; 
+        }
 
-            // If force-estimate is provided in flags, the estimation will over-ride the provided model(s)
-            if (flags.contains("force-estimate")) {
-                std::string scheme = flags["estimate"];
-                if (scheme == "Lorentz-Berthelot") {
-                    return std::make_tuple(nlohmann::json({
-                        {"betaT", 1.0}, {"gammaT", 1.0}, {"betaV", 1.0}, {"gammaV", 1.0}, {"F", 0.0}
-                        }), false);
+        /**
+        * \brief An index of a collection of binary interaction parameters, so that pairs are found by hashing rather than by a linear scan
+        * 
+        * The pairs are indexed by the upper-cased names (Name1, Name2) and by the CAS numbers (CAS1, CAS2), in both orders. 
+        * The matching rules are the same as for the linear search in get_BIPdep: names are matched before CAS numbers,
+        * and if several entries match a pair, the first one in the collection is used. The index holds a copy of the
+        * collection, so it can be built once and reused for any number of model builds.
+        */
+        class BinaryPairIndex {
+        private:
+            nlohmann::json collection;
+            using Match = std::pair<std::size_t, bool>; ///< The index of the entry and whether the order of the components is swapped
+            std::unordered_map<std::string, Match> by_name, by_CAS;
+            static std::string key(const std::string& a, const std::string& b) { return a + '\0' + b; }
+            static void add(std::unordered_map<std::string, Match>& map, const std::string& a, const std::string& b, std::size_t i) {
+                // Only the first entry for a pair is kept, as the linear search would find it first
+                map.try_emplace(key(a, b), i, false);
+                map.try_emplace(key(b, a), i, true);
+            }
+        public:
+            explicit BinaryPairIndex(const nlohmann::json& collection) : collection(collection) {
+                if (collection.is_null()) { return; }
+                for (auto i = 0U; i < collection.size(); ++i) {
+                    const auto& el = collection[i];
+                    add(by_name, upper_case(el.at("Name1")), upper_case(el.at("Name2")), i);
+                    if (el.contains("CAS1") && el.contains("CAS2")) {
+                        add(by_CAS, el.at("CAS1"), el.at("CAS2"), i);
+                    }
                 }
-                else {
-                    throw std::invalid_argument("estimation scheme is not understood:" + scheme);
+            }
+            /// The collection that was indexed
+            const nlohmann::json& get_collection() const { return collection; }
+
+            /// The entry for the pair, and whether the order of the components in the entry is swapped, if the pair is in the collection
+            std::optional<std::tuple<const nlohmann::json&, bool>> find(const std::string& identifier0, const std::string& identifier1) const {
+                auto it = by_name.find(key(upper_case(identifier0), upper_case(identifier1)));
+                if (it == by_name.end()) {
+                    it = by_CAS.find(key(identifier0, identifier1));
+                    if (it == by_CAS.end()) {
+                        return std::nullopt;
+                    }
+                }
+                return std::tuple<const nlohmann::json&, bool>(collection[it->second.first], it->second.second);
+            }
+        };
+
+        /// An index of a collection of departure functions by their names; if several have the same name, the first one is used
+        class DepartureFunctionIndex {
+        private:
+            nlohmann::json collection;
+            std::unordered_map<std::string, std::size_t> by_name;
+        public:
+            explicit DepartureFunctionIndex(const nlohmann::json& collection) : collection(collection) {
+                if (collection.is_null()) { return; }
+                for (auto i = 0U; i < collection.size(); ++i) {
+                    by_name.try_emplace(collection[i].at("Name"), i);
+                }
+            }
+            /// The collection that was indexed
+            const nlohmann::json& get_collection() const { return collection; }
+
+            /// The departure function with this name
+            const nlohmann::json& get(const std::string& name) const {
+                auto it = by_name.find(name);
+                if (it == by_name.end()) {
+                    throw std::invalid_argument("Bad departure function name: " + name);
                 }
+                return collection[it->second];
+            }
+        };
+
+        /// The parameters estimated with the scheme given by the "estimate" flag
+        inline auto get_estimated_BIP(const nlohmann::json& flags) {
+            std::string scheme = flags["estimate"];
+            if (scheme == "Lorentz-Berthelot") {
+                return std::make_tuple(nlohmann::json({
+                    {"betaT", 1.0}, {"gammaT", 1.0}, {"betaV", 1.0}, {"gammaV", 1.0}, {"F", 0.0}
+                    }), false);
+            }
+            else {
+                throw std::invalid_argument("estimation scheme is not understood:" + scheme);
             }
+        }
 
-            // convert string to upper case
-            auto toupper = [](const std::string s) { auto data = s; std::for_each(data.begin(), data.end(), [](char& c) { c = ::toupper(c); }); return data; };
+        /// The entry of the indexed collection for the pair; this gives the same result as the overload taking the collection itself
+        inline auto get_BIPdep(const BinaryPairIndex& index, const std::vector<std::string>& identifiers, const nlohmann::json& flags) {
+            // If force-estimate is provided in flags, the estimation will over-ride the provided model(s)
+            if (flags.contains("force-estimate")) {
+                return get_estimated_BIP(flags);
+            }
+            if (auto match = index.find(identifiers[0], identifiers[1])) {
+                auto [el, swap_needed] = match.value();
+                return std::make_tuple(nlohmann::json(el), swap_needed);
+            }
+            // If estimate is provided in flags, it will be the fallback solution for filling in interaction parameters
+            if (flags.contains("estimate")) {
+                return get_estimated_BIP(flags);
+            }
+            throw std::invalid_argument("Can't match the binary pair for: " + identifiers[0] + "/" + identifiers[1]);
+        }
+
+        inline auto get_BIPdep(const nlohmann::json& collection, const std::vector<std::string>& identifiers, const nlohmann::json& flags) {
+
+            // If force-estimate is provided in flags, the estimation will over-ride the provided model(s)
+            if (flags.contains("force-estimate")) {
+                return get_estimated_BIP(flags);
+            }
 
             // First pass, check names
-            std::string comp0 = toupper(identifiers[0]);
-            std::string comp1 = toupper(identifiers[1]);
+            std::string comp0 = upper_case(identifiers[0]);
+            std::string comp1 = upper_case(identifiers[1]);
             for (auto& el : collection) {
-                std::string name1 = toupper(el["Name1"]);
-                std::string name2 = toupper(el["Name2"]);
+                std::string name1 = upper_case(el["Name1"]);
+                std::string name2 = upper_case(el["Name2"]);
                 if (comp0 == name1 && comp1 == name2) {
                     return std::make_tuple(el, false);
                 }
@@ -51,23 +156,16 @@ namespace teqp {
 
             // If estimate is provided in flags, it will be the fallback solution for filling in interaction parameters
             if (flags.contains("estimate")) {
-                std::string scheme = flags["estimate"];
-                if (scheme == "Lorentz-Berthelot") {
-                    return std::make_tuple(nlohmann::json({
-                        {"betaT", 1.0}, {"gammaT", 1.0}, {"betaV", 1.0}, {"gammaV", 1.0}, {"F", 0.0}
-                        }), false);
-                }
-                else {
-                    throw std::invalid_argument("estimation scheme is not understood:" + scheme);
-                }
+                return get_estimated_BIP(flags);
             }
             else {
                 throw std::invalid_argument("Can't match the binary pair for: " + identifiers[0] + "/" + identifiers[1]);
             }
         }
 
-        /// Get the binary interaction parameters for a given binary pair
-        inline auto get_binary_interaction_double(const nlohmann::json& collection, const std::vector<std::string>& identifiers, const nlohmann::json& flags, const std::vector<double>& Tc, const std::vector<double>& vc) {
+        /// Get the binary interaction parameters for a given binary pair; the collection is either the JSON data or a BinaryPairIndex
+        template<typename Collection>
+        inline auto get_binary_interaction_double(const Collection& collection, const std::vector<std::string>& identifiers, const nlohmann::json& flags, const std::vector<double>& Tc, const std::vector<double>& vc) {
             auto [el, swap_needed] = get_BIPdep(collection, identifiers, flags);
 
             double betaT, gammaT, betaV, gammaV;
@@ -93,8 +191,8 @@ namespace teqp {
         }
 
         /// Build the matrices of betaT, gammaT, betaV, gammaV for the multi-fluid model
-        template <typename Tcvec, typename vcvec>
-        inline auto get_BIP_matrices(const nlohmann::json& collection, const std::vector<std::string>& components, const nlohmann::json& flags, const Tcvec& Tc, const vcvec& vc) {
+        template <typename Collection, typename Tcvec, typename vcvec>
+        inline auto get_BIP_matrices(const Collection& collection, const std::vector<std::string>& components, const nlohmann::json& flags, const Tcvec& Tc, const vcvec& vc) {
             Eigen::MatrixXd betaT, gammaT, betaV, gammaV, YT, Yv;
             auto N = components.size();
             betaT.resize(N, N); betaT.setZero();
@@ -132,7 +230,8 @@ namespace teqp {
         }
 
         /// Get the matrix F of Fij factors multiplying the departure functions
-        inline auto get_F_matrix(const nlohmann::json& collection, const std::vector<std::string>& identifiers, const nlohmann::json& flags) {
+        template<typename Collection>
+        inline auto get_F_matrix(const Collection& collection, const std::vector<std::string>& identifiers, const nlohmann::json& flags) {
             auto N = identifiers.size();
             Eigen::MatrixXd F(N, N);
             for (auto i = 0; i < N; ++i) {
@@ -254,6 +353,7 @@ namespace teqp {
     class ReducingTermContainer {
     private:
         const std::variant<Args...> term;
+        friend struct ModelSerializer; // For binary serialization, see teqp/serialization.hpp
         auto get_Tc() const { return std::visit([](const auto& t) { return std::cref(t.Tc); }, term); }
         auto get_vc() const { return std::visit([](const auto& t) { return std::cref(t.vc); }, term); }
     public:
@@ -1,11 +1,18 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+
 #include "nlohmann/json.hpp"
 #include "teqp/types.hpp"
+#include "teqp/arena.hpp"
 #include "teqp/exceptions.hpp"
 #include "teqp/constants.hpp"
 
 namespace teqp {
+
+struct ModelSerializer;
+
 namespace PCSAFT {
 
 /// Coefficients for one fluid
@@ -62,22 +69,36 @@ auto C2(const Eta& eta, Mbar mbar) {
         + (1.0 - mbar) * (2.0 * eta * eta * eta + 12.0 * eta * eta - 48.0 * eta + 40.0) / pow((1.0 - eta) * (2.0 - eta), 3)
         ));
 }
+/// The universal model constants of Eqns. A.18 and A.19 (Table 1 of Gross and Sadowski, IECR, 2001)
+namespace universal_constants {
+    inline constexpr std::array<double, 7> a_0 = { 0.9105631445, 0.6361281449, 2.6861347891, -26.547362491, 97.759208784, -159.59154087, 91.297774084 };
+    inline constexpr std::array<double, 7> a_1 = { -0.3084016918, 0.1860531159, -2.5030047259, 21.419793629, -65.255885330, 83.318680481, -33.746922930 };
+    inline constexpr std::array<double, 7> a_2 = { -0.0906148351, 0.4527842806, 0.5962700728, -1.7241829131, -4.1302112531, 13.776631870, -8.6728470368 };
+    inline constexpr std::array<double, 7> b_0 = { 0.7240946941, 2.2382791861, -4.0025849485, -21.003576815, 26.855641363, 206.55133841, -355.60235612 };
+    inline constexpr std::array<double, 7> b_1 = { -0.5755498075, 0.6995095521, 3.8925673390, -17.215471648, 192.67226447, -161.82646165, -165.20769346 };
+    inline constexpr std::array<double, 7> b_2 = { 0.0976883116, -0.2557574982, -9.1558561530, 20.642075974, -38.804430052, 93.626774077, -29.666905585 };
+}
+/// The coefficients of Eqns. A.18 and A.19, given the three sets of universal constants
+template<typename TYPE>
+auto get_universal_coeffs(TYPE mbar, const std::array<double, 7>& c_0, const std::array<double, 7>& c_1, const std::array<double, 7>& c_2) {
+    const TYPE f1 = (mbar - 1.0) / mbar, f2 = (mbar - 1.0) / mbar * (mbar - 2.0) / mbar;
+    Eigen::Array<TYPE, 7, 1> o;
+    for (std::size_t i = 0; i < 7; ++i) {
+        o[i] = c_0[i] + f1 * c_1[i] + f2 * c_2[i];
+    }
+    return o;
+}
 /// Eqn. A.18
 template<typename TYPE>
 auto get_a(TYPE mbar) {
-    static Eigen::ArrayXd a_0 = (Eigen::ArrayXd(7) << 0.9105631445, 0.6361281449, 2.6861347891, -26.547362491, 97.759208784, -159.59154087, 91.297774084).finished();
-    static Eigen::ArrayXd a_1 = (Eigen::ArrayXd(7) << -0.3084016918, 0.1860531159, -2.5030047259, 21.419793629, -65.255885330, 83.318680481, -33.746922930).finished();
-    static Eigen::ArrayXd a_2 = (Eigen::ArrayXd(7) << -0.0906148351, 0.4527842806, 0.5962700728, -1.7241829131, -4.1302112531, 13.776631870, -8.6728470368).finished();
-    return forceeval(a_0.cast<TYPE>() + ((mbar - 1.0) / mbar) * a_1.cast<TYPE>() + ((mbar - 1.0) / mbar * (mbar - 2.0) / mbar) * a_2.cast<TYPE>()).eval();
+    using namespace universal_constants;
+    return get_universal_coeffs(mbar, a_0, a_1, a_2);
 }
 /// Eqn. A.19
 template<typename TYPE>
 auto get_b(TYPE mbar) {
-    // See https://stackoverflow.com/a/35170514/1360263
-    static Eigen::ArrayXd b_0 = (Eigen::ArrayXd(7) << 0.7240946941, 2.2382791861, -4.0025849485, -21.003576815, 26.855641363, 206.55133841, -355.60235612).finished();
-    static Eigen::ArrayXd b_1 = (Eigen::ArrayXd(7) << -0.5755498075, 0.6995095521, 3.8925673390, -17.215471648, 192.67226447, -161.82646165, -165.20769346).finished();
-    static Eigen::ArrayXd b_2 = (Eigen::ArrayXd(7) << 0.0976883116, -0.2557574982, -9.1558561530, 20.642075974, -38.804430052, 93.626774077, -29.666905585).finished();
-    return forceeval(b_0.cast<TYPE>() + (mbar - 1.0) / mbar * b_1.cast<TYPE>() + (mbar - 1.0) / mbar * (mbar - 2.0) / mbar * b_2.cast<TYPE>()).eval();
+    using namespace universal_constants;
+    return get_universal_coeffs(mbar, b_0, b_1, b_2);
 }
 /// Residual contribution to alphar from hard-sphere (Eqn. A.6)
 template<typename VecType>
@@ -114,29 +135,26 @@ auto gij_HS(const zVecType& zeta, const dVecType& d,
     return forceeval(1.0 / (Upsilon)+d[i] * d[j] / (d[i] + d[j]) * 3.0 * zeta[2] / pow(Upsilon, 2)
         + pow(d[i] * d[j] / (d[i] + d[j]), 2) * 2.0 * pow(zeta[2], 2) / pow(Upsilon, 3));
 }
+/// The sums of Eqns. A.16 and A.29 (or A.17 and A.30), given the coefficients from get_a (or get_b)
+template <typename Eta, typename CoeffType>
+auto get_I_sums(const Eta& eta, const CoeffType& coeffs) {
+    Eta summer_I = 0.0 * eta, summer_etadIdeta = 0.0 * eta;
+    for (std::size_t i = 0; i < 7; ++i) {
+        auto increment = coeffs(i) * pow(eta, static_cast<int>(i));
+        summer_I = summer_I + increment;
+        summer_etadIdeta = summer_etadIdeta + increment * (i + 1.0);
+    }
+    return std::make_tuple(forceeval(summer_I), forceeval(summer_etadIdeta));
+}
 /// Eqn. A.16, Eqn. A.29
 template <typename Eta, typename MbarType>
 auto get_I1(const Eta& eta, MbarType mbar) {
-    auto avec = get_a(mbar);
-    Eta summer_I1 = 0.0, summer_etadI1deta = 0.0;
-    for (std::size_t i = 0; i < 7; ++i) {
-        auto increment = avec(i) * pow(eta, static_cast<int>(i));
-        summer_I1 = summer_I1 + increment;
-        summer_etadI1deta = summer_etadI1deta + increment * (i + 1.0);
-    }
-    return std::make_tuple(forceeval(summer_I1), forceeval(summer_etadI1deta));
+    return get_I_sums(eta, get_a(mbar));
 }
 /// Eqn. A.17, Eqn. A.30
 template <typename Eta, typename MbarType>
 auto get_I2(const Eta& eta, MbarType mbar) {
-    auto bvec = get_b(mbar);
-    Eta summer_I2 = 0.0 * eta, summer_etadI2deta = 0.0 * eta;
-    for (std::size_t i = 0; i < 7; ++i) {
-        auto increment = bvec(i) * pow(eta, static_cast<int>(i));
-        summer_I2 = summer_I2 + increment;
-        summer_etadI2deta = summer_etadI2deta + increment * (i + 1.0);
-    }
-    return std::make_tuple(forceeval(summer_I2), forceeval(summer_etadI2deta));
+    return get_I_sums(eta, get_b(mbar));
 }
 
 /**
@@ -160,18 +178,24 @@ auto sumproduct(const VecType1& v1, const VecType2& v2, const VecType3& v3) {
     return forceeval((v1.template cast<ResultType>() * v2.template cast<ResultType>() * v3.template cast<ResultType>()).sum());
 }
 
-/// Parameters for model evaluation
-template<typename NumType, typename ProductType>
+/// Parameters for model evaluation; these are all independent of density
+template<typename NumType, typename ProductType, typename DType = Eigen::Map<Eigen::ArrayX<NumType>>>
 class SAFTCalc {
 public:
-    // Just temperature dependent things
-    Eigen::ArrayX<NumType> d;
+    // Just temperature dependent things; by default the storage is owned by the caller
+    DType d;
 
     // These things also have composition dependence
     ProductType m2_epsilon_sigma3_bar, ///< Eq. A. 12
-                m2_epsilon2_sigma3_bar; ///< Eq. A. 13
+                m2_epsilon2_sigma3_bar, ///< Eq. A. 13
+                mbar; ///< Eq. A. 5
+    std::array<ProductType, 4> xmdn; ///< sum_i x_i m_i d_i^n for n = 0..3, zeta_n of Eq. A. 8 without the density
+    Eigen::Array<ProductType, 7, 1> a, ///< Eq. A. 18
+                                    b; ///< Eq. A. 19
 };
 
+class PCSAFTBoundState;
+
 /// A class used to evaluate mixtures using PC-SAFT model
 class PCSAFTMixture {
 private:
@@ -181,6 +205,10 @@ private:
         epsilon_over_k; ///< depth of pair potential divided by Boltzman constant
     std::vector<std::string> names;
     Eigen::ArrayXXd kmat; ///< binary interaction parameter matrix
+    Eigen::ArrayXXd m2_epsilon_sigma3_ij, ///< m_i*m_j*(eps_ij/k)*sigma_ij^3 of Eq. A.12, (j,i) folded into (i,j) for j > i
+        m2_epsilon2_sigma3_ij; ///< m_i*m_j*(eps_ij/k)^2*sigma_ij^3 of Eq. A.13, (j,i) folded into (i,j) for j > i
+    friend struct teqp::ModelSerializer; // For binary serialization, see teqp/serialization.hpp
+    friend class PCSAFTBoundState;
 
     void check_kmat(std::size_t N) {
         if (kmat.cols() != kmat.rows()) {
@@ -193,6 +221,87 @@ private:
             throw teqp::InvalidArgument("kmat needs to be a square matrix the same size as the number of components");
         }
     };
+
+    /// The pair parameters of the double sums in Eqs. A.12 and A.13 only depend on the coefficients, so they are tabulated once
+    void build_pair_tables() {
+        auto N = m.size();
+        m2_epsilon_sigma3_ij.setZero(N, N);
+        m2_epsilon2_sigma3_ij.setZero(N, N);
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = 0; j < N; ++j) {
+                // Eq. A.5
+                auto sigma_ij = 0.5 * sigma_Angstrom[i] + 0.5 * sigma_Angstrom[j];
+                auto eij_over_k = sqrt(epsilon_over_k[i] * epsilon_over_k[j]) * (1.0 - kmat(i, j));
+                // The sums only run over j >= i, so kmat need not be symmetric
+                auto [ii, jj] = std::minmax(i, j);
+                m2_epsilon_sigma3_ij(ii, jj) += m[i] * m[j] * eij_over_k * pow(sigma_ij, 3);
+                m2_epsilon2_sigma3_ij(ii, jj) += m[i] * m[j] * pow(eij_over_k, 2) * pow(sigma_ij, 3);
+            }
+        }
+    }
+
+    /// Fill in the parts of the calculation that do not depend on density; c.d must already have one entry per component
+    template<typename Calc, typename TTYPE, typename VecType>
+    void calc_temperature_parts(Calc& c, const TTYPE& T, const VecType& mole_fractions) const {
+        using ProductType = std::decay_t<decltype(c.mbar)>;
+        const auto N = m.size();
+        for (auto i = 0; i < N; ++i) {
+            c.d[i] = sigma_Angstrom[i]*(1.0 - 0.12 * exp(-3.0*epsilon_over_k[i]/T)); // [A]
+        }
+        // Eq. A.12 and A.13; the temperature is taken out of the double sums
+        std::decay_t<decltype(mole_fractions[0])> sum_es3 = 0.0, sum_e2s3 = 0.0;
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = i; j < N; ++j) {
+                auto xixj = mole_fractions[i] * mole_fractions[j];
+                sum_es3 = sum_es3 + xixj * m2_epsilon_sigma3_ij(i, j);
+                sum_e2s3 = sum_e2s3 + xixj * m2_epsilon2_sigma3_ij(i, j);
+            }
+        }
+        c.m2_epsilon_sigma3_bar = forceeval(sum_es3 / T);
+        c.m2_epsilon2_sigma3_bar = forceeval(sum_e2s3 / (T * T));
+        c.mbar = (mole_fractions.template cast<ProductType>()*m.template cast<ProductType>()).sum();
+        for (std::size_t n = 0; n < 4; ++n) {
+            // Eqn A.8
+            auto dn = c.d.pow(n);
+            c.xmdn[n] = forceeval((mole_fractions.template cast<ProductType>()*m.template cast<ProductType>()*dn.template cast<ProductType>()).sum());
+        }
+        c.a = get_a(c.mbar);
+        c.b = get_b(c.mbar);
+    }
+
+    /// alphar, given the parts of the calculation that do not depend on density
+    template<typename Calc, typename RhoType, typename VecType>
+    auto alphar_from_calc(const Calc& c, const RhoType& rhomolar, const VecType& mole_fractions) const {
+
+        /// Convert from molar density to number density in molecules/Angstrom^3
+        RhoType rho_A3 = rhomolar * N_A * 1e-30; //[molecules (not moles)/A^3]
+
+        constexpr double MY_PI = EIGEN_PI;
+        double pi6 = (MY_PI / 6.0);
+
+        /// Evaluate the components of zeta
+        using ta = std::common_type_t<decltype(pi6), decltype(m[0]), std::decay_t<decltype(c.d[0])>, decltype(c.mbar), decltype(rho_A3)>;
+        std::array<ta, 4> zeta;
+        for (std::size_t n = 0; n < 4; ++n) {
+            // Eqn A.8
+            zeta[n] = forceeval(pi6*rho_A3*c.xmdn[n]);
+        }
+
+        /// Packing fraction is the 4-th value in zeta, at index 3
+        const auto &eta = zeta[3];
+        
+        auto [I1, etadI1deta] = get_I_sums(eta, c.a);
+        auto [I2, etadI2deta] = get_I_sums(eta, c.b);
+
+        using tt = std::common_type_t<ta, std::decay_t<decltype(mole_fractions[0])>>;
+        tt sum_lngii_hs = 0.0;
+        for (auto i = 0; i < mole_fractions.size(); ++i) {
+            sum_lngii_hs = sum_lngii_hs + mole_fractions[i] * mminus1[i] * log(gij_HS(zeta, c.d, i, i));
+        }
+        auto alphar_hc = c.mbar * get_alphar_hs(zeta) - sum_lngii_hs; // Eq. A.4
+        auto alphar_disp = -2 * MY_PI * rho_A3 * I1 * c.m2_epsilon_sigma3_bar - MY_PI * rho_A3 * c.mbar * C1(eta, c.mbar) * I2 * c.m2_epsilon2_sigma3_bar;
+        return forceeval(alphar_hc + alphar_disp);
+    }
 public:
     PCSAFTMixture(const std::vector<std::string> &names, const Eigen::ArrayXXd& kmat = {}) : names(names), kmat(kmat)
     {
@@ -211,6 +320,7 @@ public:
             epsilon_over_k[i] = coeff.epsilon_over_k;
             i++;
         }
+        build_pair_tables();
     };
     PCSAFTMixture(const std::vector<SAFTCoeffs> &coeffs, const Eigen::ArrayXXd &kmat = {}) : kmat(kmat)
     {
@@ -230,6 +340,7 @@ public:
             names[i] = coeff.name;
             i++;
         }
+        build_pair_tables();
     };
     auto get_m(){ return m; }
     auto get_sigma_Angstrom() { return sigma_Angstrom; }
@@ -265,57 +376,94 @@ public:
             throw std::invalid_argument("Length of mole_fractions (" + std::to_string(mole_fractions.size()) + ") is not the length of components (" + std::to_string(N) + ")");
         }
 
-        using TRHOType = std::common_type_t<std::decay_t<TTYPE>, std::decay_t<RhoType>, std::decay_t<decltype(mole_fractions[0])>, std::decay_t<decltype(m[0])>>;
+        using TXType = std::common_type_t<std::decay_t<TTYPE>, std::decay_t<decltype(mole_fractions[0])>, std::decay_t<decltype(m[0])>>;
 
-        SAFTCalc<TTYPE, TRHOType> c;
-        c.m2_epsilon_sigma3_bar = static_cast<TRHOType>(0.0);
-        c.m2_epsilon2_sigma3_bar = static_cast<TRHOType>(0.0);
-        c.d.resize(N); 
-        for (std::size_t i = 0; i < N; ++i) {
-            c.d[i] = sigma_Angstrom[i]*(1.0 - 0.12 * exp(-3.0*epsilon_over_k[i]/T)); // [A]
-            for (std::size_t j = 0; j < N; ++j) {
-                // Eq. A.5
-                auto sigma_ij = 0.5 * sigma_Angstrom[i] + 0.5 * sigma_Angstrom[j];
-                auto eij_over_k = sqrt(epsilon_over_k[i] * epsilon_over_k[j]) * (1.0 - kmat(i,j));
-                c.m2_epsilon_sigma3_bar = c.m2_epsilon_sigma3_bar + mole_fractions[i] * mole_fractions[j] * m[i] * m[j] * eij_over_k / T * pow(sigma_ij, 3);
-                c.m2_epsilon2_sigma3_bar = c.m2_epsilon2_sigma3_bar + mole_fractions[i] * mole_fractions[j] * m[i] * m[j] * pow(eij_over_k / T, 2) * pow(sigma_ij, 3);
-            }
-        }
-        auto mbar = (mole_fractions.template cast<TRHOType>()*m.template cast<TRHOType>()).sum();
+        // The segment diameters of this evaluation are taken from the arena of the thread, and given back on return
+        ArenaScope scratch;
 
-        /// Convert from molar density to number density in molecules/Angstrom^3
-        RhoType rho_A3 = rhomolar * N_A * 1e-30; //[molecules (not moles)/A^3]
+        SAFTCalc<TTYPE, TXType> c{ scratch.array<TTYPE>(N) };
+        calc_temperature_parts(c, T, mole_fractions);
+        return alphar_from_calc(c, rhomolar, mole_fractions);
+    }
 
-        constexpr double MY_PI = EIGEN_PI;
-        double pi6 = (MY_PI / 6.0);
+    /**
+    * \brief Bind the model to a fixed temperature and composition
+    *
+    * The segment diameters and all the other parts of alphar that do not depend on density are calculated once, and 
+    * the returned object can be evaluated for many densities at only the cost of the density-dependent parts.
+    * See PCSAFTBoundState for the limitations
+    */
+    template<typename MoleFracType>
+    auto bind(const double T, const MoleFracType& molefrac) const;
+};
 
-        /// Evaluate the components of zeta
-        using ta = std::common_type_t<decltype(pi6), decltype(m[0]), decltype(c.d[0]), decltype(rho_A3)>;
-        std::vector<ta> zeta(4);
-        for (std::size_t n = 0; n < 4; ++n) {
-            // Eqn A.8
-            auto dn = c.d.pow(n).eval();
-            TRHOType xmdn = forceeval((mole_fractions.template cast<TRHOType>()*m.template cast<TRHOType>()*dn.template cast<TRHOType>()).sum());
-            zeta[n] = forceeval(pi6*rho_A3*xmdn);
+/**
+* \brief A PCSAFTMixture bound to a fixed temperature and composition
+*
+* As for MultiFluidBoundState, the bound state holds a reference to the model, so the model must outlive it, and the 
+* alphar(T, rho, molefrac) method is provided so that the bound state can be used in place of the model in density-only 
+* routines (for instance TDXDerivatives::get_Ar0n). The temperature must be a plain double equal to the bound temperature, 
+* and the mole fractions must be the bound ones; otherwise an exception is thrown.
+*/
+class PCSAFTBoundState {
+private:
+    const PCSAFTMixture& model;
+public:
+    const double T;
+    const Eigen::ArrayXd molefrac;
+private:
+    SAFTCalc<double, double, Eigen::ArrayXd> c;
+    /// Throw if the mole fractions are not the bound ones (to within 1e-12), because the bound ones are always used
+    template<typename MoleFracType>
+    void check_composition(const MoleFracType& molefrac_) const {
+        static_assert(std::is_arithmetic_v<std::decay_t<decltype(molefrac_[0])>>, "Derivatives with respect to composition are not possible with a bound state");
+        if (static_cast<Eigen::Index>(molefrac_.size()) != molefrac.size()) {
+            throw teqp::InvalidArgument("Length of mole_fractions (" + std::to_string(molefrac_.size()) + ") is not the number of bound mole fractions (" + std::to_string(molefrac.size()) + ")");
         }
+        for (auto i = 0; i < molefrac.size(); ++i) {
+            if (std::abs(molefrac_[i] - molefrac[i]) > 1e-12) {
+                throw teqp::InvalidArgument("The mole fractions are not the bound ones");
+            }
+        }
+    }
+public:
+    template<typename MoleFracType>
+    PCSAFTBoundState(const PCSAFTMixture& model, const double T, const MoleFracType& molefrac) : model(model), T(T), molefrac(molefrac) {
+        if (this->molefrac.size() != model.m.size()) {
+            throw teqp::InvalidArgument("Length of mole_fractions (" + std::to_string(this->molefrac.size()) + ") is not the length of components (" + std::to_string(model.m.size()) + ")");
+        }
+        c.d.resize(this->molefrac.size());
+        model.calc_temperature_parts(c, T, this->molefrac);
+    };
 
-        /// Packing fraction is the 4-th value in zeta, at index 3
-        const auto &eta = zeta[3];
-        
-        auto [I1, etadI1deta] = get_I1(eta, mbar);
-        auto [I2, etadI2deta] = get_I2(eta, mbar);
+    template<class VecType>
+    auto R(const VecType& molefrac) const {
+        return model.R(molefrac);
+    }
 
-        using tt = std::common_type_t<decltype(zeta[0]), decltype(c.d[0])>;
-        Eigen::ArrayX<tt> lngii_hs(mole_fractions.size());
-        for (auto i = 0; i < lngii_hs.size(); ++i) {
-            lngii_hs[i] = log(gij_HS(zeta, c.d, i, i));
+    /// Evaluate alphar at the bound temperature and composition
+    template<typename RhoType>
+    auto alphar(const RhoType& rho) const {
+        return model.alphar_from_calc(c, rho, molefrac);
+    }
+
+    /// The model-like interface, for use in density-only derivative routines
+    template<typename TType, typename RhoType, typename MoleFracType>
+    auto alphar(const TType& T_, const RhoType& rho, const MoleFracType& molefrac_) const {
+        static_assert(std::is_arithmetic_v<TType>, "Derivatives with respect to temperature are not possible with a bound state");
+        if (T_ != T) {
+            throw teqp::InvalidArgument("Temperature of " + std::to_string(T_) + " K is not the bound temperature of " + std::to_string(T) + " K");
         }
-        auto alphar_hc = mbar * get_alphar_hs(zeta) - sumproduct(mole_fractions, mminus1, lngii_hs); // Eq. A.4
-        auto alphar_disp = -2 * MY_PI * rho_A3 * I1 * c.m2_epsilon_sigma3_bar - MY_PI * rho_A3 * mbar * C1(eta, mbar) * I2 * c.m2_epsilon2_sigma3_bar;
-        return forceeval(alphar_hc + alphar_disp);
+        check_composition(molefrac_);
+        return alphar(rho);
     }
 };
 
+template<typename MoleFracType>
+auto PCSAFTMixture::bind(const double T, const MoleFracType& molefrac) const {
+    return PCSAFTBoundState(*this, T, molefrac);
+}
+
 inline auto PCSAFTfactory(const nlohmann::json& json) {
     std::vector<SAFTCoeffs> coeffs;
     for (auto j : json) {
@@ -14,6 +14,7 @@ To add:
 class vdWEOS1 {
 private:
     double a, b;
+    friend struct ModelSerializer; // For binary serialization, see teqp/serialization.hpp
 public:
     /// Intializer, taking the a and b constants directly
     vdWEOS1(double a, double b) : a(a), b(b) {};
@@ -76,7 +77,7 @@ public:
     template<typename TType, typename CompType>
     auto a(TType T, const CompType& molefracs) const {
         typename CompType::value_type a_ = 0.0;
-        auto ai = this->ai;
+        const auto& ai = this->ai;
         for (auto i = 0; i < molefracs.size(); ++i) {
             for (auto j = 0; j < molefracs.size(); ++j) {
                 auto aij = (1 - k[i][j]) * sqrt(ai[i] * ai[j]);
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace teqp {
+
+    /**
+    * \brief Split the index range [0, N) into contiguous chunks and call f(ibegin, iend) for each chunk, one chunk per thread
+    *
+    * If Nthreads is 0, the number of hardware threads is used. If there is only one chunk, the function is
+    * called on the calling thread and no threads are spawned.  An exception thrown in any of the chunks
+    * is re-thrown on the calling thread after all threads have been joined
+    */
+    template<typename Function>
+    void parallel_for_chunks(const std::size_t N, std::size_t Nthreads, const Function& f) {
+        if (N == 0) { return; }
+        if (Nthreads == 0) {
+            Nthreads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        Nthreads = std::min(Nthreads, N);
+        if (Nthreads == 1) {
+            f(static_cast<std::size_t>(0), N);
+            return;
+        }
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(Nthreads, nullptr);
+        const std::size_t chunk = N / Nthreads, remainder = N % Nthreads;
+        std::size_t ibegin = 0;
+        for (std::size_t ithread = 0; ithread < Nthreads; ++ithread) {
+            // The first (remainder) chunks each get one more element
+            std::size_t iend = ibegin + chunk + (ithread < remainder ? 1 : 0);
+            threads.emplace_back([&f, &errors, ithread, ibegin, iend]() {
+                try {
+                    f(ibegin, iend);
+                }
+                catch (...) {
+                    errors[ithread] = std::current_exception();
+                }
+            });
+            ibegin = iend;
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (auto& e : errors) {
+            if (e) { std::rethrow_exception(e); }
+        }
+    }
+
+    /**
+    * \brief Call f(i) for each index i in [0, N), handing out the indices dynamically to the threads
+    *
+    * Each thread claims the next unclaimed index when it has finished its current one, so this is the
+    * better choice when the cost of the items is very uneven (for instance, tracing a curve), where a static 
+    * split into chunks would leave threads idle. If Nthreads is 0, the number of hardware threads is used.
+    * An exception thrown by f stops that thread from claiming more indices and is re-thrown on the calling 
+    * thread after all threads have been joined; callers that need per-item error handling should catch in f
+    */
+    template<typename Function>
+    void parallel_for_dynamic(const std::size_t N, std::size_t Nthreads, const Function& f) {
+        if (N == 0) { return; }
+        if (Nthreads == 0) {
+            Nthreads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        Nthreads = std::min(Nthreads, N);
+        std::atomic<std::size_t> next{ 0 };
+        auto worker = [&f, &next, N]() {
+            for (auto i = next++; i < N; i = next++) {
+                f(i);
+            }
+        };
+        if (Nthreads == 1) {
+            worker();
+            return;
+        }
+        std::vector<std::thread> threads;
+        std::vector<std::exception_ptr> errors(Nthreads, nullptr);
+        for (std::size_t ithread = 0; ithread < Nthreads; ++ithread) {
+            threads.emplace_back([&worker, &errors, ithread]() {
+                try {
+                    worker();
+                }
+                catch (...) {
+                    errors[ithread] = std::current_exception();
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        for (auto& e : errors) {
+            if (e) { std::rethrow_exception(e); }
+        }
+    }
+
+}; // namespace teqp
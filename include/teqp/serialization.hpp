@@ -0,0 +1,470 @@
+#pragma once
+
+/**
+* Binary serialization of the AllowedModels
+*
+* A model is stored as a compact blob that holds the flattened coefficient arrays of the model, as they are held
+* in memory once the model has been built, so that restoring a model is little more than a copy of the
+* arrays (no JSON parsing or lookup of parameters). The layout of the blob is:
+*
+* - a header: the magic bytes "teqp", the version of the format, and a marker of the byte order
+* - the kind of the model, as a string
+* - the data of the model
+*
+* Arrays are stored as their dimensions followed by the raw data. The blobs are meant to be passed between processes
+* on the same kind of machine; a blob written on a machine with a different byte order, or with a different version
+* of the format, is rejected when loading.
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <valarray>
+#include <variant>
+#include <vector>
+
+#include "teqp/models/fwd.hpp"
+#include "teqp/exceptions.hpp"
+
+namespace teqp {
+
+    namespace serialization {
+
+        /// The version of the binary format; to be incremented when the layout of any of the models changes
+        const std::uint32_t format_version = 2;
+        /// Written in the native byte order, to detect blobs written on a machine with a different byte order
+        const std::uint32_t byte_order_marker = 0x01020304;
+
+        /// Append-only writer of binary data into a byte buffer
+        class BinaryWriter {
+        private:
+            std::vector<std::uint8_t> buffer;
+            void put_bytes(const void* data, std::size_t N) {
+                auto p = static_cast<const std::uint8_t*>(data);
+                buffer.insert(buffer.end(), p, p + N);
+            }
+        public:
+            /**
+            * Store a value. Arithmetic and enum types are stored as their bytes; strings, std::vector and std::valarray as their
+            * length followed by the elements; and Eigen arrays and matrices as the number of rows and columns followed by the data (column-major)
+            */
+            template<typename T>
+            void put(const T& value) {
+                if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+                    put_bytes(&value, sizeof(T));
+                }
+                else if constexpr (std::is_same_v<T, std::string>) {
+                    put<std::uint64_t>(value.size());
+                    put_bytes(value.data(), value.size());
+                }
+                else if constexpr (std::is_base_of_v<Eigen::PlainObjectBase<T>, T>) {
+                    put<std::uint64_t>(value.rows());
+                    put<std::uint64_t>(value.cols());
+                    put_bytes(value.data(), sizeof(typename T::Scalar) * value.size());
+                }
+                else {
+                    // std::vector or std::valarray
+                    put<std::uint64_t>(value.size());
+                    for (const auto& el : value) { put(el); }
+                }
+            }
+            const auto& get_buffer() const { return buffer; }
+            auto release() { return std::move(buffer); }
+        };
+
+        /// Reader of the binary data written by BinaryWriter; reading past the end throws
+        class BinaryReader {
+        private:
+            const std::uint8_t* data;
+            const std::size_t size;
+            std::size_t pos = 0;
+            void get_bytes(void* out, std::size_t N) {
+                if (N > size - pos) {
+                    throw teqp::InvalidArgument("Binary data is truncated; unable to read " + std::to_string(N) + " bytes at offset " + std::to_string(pos));
+                }
+                if (N == 0) { return; } // out may be null for an empty array
+                std::memcpy(out, data + pos, N);
+                pos += N;
+            }
+            /// The smallest number of bytes that a stored value of type T can take
+            template<typename T>
+            static constexpr std::size_t min_stored_size() {
+                if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) { return sizeof(T); }
+                else if constexpr (std::is_base_of_v<Eigen::PlainObjectBase<T>, T>) { return 2 * sizeof(std::uint64_t); }
+                else { return sizeof(std::uint64_t); }
+            }
+            /// Check that N values, each taking at least elsize bytes, can fit in what is left, before anything is allocated for them
+            void check_length(std::uint64_t N, std::size_t elsize) const {
+                if (elsize > 0 && N > (size - pos) / elsize) {
+                    throw teqp::InvalidArgument("Binary data is truncated or invalid; " + std::to_string(N) + " values do not fit in the " + std::to_string(size - pos) + " bytes left at offset " + std::to_string(pos));
+                }
+            }
+        public:
+            BinaryReader(const std::vector<std::uint8_t>& buffer) : data(buffer.data()), size(buffer.size()) {};
+
+            template<typename T>
+            T get() {
+                if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+                    T value;
+                    get_bytes(&value, sizeof(T));
+                    return value;
+                }
+                else if constexpr (std::is_same_v<T, std::string>) {
+                    auto N = get<std::uint64_t>();
+                    check_length(N, 1);
+                    std::string s(static_cast<std::size_t>(N), '\0');
+                    get_bytes(s.data(), s.size());
+                    return s;
+                }
+                else if constexpr (std::is_base_of_v<Eigen::PlainObjectBase<T>, T>) {
+                    auto rows = get<std::uint64_t>(), cols = get<std::uint64_t>();
+                    if ((T::RowsAtCompileTime != Eigen::Dynamic && rows != static_cast<std::uint64_t>(T::RowsAtCompileTime))
+                        || (T::ColsAtCompileTime != Eigen::Dynamic && cols != static_cast<std::uint64_t>(T::ColsAtCompileTime))) {
+                        throw teqp::InvalidArgument("Binary data is invalid; the array has the wrong fixed size at offset " + std::to_string(pos));
+                    }
+                    const std::uint64_t maxdim = static_cast<std::uint64_t>(Eigen::NumTraits<Eigen::Index>::highest());
+                    if (rows > maxdim || cols > maxdim) {
+                        throw teqp::InvalidArgument("Binary data is invalid; the dimensions of the array at offset " + std::to_string(pos) + " are too large");
+                    }
+                    if (rows > 0 && cols > 0) {
+                        // In two steps, so that rows*cols cannot overflow
+                        check_length(rows, sizeof(typename T::Scalar));
+                        check_length(cols, sizeof(typename T::Scalar) * static_cast<std::size_t>(rows));
+                    }
+                    T a;
+                    a.resize(static_cast<Eigen::Index>(rows), static_cast<Eigen::Index>(cols));
+                    get_bytes(a.data(), sizeof(typename T::Scalar) * a.size());
+                    return a;
+                }
+                else {
+                    // std::vector or std::valarray
+                    auto N = get<std::uint64_t>();
+                    check_length(N, min_stored_size<std::decay_t<decltype(*std::begin(std::declval<T&>()))>>());
+                    T v(static_cast<std::size_t>(N));
+                    for (auto& el : v) { el = get<std::decay_t<decltype(el)>>(); }
+                    return v;
+                }
+            }
+            /// True if all the data have been read
+            bool at_end() const { return pos == size; }
+        };
+    }
+
+    /**
+    * \brief Conversion of the models to and from the binary format
+    *
+    * The models declare this as a friend, so that their internal arrays can be stored and restored exactly,
+    * without recalculating them from the inputs of the constructors
+    */
+    struct ModelSerializer {
+        using BinaryWriter = serialization::BinaryWriter;
+        using BinaryReader = serialization::BinaryReader;
+
+        using CubicModel = std::decay_t<decltype(canonical_PR(vad{}, vad{}, vad{}))>;
+        using CPAModel = std::decay_t<decltype(CPA::CPAfactory(nlohmann::json{}))>;
+        using PCSAFTModel = std::decay_t<decltype(PCSAFT::PCSAFTfactory(nlohmann::json{}))>;
+        using MultiFluidModel = std::decay_t<decltype(multifluidfactory(nlohmann::json{}))>;
+
+        /// The coefficient arrays of each of the terms of the multifluid model, as a tuple of references
+        template<typename T>
+        static auto term_fields(T& t) {
+            using Term = std::remove_const_t<T>;
+            if constexpr (std::is_same_v<Term, JustPowerEOSTerm>) { return std::tie(t.n, t.t, t.d); }
+            else if constexpr (std::is_same_v<Term, PowerEOSTerm>) { return std::tie(t.n, t.t, t.d, t.c, t.l, t.l_i); }
+            else if constexpr (std::is_same_v<Term, ExponentialEOSTerm>) { return std::tie(t.n, t.t, t.d, t.g, t.l, t.l_i); }
+            else if constexpr (std::is_same_v<Term, DoubleExponentialEOSTerm>) { return std::tie(t.n, t.t, t.d, t.gd, t.ld, t.gt, t.lt, t.ld_i); }
+            else if constexpr (std::is_same_v<Term, GaussianEOSTerm> || std::is_same_v<Term, GERG2004EOSTerm>) { return std::tie(t.n, t.t, t.d, t.eta, t.beta, t.gamma, t.epsilon); }
+            else if constexpr (std::is_same_v<Term, Lemmon2005EOSTerm>) { return std::tie(t.n, t.t, t.d, t.l, t.m, t.l_i); }
+            else if constexpr (std::is_same_v<Term, GaoBEOSTerm>) { return std::tie(t.n, t.t, t.d, t.eta, t.beta, t.gamma, t.epsilon, t.b); }
+            else if constexpr (std::is_same_v<Term, Chebyshev2DEOSTerm>) { return std::tie(t.a, t.taumin, t.taumax, t.deltamin, t.deltamax); }
+            else if constexpr (std::is_same_v<Term, NonAnalyticEOSTerm>) { return std::tie(t.A, t.B, t.C, t.D, t.a, t.b, t.beta, t.n); }
+            else if constexpr (std::is_same_v<Term, NullEOSTerm>) { return std::tie(); }
+            else if constexpr (std::is_same_v<Term, MultiFluidReducingFunction>) { return std::tie(t.betaT, t.gammaT, t.betaV, t.gammaV, t.Tc, t.vc); }
+            else if constexpr (std::is_same_v<Term, MultiFluidInvariantReducingFunction>) { return std::tie(t.phiT, t.lambdaT, t.phiV, t.lambdaV, t.Tc, t.vc); }
+            else { static_assert(!std::is_same_v<Term, Term>, "Unknown term type"); }
+        }
+
+        /// A tuple of values of the types referred to by a tuple of references
+        template<typename Tuple> struct values_of;
+        template<typename... Args> struct values_of<std::tuple<Args...>> { using type = std::tuple<std::decay_t<Args>...>; };
+
+        template<typename Term>
+        static void write_term(BinaryWriter& w, const Term& term) {
+            std::apply([&w](const auto&... field) { (w.put(field), ...); }, term_fields(term));
+        }
+        template<typename Term>
+        static Term read_term(BinaryReader& r) {
+            if constexpr (std::is_default_constructible_v<Term>) {
+                Term term;
+                std::apply([&r](auto&... field) { ((field = r.get<std::decay_t<decltype(field)>>()), ...); }, term_fields(term));
+                return term;
+            }
+            else {
+                // The reducing functions have const members, and are built from their fields
+                using Fields = typename values_of<decltype(term_fields(std::declval<const Term&>()))>::type;
+                Fields fields;
+                std::apply([&r](auto&... field) { ((field = r.get<std::decay_t<decltype(field)>>()), ...); }, fields);
+                return std::make_from_tuple<Term>(fields);
+            }
+        }
+
+        /// Variants are stored as the index of the alternative followed by its fields
+        template<typename Variant, typename WriteAlternative>
+        static void write_variant(BinaryWriter& w, const Variant& v, const WriteAlternative& write_alternative) {
+            w.put<std::uint32_t>(static_cast<std::uint32_t>(v.index()));
+            std::visit([&](const auto& alt) { write_alternative(w, alt); }, v);
+        }
+        template<typename Variant, typename ReadAlternative, std::size_t I = 0>
+        static Variant read_variant(BinaryReader& r, const ReadAlternative& read_alternative, std::size_t index = std::size_t(-1)) {
+            if (index == std::size_t(-1)) {
+                index = r.get<std::uint32_t>();
+            }
+            if constexpr (I < std::variant_size_v<Variant>) {
+                if (index == I) {
+                    return Variant(std::in_place_index<I>, read_alternative(r, static_cast<std::variant_alternative_t<I, Variant>*>(nullptr)));
+                }
+                return read_variant<Variant, ReadAlternative, I + 1>(r, read_alternative, index);
+            }
+            else {
+                throw teqp::InvalidArgument("Invalid variant index of " + std::to_string(index));
+            }
+        }
+
+        template<typename Container>
+        static void write_term_container(BinaryWriter& w, const Container& container) {
+            const auto& terms = container.get_terms();
+            w.put<std::uint64_t>(terms.size());
+            for (const auto& term : terms) {
+                write_variant(w, term, [](BinaryWriter& w, const auto& t) { write_term(w, t); });
+            }
+        }
+        template<typename Container>
+        static Container read_term_container(BinaryReader& r) {
+            using Variant = std::decay_t<decltype(std::declval<const Container&>().get_terms()[0])>;
+            auto read_alternative = [](BinaryReader& r, auto* tag) { return read_term<std::remove_pointer_t<decltype(tag)>>(r); };
+            Container container;
+            auto N = r.get<std::uint64_t>();
+            for (auto i = 0U; i < N; ++i) {
+                std::visit([&container](auto&& t) { container.add_term(std::move(t)); }, read_variant<Variant>(r, read_alternative));
+            }
+            return container;
+        }
+
+        // vdW1
+        static void write(BinaryWriter& w, const vdWEOS1& model) {
+            w.put(model.a); w.put(model.b);
+        }
+        static vdWEOS1 read_vdW1(BinaryReader& r) {
+            auto a = r.get<double>(), b = r.get<double>();
+            return vdWEOS1(a, b);
+        }
+
+        // Cubics
+        static void write(BinaryWriter& w, const CubicModel& model) {
+            w.put(model.Delta1); w.put(model.Delta2); w.put(model.OmegaA); w.put(model.OmegaB); w.put(model.superanc_index);
+            w.put(model.ai); w.put(model.bi);
+            w.put<std::uint64_t>(model.alphas.size());
+            for (const auto& alpha : model.alphas) {
+                write_variant(w, alpha, [](BinaryWriter& w, const auto& a) { w.put(a.Tci); w.put(a.mi); });
+            }
+            w.put(model.kmat);
+            w.put(model.meta.dump());
+        }
+        static CubicModel read_cubic(BinaryReader& r) {
+            auto Delta1 = r.get<double>(), Delta2 = r.get<double>(), OmegaA = r.get<double>(), OmegaB = r.get<double>();
+            auto superanc_index = r.get<int>();
+            auto ai = r.get<std::valarray<double>>(), bi = r.get<std::valarray<double>>();
+            std::vector<AlphaFunctionOptions> alphas;
+            auto read_alpha = [](BinaryReader& r, auto* tag) {
+                auto Tci = r.get<double>(), mi = r.get<double>();
+                return std::remove_pointer_t<decltype(tag)>(Tci, mi);
+            };
+            auto Nalphas = r.get<std::uint64_t>();
+            for (auto i = 0U; i < Nalphas; ++i) {
+                alphas.emplace_back(read_variant<AlphaFunctionOptions>(r, read_alpha));
+            }
+            auto kmat = r.get<Eigen::ArrayXXd>();
+            auto meta = nlohmann::json::parse(r.get<std::string>());
+            // The dummy critical points are only used to size the arrays, which are then overwritten
+            std::valarray<double> ones(1.0, ai.size());
+            CubicModel model(Delta1, Delta2, OmegaA, OmegaB, superanc_index, ones, ones, alphas, kmat);
+            model.ai = ai;
+            model.bi = bi;
+            model.set_meta(meta);
+            return model;
+        }
+
+        // CPA
+        static void write(BinaryWriter& w, const CPA::CPACubic& cubic) {
+            w.put(cubic.a0); w.put(cubic.bi); w.put(cubic.c1); w.put(cubic.Tc);
+            w.put(cubic.delta_1); w.put(cubic.delta_2); w.put(cubic.k_ij); w.put(cubic.R_gas);
+        }
+        static CPA::CPACubic read_CPA_cubic(BinaryReader& r) {
+            auto a0 = r.get<std::valarray<double>>(), bi = r.get<std::valarray<double>>(), c1 = r.get<std::valarray<double>>(), Tc = r.get<std::valarray<double>>();
+            auto delta_1 = r.get<double>(), delta_2 = r.get<double>();
+            auto k_ij = r.get<std::valarray<std::valarray<double>>>();
+            auto R_gas = r.get<double>();
+            // The flag only sets delta_1 and delta_2, which are overwritten
+            CPA::CPACubic cubic(CPA::cubic_flag::PR, a0, bi, c1, Tc, R_gas);
+            cubic.delta_1 = delta_1;
+            cubic.delta_2 = delta_2;
+            cubic.k_ij = k_ij;
+            return cubic;
+        }
+        static void write(BinaryWriter& w, const CPAModel& model) {
+            write(w, model.cubic);
+            const auto& assoc = model.assoc;
+            write(w, assoc.cubic);
+            w.put(assoc.classes); w.put(assoc.epsABi); w.put(assoc.betaABi); w.put(assoc.R_gas); w.put(assoc.dist); w.put(assoc.warm_start);
+        }
+        static CPAModel read_CPA(BinaryReader& r) {
+            auto cubic = read_CPA_cubic(r);
+            auto assoc_cubic = read_CPA_cubic(r);
+            auto classes = r.get<std::vector<CPA::association_classes>>();
+            auto epsABi = r.get<std::valarray<double>>(), betaABi = r.get<std::valarray<double>>();
+            auto R_gas = r.get<double>();
+            auto dist = r.get<CPA::radial_dist>();
+            auto warm_start = r.get<bool>();
+            using Assoc = std::decay_t<decltype(std::declval<CPAModel>().assoc)>;
+            Assoc assoc(std::move(assoc_cubic), classes, epsABi, betaABi, R_gas, dist);
+            assoc.set_warm_start(warm_start);
+            return CPAModel(std::move(cubic), std::move(assoc));
+        }
+
+        // PC-SAFT
+        static void write(BinaryWriter& w, const PCSAFTModel& model) {
+            w.put(model.m); w.put(model.sigma_Angstrom); w.put(model.epsilon_over_k); w.put(model.kmat);
+            w.put<std::uint64_t>(model.names.size());
+            for (const auto& name : model.names) { w.put(name); }
+        }
+        static PCSAFTModel read_PCSAFT(BinaryReader& r) {
+            auto m = r.get<Eigen::ArrayXd>(), sigma_Angstrom = r.get<Eigen::ArrayXd>(), epsilon_over_k = r.get<Eigen::ArrayXd>();
+            auto kmat = r.get<Eigen::ArrayXXd>();
+            std::vector<PCSAFT::SAFTCoeffs> coeffs(r.get<std::uint64_t>());
+            for (auto i = 0U; i < coeffs.size(); ++i) {
+                coeffs[i].name = r.get<std::string>();
+                coeffs[i].m = m[i];
+                coeffs[i].sigma_Angstrom = sigma_Angstrom[i];
+                coeffs[i].epsilon_over_k = epsilon_over_k[i];
+            }
+            return PCSAFTModel(coeffs, kmat);
+        }
+
+        // Multi-fluid
+        static void write(BinaryWriter& w, const MultiFluidModel& model) {
+            write_variant(w, model.redfunc.term, [](BinaryWriter& w, const auto& t) { write_term(w, t); });
+            const auto& EOSs = model.corr.EOSs;
+            w.put<std::uint64_t>(EOSs.size());
+            for (const auto& EOS : EOSs) {
+                write_term_container(w, EOS);
+            }
+            w.put(model.dep.F);
+            const auto& funcs = model.dep.funcs;
+            w.put<std::uint64_t>(funcs.size());
+            for (const auto& row : funcs) {
+                w.put<std::uint64_t>(row.size());
+                for (const auto& func : row) {
+                    write_term_container(w, func);
+                }
+            }
+            w.put(model.get_meta());
+        }
+        static MultiFluidModel read_multifluid(BinaryReader& r) {
+            using Reducing = std::decay_t<decltype(std::declval<MultiFluidModel>().redfunc)>;
+            using Corr = std::decay_t<decltype(std::declval<MultiFluidModel>().corr)>;
+            using Dep = std::decay_t<decltype(std::declval<MultiFluidModel>().dep)>;
+            using EOSCollection = std::decay_t<decltype(std::declval<Corr>().EOSs)>;
+            using FCollection = std::decay_t<decltype(std::declval<Dep>().F)>;
+            using DepartureFunctionCollection = std::decay_t<decltype(std::declval<Dep>().funcs)>;
+            using ReducingVariant = std::decay_t<decltype(std::declval<Reducing>().term)>;
+
+            auto read_alternative = [](BinaryReader& r, auto* tag) { return read_term<std::remove_pointer_t<decltype(tag)>>(r); };
+            auto redvariant = read_variant<ReducingVariant>(r, read_alternative);
+            auto redfunc = std::visit([](auto&& t) { return Reducing(t); }, redvariant);
+
+            EOSCollection EOSs;
+            auto NEOS = r.get<std::uint64_t>();
+            for (auto i = 0U; i < NEOS; ++i) {
+                EOSs.emplace_back(read_term_container<typename EOSCollection::value_type>(r));
+            }
+            auto F = r.get<FCollection>();
+            DepartureFunctionCollection funcs(r.get<std::uint64_t>());
+            for (auto& row : funcs) {
+                auto Ncols = r.get<std::uint64_t>();
+                for (auto j = 0U; j < Ncols; ++j) {
+                    row.emplace_back(read_term_container<typename DepartureFunctionCollection::value_type::value_type>(r));
+                }
+            }
+            auto meta = r.get<std::string>();
+            MultiFluidModel model(std::move(redfunc), Corr(std::move(EOSs)), Dep(std::move(F), std::move(funcs)));
+            model.set_meta(meta);
+            return model;
+        }
+
+        /// The kind of each of the AllowedModels, as stored in the blob
+        template<typename Model>
+        static std::string get_kind() {
+            if constexpr (std::is_same_v<Model, vdWEOS1>) { return "vdW1"; }
+            else if constexpr (std::is_same_v<Model, CubicModel>) { return "cubic"; }
+            else if constexpr (std::is_same_v<Model, CPAModel>) { return "CPA"; }
+            else if constexpr (std::is_same_v<Model, PCSAFTModel>) { return "PCSAFT"; }
+            else if constexpr (std::is_same_v<Model, MultiFluidModel>) { return "multifluid"; }
+            else { static_assert(!std::is_same_v<Model, Model>, "Unknown model type"); }
+        }
+
+        static std::vector<std::uint8_t> to_blob(const AllowedModels& model) {
+            BinaryWriter w;
+            w.put('t'); w.put('e'); w.put('q'); w.put('p');
+            w.put(serialization::format_version);
+            w.put(serialization::byte_order_marker);
+            std::visit([&w](const auto& m) {
+                w.put(get_kind<std::decay_t<decltype(m)>>());
+                write(w, m);
+            }, model);
+            return w.release();
+        }
+
+        static AllowedModels from_blob(const std::vector<std::uint8_t>& blob) {
+            BinaryReader r(blob);
+            std::string magic(4, ' ');
+            for (auto& c : magic) { c = r.get<char>(); }
+            if (magic != "teqp") {
+                throw teqp::InvalidArgument("Binary data is not a teqp model");
+            }
+            auto version = r.get<std::uint32_t>();
+            if (version != serialization::format_version) {
+                throw teqp::InvalidArgument("Binary format version " + std::to_string(version) + " is not the supported version " + std::to_string(serialization::format_version));
+            }
+            if (r.get<std::uint32_t>() != serialization::byte_order_marker) {
+                throw teqp::InvalidArgument("Binary data were written on a machine with a different byte order");
+            }
+            auto kind = r.get<std::string>();
+            auto build = [&]() -> AllowedModels {
+                if (kind == "vdW1") { return read_vdW1(r); }
+                else if (kind == "cubic") { return read_cubic(r); }
+                else if (kind == "CPA") { return read_CPA(r); }
+                else if (kind == "PCSAFT") { return read_PCSAFT(r); }
+                else if (kind == "multifluid") { return read_multifluid(r); }
+                else { throw teqp::InvalidArgument("Unknown kind of model in binary data: " + kind); }
+            };
+            auto model = build();
+            if (!r.at_end()) {
+                throw teqp::InvalidArgument("Binary data has trailing bytes after the model");
+            }
+            return model;
+        }
+    };
+
+    /// Store a model in the versioned binary format, see teqp/serialization.hpp
+    inline std::vector<std::uint8_t> model_to_binary(const AllowedModels& model) {
+        return ModelSerializer::to_blob(model);
+    }
+
+    /// Restore a model stored with model_to_binary
+    inline AllowedModels model_from_binary(const std::vector<std::uint8_t>& blob) {
+        return ModelSerializer::from_blob(blob);
+    }
+
+}; // namespace teqp
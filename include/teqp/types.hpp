@@ -19,6 +19,7 @@ namespace teqp {
 
 #include <valarray>
 #include <chrono>
+#include <type_traits>
 
 #if defined(TEQP_MULTIPRECISION_ENABLED)
 #include "boost/multiprecision/cpp_bin_float.hpp"
@@ -156,8 +157,7 @@ namespace teqp {
     template<typename T>
     inline auto powIVi(const T& x, const Eigen::ArrayXi& e) {
         //return e.binaryExpr(e.cast<T>(), [&x](const auto&& a_, const auto& e_) {return static_cast<T>(powi(x, a_)); });
-        static Eigen::Array<T, Eigen::Dynamic, 1> o;
-        o.resize(e.size());
+        Eigen::Array<T, Eigen::Dynamic, 1> o(e.size());
         for (auto i = 0; i < e.size(); ++i) {
             o[i] = powi(x, e[i]);
         }
@@ -165,6 +165,45 @@ namespace teqp {
         //return e.cast<T>().unaryExpr([&x](const auto& e_) {return powi(x, e_); }).eval();
     }
 
+    namespace detail {
+
+        /// Seed the infinitesimal part of the given level of a nested (higher-order) dual number; level 1 is the outermost
+        template<int level, typename DualType>
+        void seed_dual_level(DualType& x) {
+            if constexpr (level == 1) {
+                x.grad = 1.0;
+            }
+            else {
+                seed_dual_level<level - 1>(x.val);
+            }
+        }
+
+        /// Seed the levels [ibegin, iend] of a nested dual number
+        template<int ibegin, int iend, typename DualType>
+        void seed_dual_levels(DualType& x) {
+            if constexpr (ibegin <= iend) {
+                seed_dual_level<ibegin>(x);
+                seed_dual_levels<ibegin + 1, iend>(x);
+            }
+        }
+
+        /**
+        * \brief Extract one component of a nested dual number
+        *
+        * Bit k of the mask (bit 0 is the outermost level) selects the infinitesimal part of level k+1, so the
+        * component is the mixed derivative with respect to the variables seeded at the selected levels
+        */
+        template<typename DualType>
+        double get_dual_component(const DualType& x, unsigned int mask) {
+            if constexpr (std::is_arithmetic_v<DualType>) {
+                return x;
+            }
+            else {
+                return get_dual_component((mask & 1U) ? x.grad : x.val, mask >> 1);
+            }
+        }
+    }
+
     //template<typename T>
     //auto powIV(const T& x, const Eigen::ArrayXd& e) {
     //    Eigen::Array<T, Eigen::Dynamic, 1> o = e.cast<T>();
@@ -6,6 +6,14 @@
 #include <unordered_map>
 #include <variant>
 #include <atomic>
+#include <array>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 
 #include "teqpcpp.hpp"
 #include "teqp/exceptions.hpp"
@@ -34,14 +42,116 @@ using namespace teqp;
 // The max possible index is 18,446,744,073,709,551,615
 std::atomic<unsigned long long int> next_index{ 0 };
 
-/// A function for returning a sequential index of the next 
-std::string get_uid(int N) {
-    auto s = std::to_string(next_index);
-    next_index++;
+/// The integer handle that is used as the key in the library of models
+using handle_type = unsigned long long int;
+
+/// A function for returning a sequential index of the next model
+handle_type get_next_handle() {
+    return next_index++;
+}
+
+/// The number of characters in the zero-padded uid returned by build_model
+constexpr std::size_t uid_width = 32;
+
+/// A function for converting a handle to its zero-padded string form with N characters, used as the uid of the model
+std::string get_uid(handle_type handle, int N) {
+    auto s = std::to_string(handle);
     return std::string(N - s.size(), '0') + s;
 }
 
-std::unordered_map<std::string, std::unique_ptr<teqp::cppinterface::AbstractModel>> library;
+/// The string uid is the zero-padded string form of the handle, so the handle can be recovered without hashing the string
+handle_type uid_to_handle(const char* uuid) {
+    if (uuid == nullptr) {
+        throw teqpcException(40, "Invalid model uid: null pointer");
+    }
+    // Only decimal digits are accepted, up to the padded width; strtoull alone would also take a sign or leading whitespace
+    const auto len = std::strlen(uuid);
+    if (len == 0 || len > uid_width || std::strspn(uuid, "0123456789") != len) {
+        throw teqpcException(40, "Invalid model uid: " + std::string(uuid));
+    }
+    // Skip the zero padding, then check the significant digits fit in a handle_type
+    const auto Nzeros = std::strspn(uuid, "0");
+    if (Nzeros == len) {
+        return 0;
+    }
+    const char* digits = uuid + Nzeros;
+    if (len - Nzeros > static_cast<std::size_t>(std::numeric_limits<handle_type>::digits10) + 1) {
+        throw teqpcException(40, "Invalid model uid: " + std::string(uuid));
+    }
+    errno = 0;
+    auto handle = std::strtoull(digits, nullptr, 10);
+    if (errno == ERANGE) {
+        throw teqpcException(40, "Invalid model uid: " + std::string(uuid));
+    }
+    return handle;
+}
+
+/**
+* The library of models, safe for concurrent use from many threads
+*
+* The models are split over a fixed number of shards by their handle, and each shard has its own shared_mutex.
+* Lookups take a shared lock on one shard only long enough to copy the shared_ptr, so evaluations never block
+* each other, and adding or removing a model only blocks lookups of the models in the same shard. Because a lookup
+* holds a reference to the model, a model that is freed while another thread is using it lives on until that
+* evaluation finishes.
+*/
+class ModelLibrary {
+public:
+    using model_pointer = std::shared_ptr<const teqp::cppinterface::AbstractModel>;
+private:
+    static constexpr std::size_t Nshards = 64;
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<handle_type, model_pointer> models;
+    };
+    std::array<Shard, Nshards> shards;
+    Shard& get_shard(handle_type handle) { return shards[handle % Nshards]; }
+    const Shard& get_shard(handle_type handle) const { return shards[handle % Nshards]; }
+public:
+    void add(handle_type handle, model_pointer&& model) {
+        auto& shard = get_shard(handle);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.models.emplace(handle, std::move(model));
+    }
+    void remove(handle_type handle) {
+        model_pointer removed;
+        {
+            auto& shard = get_shard(handle);
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.models.find(handle);
+            if (it == shard.models.end()) { return; }
+            removed = std::move(it->second);
+            shard.models.erase(it);
+        }
+        // The model (if this was the last reference) is destroyed here, after the lock has been released
+    }
+    /// Lookup the model in the library, throwing if it is not found
+    model_pointer get(handle_type handle) const {
+        const auto& shard = get_shard(handle);
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.models.find(handle);
+        if (it == shard.models.end()) {
+            throw teqpcException(41, "Unable to find the model with handle " + std::to_string(handle));
+        }
+        return it->second;
+    }
+    /// The total number of models in the library
+    std::size_t size() const {
+        std::size_t N = 0;
+        for (const auto& shard : shards) {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            N += shard.models.size();
+        }
+        return N;
+    }
+};
+
+ModelLibrary library;
+
+/// Lookup the model in the library, throwing if it is not found
+auto get_model(handle_type handle) {
+    return library.get(handle);
+}
 
 void exception_handler(int& errcode, char* message_buffer, const int buffer_length)
 {
@@ -58,17 +168,26 @@ void exception_handler(int& errcode, char* message_buffer, const int buffer_leng
     }
 }
 
+/// Build the model and store it in the library, returning its handle
+handle_type add_model(const char* j) {
+    nlohmann::json json = nlohmann::json::parse(j);
+    ModelLibrary::model_pointer model;
+    try {
+        // The model is built before touching the library so that no locks are held while building
+        model = cppinterface::make_model(json);
+    }
+    catch (std::exception &e) {
+        throw teqpcException(30, "Unable to load with error:" + std::string(e.what()));
+    }
+    auto handle = get_next_handle();
+    library.add(handle, std::move(model));
+    return handle;
+}
+
 EXPORT_CODE int CONVENTION build_model(const char* j, char* uuid, char* errmsg, int errmsg_length){
     int errcode = 0;
     try{
-        nlohmann::json json = nlohmann::json::parse(j);
-        std::string uid = get_uid(32);
-        try {
-            library.emplace(std::make_pair(uid, cppinterface::make_model(json)));
-        }
-        catch (std::exception &e) {
-            throw teqpcException(30, "Unable to load with error:" + std::string(e.what()));
-        }
+        std::string uid = get_uid(add_model(j), static_cast<int>(uid_width));
         strcpy(uuid, uid.c_str());
     }
     catch (...) {
@@ -77,10 +196,32 @@ EXPORT_CODE int CONVENTION build_model(const char* j, char* uuid, char* errmsg,
     return errcode;
 }
 
+EXPORT_CODE int CONVENTION build_model_handle(const char* j, long long int* handle, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        *handle = static_cast<long long int>(add_model(j));
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
 EXPORT_CODE int CONVENTION free_model(char* uuid, char* errmsg, int errmsg_length) {
     int errcode = 0;
     try {
-        library.erase(std::string(uuid));
+        library.remove(uid_to_handle(uuid));
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+EXPORT_CODE int CONVENTION free_model_handle(const long long int handle, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        library.remove(static_cast<handle_type>(handle));
     }
     catch (...) {
         exception_handler(errcode, errmsg, errmsg_length);
@@ -94,7 +235,90 @@ EXPORT_CODE int CONVENTION get_Arxy(const char* uuid, const int NT, const int ND
         // Make an Eigen view of the double buffer
         Eigen::Map<const Eigen::ArrayXd> molefrac_(molefrac, Ncomp);
         // Call the function
-        *val = library.at(std::string(uuid))->get_Arxy(NT, ND, T, rho, molefrac_);
+        *val = get_model(uid_to_handle(uuid))->get_Arxy(NT, ND, T, rho, molefrac_);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+EXPORT_CODE int CONVENTION get_Arxy_handle(const long long int handle, const int NT, const int ND, const double T, const double rho, const double* molefrac, const int Ncomp, double* val, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        Eigen::Map<const Eigen::ArrayXd> molefrac_(molefrac, Ncomp);
+        *val = get_model(static_cast<handle_type>(handle))->get_Arxy(NT, ND, T, rho, molefrac_);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+/// Check the sizes passed to the batched functions before any of the buffers of the caller are touched
+void check_batch_sizes(const int N, const int Ncomp, const char* funcname) {
+    if (N <= 0) {
+        throw teqpcException(42, "The number of state points N must be positive in " + std::string(funcname) + "; it is " + std::to_string(N));
+    }
+    if (Ncomp <= 0) {
+        throw teqpcException(42, "The number of components Ncomp must be positive in " + std::string(funcname) + "; it is " + std::to_string(Ncomp));
+    }
+}
+
+/// Make a copy of a C (row-major) buffer of Nrows x Ncomp doubles as an Eigen array with one row per state point
+Eigen::ArrayXXd rowmajor_to_array(const double* buf, const int Nrows, const int Ncomp) {
+    using RowMajorArray = Eigen::Array<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
+    return Eigen::Map<const RowMajorArray>(buf, Nrows, Ncomp);
+}
+
+/**
+* Evaluate Arxy for N state points in one call.  T, rho and vals are buffers of length N. molefrac is a row-major 
+* buffer of Nmolefrac_rows x Ncomp mole fractions, where Nmolefrac_rows is either N (one composition per point), 
+* or 1 (the same composition for all points)
+*/
+EXPORT_CODE int CONVENTION get_Arxy_many(const long long int handle, const int NT, const int ND, const double* T, const double* rho, const double* molefrac, const int Nmolefrac_rows, const int Ncomp, const int N, double* vals, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        check_batch_sizes(N, Ncomp, "get_Arxy_many");
+        if (Nmolefrac_rows != 1 && Nmolefrac_rows != N) {
+            throw teqpcException(42, "Nmolefrac_rows must be either 1 or N in get_Arxy_many; it is " + std::to_string(Nmolefrac_rows));
+        }
+        const auto& model = get_model(static_cast<handle_type>(handle));
+        model->get_Arxy_many(NT, ND, T, rho, rowmajor_to_array(molefrac, Nmolefrac_rows, Ncomp), vals, N);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+/**
+* Evaluate the residual pressure for N state points in one call.  T and vals are buffers of length N. 
+* rhovec is a row-major buffer of N x Ncomp molar concentrations
+*/
+EXPORT_CODE int CONVENTION get_pr_many(const long long int handle, const double* T, const double* rhovec, const int Ncomp, const int N, double* vals, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        check_batch_sizes(N, Ncomp, "get_pr_many");
+        const auto& model = get_model(static_cast<handle_type>(handle));
+        model->get_pr_many(T, rowmajor_to_array(rhovec, N, Ncomp), vals, N);
+    }
+    catch (...) {
+        exception_handler(errcode, errmsg, errmsg_length);
+    }
+    return errcode;
+}
+
+/**
+* Evaluate the gradient of Psir w.r.t. the molar concentrations for N state points in one call.  T is a buffer of length N.
+* rhovec and vals are row-major buffers of N x Ncomp values
+*/
+EXPORT_CODE int CONVENTION build_Psir_gradient_many(const long long int handle, const double* T, const double* rhovec, const int Ncomp, const int N, double* vals, char* errmsg, int errmsg_length) {
+    int errcode = 0;
+    try {
+        check_batch_sizes(N, Ncomp, "build_Psir_gradient_many");
+        const auto& model = get_model(static_cast<handle_type>(handle));
+        model->build_Psir_gradient_many(T, rowmajor_to_array(rhovec, N, Ncomp), vals, N);
     }
     catch (...) {
         exception_handler(errcode, errmsg, errmsg_length);
@@ -105,9 +329,14 @@ EXPORT_CODE int CONVENTION get_Arxy(const char* uuid, const int NT, const int ND
 #if defined(TEQPC_CATCH)
 
 #include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
 #include <catch2/benchmark/catch_benchmark_all.hpp>
 
+using Catch::Approx;
+
 #include "teqp/json_tools.hpp"
+#include <future>
+#include "teqp/constants.hpp"
 
 TEST_CASE("Use of C interface","[teqpc]") {
 
@@ -289,6 +518,176 @@ TEST_CASE("Use of C interface","[teqpc]") {
     };
     
 }
+
+TEST_CASE("Use of C interface with integer handles and batched calls", "[teqpc]") {
+
+    constexpr int errmsg_length = 300;
+    char errmsg[errmsg_length] = "";
+    std::string j = R"(
+            {
+                "kind": "PR", 
+                "model": {
+                    "Tcrit / K": [190, 210], 
+                    "pcrit / Pa": [3.5e6, 4.5e6], 
+                    "acentric": [0.11, 0.2]
+                }
+            }
+        )";
+    long long int handle = -1;
+    REQUIRE(build_model_handle(j.c_str(), &handle, errmsg, errmsg_length) == 0);
+    
+    const int N = 100, Ncomp = 2;
+    std::vector<double> T(N), rho(N), molefrac = { 0.3, 0.7 }, vals(N), rhovec(N * Ncomp), grad(N * Ncomp);
+    for (auto i = 0; i < N; ++i) {
+        T[i] = 300 + i; rho[i] = 10.0 * (i + 1);
+        rhovec[i * Ncomp] = rho[i] * molefrac[0]; rhovec[i * Ncomp + 1] = rho[i] * molefrac[1];
+    }
+
+    SECTION("batched Arxy matches scalar calls") {
+        REQUIRE(get_Arxy_many(handle, 0, 1, &(T[0]), &(rho[0]), &(molefrac[0]), 1, Ncomp, N, &(vals[0]), errmsg, errmsg_length) == 0);
+        for (auto i = 0; i < N; ++i) {
+            double val = -1;
+            REQUIRE(get_Arxy_handle(handle, 0, 1, T[i], rho[i], &(molefrac[0]), Ncomp, &val, errmsg, errmsg_length) == 0);
+            CHECK(val == vals[i]);
+        }
+    }
+    SECTION("batched isochoric calls") {
+        REQUIRE(get_pr_many(handle, &(T[0]), &(rhovec[0]), Ncomp, N, &(vals[0]), errmsg, errmsg_length) == 0);
+        REQUIRE(build_Psir_gradient_many(handle, &(T[0]), &(rhovec[0]), Ncomp, N, &(grad[0]), errmsg, errmsg_length) == 0);
+        for (auto i = 0; i < N; ++i) {
+            double Ar00 = -1, Ar01 = -1;
+            REQUIRE(get_Arxy_handle(handle, 0, 0, T[i], rho[i], &(molefrac[0]), Ncomp, &Ar00, errmsg, errmsg_length) == 0);
+            REQUIRE(get_Arxy_handle(handle, 0, 1, T[i], rho[i], &(molefrac[0]), Ncomp, &Ar01, errmsg, errmsg_length) == 0);
+            double RT = get_R_gas<double>() * T[i];
+            double pr = rho[i] * RT * Ar01, Psir = rho[i] * RT * Ar00;
+            CHECK(vals[i] == Approx(pr).epsilon(1e-12));
+            // pr = sum_i rho_i*dPsir/drho_i - Psir
+            double sum = rhovec[i * Ncomp] * grad[i * Ncomp] + rhovec[i * Ncomp + 1] * grad[i * Ncomp + 1];
+            CHECK(sum - Psir == Approx(pr).epsilon(1e-10));
+        }
+    }
+    SECTION("invalid handle") {
+        double val = -1;
+        CHECK(get_Arxy_handle(handle + 1000, 0, 1, 300, 1.0, &(molefrac[0]), Ncomp, &val, errmsg, errmsg_length) != 0);
+    }
+    SECTION("invalid sizes") {
+        CHECK(get_Arxy_many(handle, 0, 1, &(T[0]), &(rho[0]), &(molefrac[0]), 1, Ncomp, 0, &(vals[0]), errmsg, errmsg_length) != 0);
+        CHECK(get_Arxy_many(handle, 0, 1, &(T[0]), &(rho[0]), &(molefrac[0]), 1, Ncomp, -1, &(vals[0]), errmsg, errmsg_length) != 0);
+        CHECK(get_Arxy_many(handle, 0, 1, &(T[0]), &(rho[0]), &(molefrac[0]), 1, -2, N, &(vals[0]), errmsg, errmsg_length) != 0);
+        CHECK(get_Arxy_many(handle, 0, 1, &(T[0]), &(rho[0]), &(molefrac[0]), 2, Ncomp, N, &(vals[0]), errmsg, errmsg_length) != 0);
+        CHECK(get_pr_many(handle, &(T[0]), &(rhovec[0]), 0, N, &(vals[0]), errmsg, errmsg_length) != 0);
+        CHECK(build_Psir_gradient_many(handle, &(T[0]), &(rhovec[0]), Ncomp, -5, &(grad[0]), errmsg, errmsg_length) != 0);
+    }
+    SECTION("uid parsing") {
+        CHECK(uid_to_handle("0000000042") == 42);
+        CHECK(uid_to_handle(get_uid(42, 32).c_str()) == 42);
+        CHECK(uid_to_handle(get_uid(0, 32).c_str()) == 0);
+        CHECK(uid_to_handle(get_uid(18446744073709551615ULL, 32).c_str()) == 18446744073709551615ULL);
+        for (auto bad : { "", "-1", " 42", "42 ", "+42", "4x2", "99999999999999999999999", "18446744073709551616",
+                          "000000000000000000000000000000042" }) {
+            CHECK_THROWS(uid_to_handle(bad));
+        }
+    }
+    SECTION("round trip of the uid from build_model") {
+        char uid[33] = "";
+        REQUIRE(build_model(j.c_str(), uid, errmsg, errmsg_length) == 0);
+        CHECK(std::strlen(uid) == 32);
+        double valuid = -1, valhandle = -2;
+        REQUIRE(get_Arxy(uid, 0, 1, T[0], rho[0], &(molefrac[0]), Ncomp, &valuid, errmsg, errmsg_length) == 0);
+        REQUIRE(get_Arxy_handle(static_cast<long long int>(uid_to_handle(uid)), 0, 1, T[0], rho[0], &(molefrac[0]), Ncomp, &valhandle, errmsg, errmsg_length) == 0);
+        CHECK(valuid == valhandle);
+        REQUIRE(free_model(uid, errmsg, errmsg_length) == 0);
+        CHECK(get_Arxy(uid, 0, 1, T[0], rho[0], &(molefrac[0]), Ncomp, &valuid, errmsg, errmsg_length) != 0);
+    }
+    
+    BENCHMARK("PR call w/ handle") {
+        double val = -1;
+        get_Arxy_handle(handle, 0, 1, T[0], rho[0], &(molefrac[0]), Ncomp, &val, errmsg, errmsg_length);
+        return val;
+    };
+    BENCHMARK("PR call w/ handle, batch of 100") {
+        get_Arxy_many(handle, 0, 1, &(T[0]), &(rho[0]), &(molefrac[0]), 1, Ncomp, N, &(vals[0]), errmsg, errmsg_length);
+        return vals[0];
+    };
+    
+    REQUIRE(free_model_handle(handle, errmsg, errmsg_length) == 0);
+}
+TEST_CASE("Concurrent use of the C interface", "[teqpc][threads]") {
+
+    std::string j = R"(
+            {
+                "kind": "PR", 
+                "model": {
+                    "Tcrit / K": [190, 210], 
+                    "pcrit / Pa": [3.5e6, 4.5e6], 
+                    "acentric": [0.11, 0.2]
+                }
+            }
+        )";
+    constexpr int errmsg_length = 300;
+    char errmsg[errmsg_length] = "";
+    long long int handle = -1;
+    REQUIRE(build_model_handle(j.c_str(), &handle, errmsg, errmsg_length) == 0);
+    std::vector<double> molefrac = { 0.3, 0.7 };
+    double expected = -1;
+    REQUIRE(get_Arxy_handle(handle, 0, 1, 300, 100, &(molefrac[0]), 2, &expected, errmsg, errmsg_length) == 0);
+    const auto Nmodels_before = library.size();
+
+    // Each reader thread repeatedly evaluates the shared model while writer threads continually build and free other models
+    auto reader = [&](std::size_t Ncalls) {
+        char errmsg[errmsg_length] = "";
+        std::size_t Nbad = 0;
+        for (auto i = 0U; i < Ncalls; ++i) {
+            double val = -1;
+            int errcode = get_Arxy_handle(handle, 0, 1, 300, 100, &(molefrac[0]), 2, &val, errmsg, errmsg_length);
+            if (errcode != 0 || val != expected) { Nbad++; }
+        }
+        return Nbad;
+    };
+    auto writer = [&](std::size_t Nbuilds) {
+        char errmsg[errmsg_length] = "";
+        std::size_t Nbad = 0;
+        for (auto i = 0U; i < Nbuilds; ++i) {
+            long long int h = -1;
+            double val = -1;
+            if (build_model_handle(j.c_str(), &h, errmsg, errmsg_length) != 0) { Nbad++; continue; }
+            if (get_Arxy_handle(h, 0, 1, 300, 100, &(molefrac[0]), 2, &val, errmsg, errmsg_length) != 0 || val != expected) { Nbad++; }
+            if (free_model_handle(h, errmsg, errmsg_length) != 0) { Nbad++; }
+        }
+        return Nbad;
+    };
+
+    SECTION("stress test with concurrent readers and writers") {
+        std::vector<std::future<std::size_t>> results;
+        for (auto i = 0; i < 8; ++i) {
+            results.emplace_back(std::async(std::launch::async, reader, 20000));
+        }
+        for (auto i = 0; i < 2; ++i) {
+            results.emplace_back(std::async(std::launch::async, writer, 500));
+        }
+        for (auto& r : results) {
+            CHECK(r.get() == 0);
+        }
+        CHECK(library.size() == Nmodels_before);
+    }
+
+    SECTION("throughput") {
+        const std::size_t Ncalls = 10000;
+        for (std::size_t Nthreads : {1, 2, 4, 8}) {
+            BENCHMARK("get_Arxy_handle x " + std::to_string(Ncalls) + " calls on each of " + std::to_string(Nthreads) + " threads") {
+                std::vector<std::future<std::size_t>> results;
+                for (auto i = 0U; i < Nthreads; ++i) {
+                    results.emplace_back(std::async(std::launch::async, reader, Ncalls));
+                }
+                std::size_t Nbad = 0;
+                for (auto& r : results) { Nbad += r.get(); }
+                return Nbad;
+            };
+        }
+    }
+    REQUIRE(free_model_handle(handle, errmsg, errmsg_length) == 0);
+}
+
 #else 
 int main() {
 }
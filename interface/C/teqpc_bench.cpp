@@ -9,6 +9,10 @@
 extern "C" int build_model(const char* j, char* uuid, char* errmsg, int errmsg_length);
 extern "C" int free_model(const char* uid, char* errmsg, int errmsg_length);
 extern "C" int get_Arxy(const char* uid, const int NT, const int ND, const double T, const double rho, const double* molefrac, const int Ncomp, double* val, char* errmsg, int errmsg_length);
+extern "C" int build_model_handle(const char* j, long long int* handle, char* errmsg, int errmsg_length);
+extern "C" int free_model_handle(const long long int handle, char* errmsg, int errmsg_length);
+extern "C" int get_Arxy_handle(const long long int handle, const int NT, const int ND, const double T, const double rho, const double* molefrac, const int Ncomp, double* val, char* errmsg, int errmsg_length);
+extern "C" int get_Arxy_many(const long long int handle, const int NT, const int ND, const double* T, const double* rho, const double* molefrac, const int Nmolefrac_rows, const int Ncomp, const int N, double* vals, char* errmsg, int errmsg_length);
 
 TEST_CASE("teqpc profiling", "[teqpc]")
 {
@@ -55,5 +59,20 @@ TEST_CASE("teqpc profiling", "[teqpc]")
         int errcode2 = get_Arxy(uid, NT, ND, T, rho, &(z[0]), z.size(), &out, errstr, 200);
         return out;
     };
+
+    long long int handle = -1;
+    int errcode3 = build_model_handle(model, &handle, errstr, 200);
+    BENCHMARK("call model w/ handle") {
+        double out = -1;
+        int errcode2 = get_Arxy_handle(handle, NT, ND, T, rho, &(z[0]), z.size(), &out, errstr, 200);
+        return out;
+    };
+    const int N = 1000;
+    std::valarray<double> Ts(T, N), rhos(rho, N), outs(0.0, N);
+    BENCHMARK("call model w/ handle, batch of 1000") {
+        int errcode2 = get_Arxy_many(handle, NT, ND, &(Ts[0]), &(rhos[0]), &(z[0]), 1, z.size(), N, &(outs[0]), errstr, 200);
+        return outs[0];
+    };
+    free_model_handle(handle, errstr, 200);
     
 }
\ No newline at end of file
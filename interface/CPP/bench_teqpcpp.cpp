@@ -45,3 +45,32 @@ TEST_CASE("Benchmark C++ interface", "[C++]")
         return TDXDerivatives<decltype(model1novar)>::get_Arxy<0,1,ADBackends::autodiff>(model1novar, 300, 3, z1);
     }; 
 }
+
+TEST_CASE("Benchmark C++ interface, batched vs. scalar", "[C++]")
+{
+    // Divide the reported times by N to get the per-point cost
+    const std::size_t N = 1000;
+    std::vector<double> T(N, 300.0), rho(N, 3.0), out(N);
+    Eigen::ArrayXXd z(1, 2); z << 0.5, 0.5;
+    Eigen::ArrayXd zvec = z.row(0).transpose();
+
+    nlohmann::json jPR = {
+        {"kind", "PR"},
+        {"model", {{"Tcrit / K", {190, 210}}, {"pcrit / Pa", {3.5e6, 4.5e6}}, {"acentric", {0.01, 0.2}}}}
+    };
+    auto PR = teqp::cppinterface::make_model(jPR);
+    auto multifluid = teqp::cppinterface::make_multifluid_model({ "Methane", "Ethane" }, "../mycp");
+
+    for (auto& [name, model] : { std::make_pair("PR", PR.get()), std::make_pair("multifluid", multifluid.get()) }) {
+        BENCHMARK(std::string(name) + ": Ar01 scalar get_Arxy x " + std::to_string(N)) {
+            for (auto i = 0; i < N; ++i) {
+                out[i] = model->get_Arxy(0, 1, T[i], rho[i], zvec);
+            }
+            return out[0];
+        };
+        BENCHMARK(std::string(name) + ": Ar01 get_Arxy_many x " + std::to_string(N)) {
+            model->get_Arxy_many(0, 1, &(T[0]), &(rho[0]), z, &(out[0]), N);
+            return out[0];
+        };
+    }
+}
@@ -9,6 +9,15 @@ using namespace teqp::cppinterface;
 namespace teqp {
     namespace cppinterface {
 
+        /// Evaluate a batch of Arxy for a given model with the derivative orders known at compile-time
+        template<int iT, int iD, typename Model>
+        void get_Arxy_many_impl(const Model& model, const double* T, const double* rho, const Eigen::ArrayXXd& z, double* out, const std::size_t n) {
+            using tdx = teqp::TDXDerivatives<Model, double, Eigen::ArrayXd>;
+            const Eigen::Map<const Eigen::ArrayXd> Tmap(T, n), rhomap(rho, n);
+            Eigen::Map<Eigen::ArrayXd> outmap(out, n);
+            tdx::template get_Arxy_batch<iT, iD, ADBackends::autodiff>(model, Tmap, rhomap, z, outmap);
+        }
+
         class ModelImplementer : public AbstractModel {
         protected:
             const AllowedModels m_model;
@@ -21,6 +30,50 @@ namespace teqp {
                     return tdx::template get_Ar(NT, ND, model, T, rho, molefracs);
                 }, m_model);
             }
+            void get_Arxy_many(const int NT, const int ND, const double* T, const double* rho, const Eigen::ArrayXXd& z, double* out, const std::size_t n) const override {
+                std::visit([&](const auto& model) {
+                    using Model = std::decay_t<decltype(model)>;
+                    // Same set of derivatives as the runtime switch in TDXDerivatives::get_Ar, but resolved once for the whole batch
+                    if (NT == 0 && ND == 0) { get_Arxy_many_impl<0, 0, Model>(model, T, rho, z, out, n); }
+                    else if (NT == 0 && ND == 1) { get_Arxy_many_impl<0, 1, Model>(model, T, rho, z, out, n); }
+                    else if (NT == 0 && ND == 2) { get_Arxy_many_impl<0, 2, Model>(model, T, rho, z, out, n); }
+                    else if (NT == 1 && ND == 0) { get_Arxy_many_impl<1, 0, Model>(model, T, rho, z, out, n); }
+                    else if (NT == 2 && ND == 0) { get_Arxy_many_impl<2, 0, Model>(model, T, rho, z, out, n); }
+                    else {
+                        throw teqp::InvalidArgument("Invalid combination of NT and ND in get_Arxy_many");
+                    }
+                }, m_model);
+            }
+            void get_pr_many(const double* T, const Eigen::ArrayXXd& rhovecs, double* out, const std::size_t n) const override {
+                if (static_cast<std::size_t>(rhovecs.rows()) != n) {
+                    throw teqp::InvalidArgument("Number of rows in rhovecs must be equal to n in get_pr_many");
+                }
+                std::visit([&](const auto& model) {
+                    using id = teqp::IsochoricDerivatives<std::decay_t<decltype(model)>, double, Eigen::ArrayXd>;
+                    Eigen::ArrayXd rhovec(rhovecs.cols());
+                    for (auto i = 0U; i < n; ++i) {
+                        rhovec = rhovecs.row(i).transpose();
+                        out[i] = id::get_pr(model, T[i], rhovec);
+                    }
+                }, m_model);
+            }
+            void build_Psir_gradient_many(const double* T, const Eigen::ArrayXXd& rhovecs, double* out, const std::size_t n) const override {
+                if (static_cast<std::size_t>(rhovecs.rows()) != n) {
+                    throw teqp::InvalidArgument("Number of rows in rhovecs must be equal to n in build_Psir_gradient_many");
+                }
+                std::visit([&](const auto& model) {
+                    using id = teqp::IsochoricDerivatives<std::decay_t<decltype(model)>, double, Eigen::ArrayXd>;
+                    const auto Ncomp = rhovecs.cols();
+                    Eigen::ArrayXd rhovec(Ncomp);
+                    for (auto i = 0U; i < n; ++i) {
+                        rhovec = rhovecs.row(i).transpose();
+                        auto grad = id::build_Psir_gradient_autodiff(model, T[i], rhovec);
+                        for (auto j = 0; j < Ncomp; ++j) {
+                            out[i*Ncomp + j] = grad[j];
+                        }
+                    }
+                }, m_model);
+            }
             nlohmann::json trace_critical_arclength_binary(const double T0, const Eigen::ArrayXd& rhovec0) const override {
                 return std::visit([&](const auto& model) {
                     using crit = teqp::CriticalTracing<decltype(model), double, std::decay_t<decltype(rhovec0)>>;
@@ -10,6 +10,14 @@ namespace teqp {
         class AbstractModel {
         public:
             virtual double get_Arxy(const int, const int, const double, const double, const Eigen::ArrayXd&) const = 0;
+            /// Evaluate Arxy for n state points, dispatching only once per batch.  The i-th point is given by T[i], rho[i] and
+            /// the i-th row of z (or the only row of z if it has one row); the results are written into out[0...n-1]
+            virtual void get_Arxy_many(const int NT, const int ND, const double* T, const double* rho, const Eigen::ArrayXXd& z, double* out, const std::size_t n) const = 0;
+            /// Residual pressure for n state points; the i-th point is given by T[i] and the i-th row of rhovecs
+            virtual void get_pr_many(const double* T, const Eigen::ArrayXXd& rhovecs, double* out, const std::size_t n) const = 0;
+            /// Gradient of Psir w.r.t. the molar concentrations for n state points; the i-th point is given by T[i] and the 
+            /// i-th row of rhovecs, and its gradient is written into out[i*Ncomp...(i+1)*Ncomp-1] (row-major)
+            virtual void build_Psir_gradient_many(const double* T, const Eigen::ArrayXXd& rhovecs, double* out, const std::size_t n) const = 0;
             virtual nlohmann::json trace_critical_arclength_binary(const double T0, const Eigen::ArrayXd& rhovec0) const = 0;
             virtual ~AbstractModel() = default;
         };
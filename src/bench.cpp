@@ -88,6 +88,12 @@ TEST_CASE("PCSAFT derivatives", "[PCSAFT]")
     /*BENCHMARK("(1/T)*dalphar/d(1/T) w/ mcx") {
         return tdx::get_Ar10<ADBackends::multicomplex>(model, T, rho, z);
     };*/
+    BENCHMARK("Ar01, Ar02, Ar10, Ar11, Ar20 one at a time w/ autodiff") {
+        return tdx::get_Ar01(model, T, rho, z) + tdx::get_Ar02(model, T, rho, z) + tdx::get_Ar10(model, T, rho, z) + tdx::get_Ar11(model, T, rho, z) + tdx::get_Ar20(model, T, rho, z);
+    };
+    BENCHMARK("Ar01, Ar02, Ar10, Ar11, Ar20 in one bundle") {
+        return tdx::get_Ar_bundle<2, 2>(model, T, rho, z).sum();
+    };
 }
 
 
@@ -0,0 +1,63 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/models/vdW.hpp"
+#include "teqp/models/pcsaft.hpp"
+#include "teqp/models/cubics.hpp"
+#include "teqp/models/multifluid.hpp"
+
+#include "teqp/derivs.hpp"
+
+using namespace teqp;
+
+/// Compare a point-by-point loop over get_Arxy with the batched evaluation, with and without threads
+template<typename Model>
+void bench_batch(const Model& model, const Eigen::ArrayXd& z0, const std::string& name) {
+    const std::size_t N = 10000;
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 250, 350), rho = Eigen::ArrayXd::LinSpaced(N, 1, 1000);
+    Eigen::ArrayXXd z = z0.transpose().replicate(N, 1);
+    Eigen::ArrayXd out(N);
+    using tdx = TDXDerivatives<Model>;
+
+    BENCHMARK(name + ": loop of get_Ar01 (" + std::to_string(N) + " points)") {
+        Eigen::ArrayXd molefrac = z0;
+        for (auto i = 0; i < N; ++i) {
+            molefrac = z.row(i).transpose();
+            out[i] = tdx::get_Ar01(model, T[i], rho[i], molefrac);
+        }
+        return out.sum();
+    };
+    BENCHMARK(name + ": get_Arxy_batch<0,1>, 1 thread") {
+        tdx::template get_Arxy_batch<0, 1>(model, T, rho, z, out, 1);
+        return out.sum();
+    };
+    BENCHMARK(name + ": get_Arxy_batch<0,1>, all threads") {
+        tdx::template get_Arxy_batch<0, 1>(model, T, rho, z, out, 0);
+        return out.sum();
+    };
+    BENCHMARK(name + ": get_Arxy_batch<0,1>, fixed composition, all threads") {
+        Eigen::ArrayXXd zfixed = z0.transpose();
+        tdx::template get_Arxy_batch<0, 1>(model, T, rho, zfixed, out, 0);
+        return out.sum();
+    };
+}
+
+TEST_CASE("Batched Arxy evaluation", "[batch]")
+{
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    SECTION("vdW") {
+        std::valarray<double> Tc_K = { 150.687, 289.733 }, pc_Pa = { 4863000.0, 5842000.0 };
+        bench_batch(vdWEOS<double>(Tc_K, pc_Pa), z, "vdW");
+    }
+    SECTION("PR") {
+        std::valarray<double> Tc_K = { 190.564, 154.581 }, pc_Pa = { 4599200, 5042800 }, acentric = { 0.011, 0.022 };
+        bench_batch(canonical_PR(Tc_K, pc_Pa, acentric), z, "PR");
+    }
+    SECTION("PCSAFT") {
+        std::vector<std::string> names = { "Methane", "Ethane" };
+        bench_batch(PCSAFT::PCSAFTMixture(names), z, "PCSAFT");
+    }
+    SECTION("multifluid") {
+        bench_batch(build_multifluid_model({ "Methane", "Ethane" }, "../mycp"), z, "multifluid");
+    }
+}
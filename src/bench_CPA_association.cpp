@@ -0,0 +1,138 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "teqp/derivs.hpp"
+#include "teqp/models/CPA.hpp"
+
+using namespace teqp;
+
+auto build_water_methanol_MEG() {
+    nlohmann::json water = {
+        {"a0i / Pa m^6/mol^2", 0.12277}, {"bi / m^3/mol", 0.000014515}, {"c1", 0.67359}, {"Tc / K", 647.096},
+        {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"class", "4C"}
+    };
+    nlohmann::json methanol = {
+        {"a0i / Pa m^6/mol^2", 0.40531}, {"bi / m^3/mol", 0.000030978}, {"c1", 0.43102}, {"Tc / K", 512.64},
+        {"epsABi / J/mol", 24591.0}, {"betaABi", 0.0161}, {"class", "2B"}
+    };
+    nlohmann::json MEG = {
+        {"a0i / Pa m^6/mol^2", 1.0810}, {"bi / m^3/mol", 0.0000514}, {"c1", 0.6744}, {"Tc / K", 720.0},
+        {"epsABi / J/mol", 19752.0}, {"betaABi", 0.0141}, {"class", "4C"}
+    };
+    nlohmann::json j = { {"cubic", "SRK"}, {"pures", {water, methanol, MEG}}, {"R_gas / J/mol/K", 8.3144598} };
+    return CPA::CPAfactory(j);
+}
+
+/// The site fractions by plain successive substitution, the reference for the Newton solver; returns the number of iterations
+template<typename DeltaType>
+int XA_fixed_point(const DeltaType& Delta, const Eigen::ArrayXd& xsite, double rhomolar, Eigen::ArrayXd& X) {
+    X.setOnes();
+    Eigen::ArrayXd Xnew(X.size());
+    for (auto iter = 1; iter <= 10000; ++iter) {
+        Xnew = 1.0 / (1.0 + rhomolar * (Delta.matrix() * (xsite * X).matrix()).array());
+        auto change = (Xnew - X).abs().maxCoeff();
+        X = Xnew;
+        if (change < 1e-14) { return iter; }
+    }
+    return -1;
+}
+
+TEST_CASE("Site fractions of water + methanol + MEG", "[CPA][association]")
+{
+    auto model = build_water_methanol_MEG();
+    const double T = 350.0;
+    const Eigen::ArrayXd z = (Eigen::ArrayXd(3) << 0.5, 0.3, 0.2).finished();
+    const auto n = model.assoc.get_N_sites_total();
+
+    for (double rhomolar : { 10.0, 5000.0, 30000.0 }) {
+        Eigen::ArrayXXd Delta(n, n);
+        Eigen::ArrayXd xsite(n), Xfp(n), Xd(n), X(n);
+        model.assoc.build_Delta_sites(T, rhomolar, z, Delta, xsite);
+
+        auto iter_fp = XA_fixed_point(Delta, xsite, rhomolar, Xfp);
+        auto iter_cold = CPA::XA_calc_mixture(Delta, xsite, rhomolar, Xd, false, X);
+        // Start from the solution 1% lower in density, as in a solver loop
+        Eigen::ArrayXXd Delta1(n, n);
+        Eigen::ArrayXd xsite1(n);
+        model.assoc.build_Delta_sites(T, 0.99 * rhomolar, z, Delta1, xsite1);
+        CPA::XA_calc_mixture(Delta1, xsite1, 0.99 * rhomolar, Xd, false, X);
+        const Eigen::ArrayXd Xstart = Xd;
+        auto iter_warm = CPA::XA_calc_mixture(Delta, xsite, rhomolar, Xd, true, X);
+
+        std::cout << "rho = " << rhomolar << " mol/m^3: iterations: fixed point " << iter_fp << "; Newton, cold start " << iter_cold
+            << "; Newton, warm start " << iter_warm << "; max. difference " << (X - Xfp).abs().maxCoeff() << std::endl;
+
+        auto label = " (rho = " + std::to_string(rhomolar) + ")";
+        BENCHMARK("fixed point" + label) {
+            return XA_fixed_point(Delta, xsite, rhomolar, Xfp);
+        };
+        BENCHMARK("Newton, cold start" + label) {
+            return CPA::XA_calc_mixture(Delta, xsite, rhomolar, Xd, false, X);
+        };
+        BENCHMARK("Newton, warm start" + label) {
+            Xd = Xstart;
+            return CPA::XA_calc_mixture(Delta, xsite, rhomolar, Xd, true, X);
+        };
+    }
+
+    const double rhomolar = 30000.0;
+    using tdx = TDXDerivatives<decltype(model)>;
+    BENCHMARK("alphar") {
+        return model.alphar(T, rhomolar, z);
+    };
+    BENCHMARK("get_Ar01") {
+        return tdx::get_Ar01(model, T, rhomolar, z);
+    };
+    BENCHMARK("get_Ar02") {
+        return tdx::get_Ar02(model, T, rhomolar, z);
+    };
+}
+
+TEST_CASE("Warm starts of the site fractions along the iterations of a bubble-point solver", "[CPA][association]")
+{
+    auto model = build_water_methanol_MEG();
+    const auto& assoc = model.assoc;
+    const auto n = assoc.get_N_sites_total();
+    const Eigen::ArrayXd x = (Eigen::ArrayXd(3) << 0.5, 0.3, 0.2).finished();
+
+    // The liquid and the vapor are evaluated in turn, and the temperature and the vapor composition change in each iteration
+    struct StatePoint { double T, rhomolar; Eigen::ArrayXd z; };
+    std::vector<StatePoint> points;
+    for (auto k = 0; k < 20; ++k) {
+        double T = 350 + 5.0 * std::exp(-0.5 * k);
+        Eigen::ArrayXd y = (Eigen::ArrayXd(3) << 0.8 + 0.1 * std::exp(-0.5 * k), 0.19 - 0.1 * std::exp(-0.5 * k), 0.01).finished();
+        points.push_back({ T, 30000.0 - 50.0 * std::exp(-0.5 * k), x });
+        points.push_back({ T, 40.0 + 5.0 * std::exp(-0.5 * k), y });
+    }
+
+    /// The total number of iterations over the state points; with a store, each solution starts from the closest stored one
+    auto total_iterations = [&](CPA::XAWarmStart* warm) {
+        int total = 0;
+        Eigen::ArrayXXd Delta(n, n);
+        Eigen::ArrayXd xsite(n), Xd(n), X(n);
+        for (const auto& pt : points) {
+            assoc.build_Delta_sites(pt.T, pt.rhomolar, pt.z, Delta, xsite);
+            bool start_given = warm != nullptr && warm->find(&assoc, pt.T, pt.rhomolar, pt.z, Xd);
+            total += CPA::XA_calc_mixture(Delta, xsite, pt.rhomolar, Xd, start_given, X);
+            if (warm != nullptr) { warm->store(&assoc, pt.T, pt.rhomolar, pt.z, Xd); }
+        }
+        return total;
+    };
+    CPA::XAWarmStart exact, tolerant;
+    exact.T_reltol = 0; exact.molefrac_abstol = 0;
+    std::cout << points.size() << " state points: iterations: cold start " << total_iterations(nullptr)
+        << "; warm start, exact temperature and composition " << total_iterations(&exact)
+        << "; warm start, default tolerances " << total_iterations(&tolerant) << std::endl;
+
+    BENCHMARK("cold start") {
+        return total_iterations(nullptr);
+    };
+    BENCHMARK("warm start, default tolerances") {
+        tolerant.clear();
+        return total_iterations(&tolerant);
+    };
+}
@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/models/pcsaft.hpp"
+#include "teqp/derivs.hpp"
+#include "tests/PCSAFT_fixtures.hpp"
+
+using namespace teqp;
+using namespace teqp::PCSAFT;
+
+TEST_CASE("PC-SAFT mixtures with many components", "[PCSAFT][bind]")
+{
+    double T = 300;
+    Eigen::ArrayXd rhos = Eigen::ArrayXd::LinSpaced(100, 1, 10000);
+    for (auto N : { 2, 10, 20, 40 }) {
+        auto model = fixtures::alkane_like_mixture(N);
+        Eigen::ArrayXd z = Eigen::ArrayXd::Constant(N, 1.0 / N);
+        Eigen::ArrayXd rhovec = 3000.0 * z;
+        auto bound = model.bind(T, z);
+        using tdx = TDXDerivatives<decltype(model)>;
+        using tdxb = TDXDerivatives<decltype(bound)>;
+        using id = IsochoricDerivatives<decltype(model)>;
+        auto name = std::to_string(N) + " components";
+
+        BENCHMARK(name + ": alphar") {
+            return model.alphar(T, 3000.0, z);
+        };
+        BENCHMARK(name + ": get_Ar11") {
+            return tdx::get_Ar11(model, T, 3000.0, z);
+        };
+        BENCHMARK(name + ": build_Psir_Hessian_autodiff") {
+            return id::build_Psir_Hessian_autodiff(model, T, rhovec);
+        };
+        BENCHMARK(name + ": bind") {
+            return model.bind(T, z).T;
+        };
+        BENCHMARK(name + ": 100 x Ar0n<2>") {
+            double o = 0;
+            for (auto rho : rhos) { o += tdx::get_Ar0n<2>(model, T, rho, z)[2]; }
+            return o;
+        };
+        BENCHMARK(name + ": 100 x Ar0n<2>, bound") {
+            double o = 0;
+            for (auto rho : rhos) { o += tdxb::get_Ar0n<2>(bound, T, rho, z)[2]; }
+            return o;
+        };
+    }
+}
@@ -0,0 +1,62 @@
+// Must come first, see the header
+#include "tests/allocations/allocation_counting.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include <iostream>
+#include <string>
+
+#include "teqp/derivs.hpp"
+#include "teqp/arena.hpp"
+#include "teqp/models/pcsaft.hpp"
+#include "teqp/models/CPA.hpp"
+
+using namespace teqp;
+
+/// The heap allocations made in one call of f, as "<with new> new + <in Eigen> Eigen"
+template<typename Function>
+std::string count_allocations(const Function& f) {
+    auto counts = allocation_counting::count_allocations(f);
+    return std::to_string(counts.new_calls) + " new + " + std::to_string(counts.eigen_mallocs) + " Eigen";
+}
+
+/// Report the allocations of the first evaluation (when the arena of the thread may need to grow) and of the following ones
+template<typename Model>
+void report(const Model& model, double T, double rho, const Eigen::ArrayXd& z, const std::string& name) {
+    using tdx = TDXDerivatives<Model>;
+    auto blocks_before = thread_arena().heap_allocations();
+    std::cout << name << ": allocations in the first alphar: " << count_allocations([&]() { model.alphar(T, rho, z); }) << std::endl;
+    std::cout << name << ": allocations in the next alphar: " << count_allocations([&]() { model.alphar(T, rho, z); }) << std::endl;
+    std::cout << name << ": allocations in get_Ar02 (dual2nd): " << count_allocations([&]() { tdx::get_Ar02(model, T, rho, z); }) << std::endl;
+    std::cout << name << ": allocations in get_Ar0n<4> (Real<4>): " << count_allocations([&]() { tdx::template get_Ar0n<4>(model, T, rho, z); }) << std::endl;
+    std::cout << name << ": blocks allocated by the arena: " << thread_arena().heap_allocations() - blocks_before << ", holding " << thread_arena().capacity() << " bytes" << std::endl;
+
+    BENCHMARK(name + ": alphar") {
+        return model.alphar(T, rho, z);
+    };
+    BENCHMARK(name + ": get_Ar02") {
+        return tdx::get_Ar02(model, T, rho, z);
+    };
+    BENCHMARK(name + ": get_Ar0n<4>") {
+        return tdx::template get_Ar0n<4>(model, T, rho, z);
+    };
+}
+
+TEST_CASE("Allocations in the evaluation of alphar", "[arena]")
+{
+    SECTION("PC-SAFT") {
+        std::vector<std::string> names = { "Methane", "Ethane" };
+        auto model = PCSAFT::PCSAFTMixture(names);
+        report(model, 200.0, 3000.0, (Eigen::ArrayXd(2) << 0.3, 0.7).finished(), "PC-SAFT");
+    }
+    SECTION("CPA") {
+        nlohmann::json water = {
+            {"a0i / Pa m^6/mol^2",0.12277 }, {"bi / m^3/mol", 0.000014515}, {"c1", 0.67359}, {"Tc / K", 647.096},
+            {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"class","4C"}
+        };
+        nlohmann::json j = { {"cubic","SRK"}, {"pures", {water}}, {"R_gas / J/mol/K", 8.3144598} };
+        auto model = CPA::CPAfactory(j);
+        report(model, 400.0, 100.0, (Eigen::ArrayXd(1) << 1.0).finished(), "CPA");
+    }
+}
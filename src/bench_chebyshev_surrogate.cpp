@@ -0,0 +1,53 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+#include "teqp/models/pcsaft.hpp"
+#include "teqp/models/chebyshev_surrogate.hpp"
+#include "teqp/derivs.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Chebyshev surrogate of a PC-SAFT mixture", "[surrogate]")
+{
+    std::vector<std::string> names = { "Methane", "Ethane", "Propane" };
+    auto model = PCSAFT::PCSAFTMixture(names);
+    const Eigen::ArrayXd z = (Eigen::ArrayXd(3) << 0.85, 0.1, 0.05).finished();
+    const double Tmin = 250, Tmax = 350, rhomin = 0, rhomax = 12000;
+
+    auto surrogate = build_Chebyshev_surrogate(model, z, Tmin, Tmax, rhomin, rhomax);
+    const auto& e = surrogate.get_errors();
+    auto tails = surrogate.get_tails();
+    std::cout << surrogate.get_N_coeffs() << " coefficients; largest deviations at the check points: Ar00 " << e.Ar00 << ", Ar01 " << e.Ar01 << ", Ar10 " << e.Ar10
+        << ", Ar02 " << e.Ar02 << ", Ar11 " << e.Ar11 << ", Ar20 " << e.Ar20 << "; largest tail coefficient " << *std::max_element(tails.begin(), tails.end()) << std::endl;
+
+    const double T = 300, rho = 7000;
+    using tdx = TDXDerivatives<decltype(model)>;
+    using tdxs = TDXDerivatives<decltype(surrogate)>;
+    BENCHMARK("build") {
+        return build_Chebyshev_surrogate(model, z, Tmin, Tmax, rhomin, rhomax).get_N_coeffs();
+    };
+    BENCHMARK("model: alphar") {
+        return model.alphar(T, rho, z);
+    };
+    BENCHMARK("surrogate: alphar") {
+        return surrogate.alphar(T, rho, z);
+    };
+    BENCHMARK("model: get_Ar0n<2>") {
+        return tdx::get_Ar0n<2>(model, T, rho, z);
+    };
+    BENCHMARK("surrogate: get_Ar0n<2>") {
+        return tdxs::get_Ar0n<2>(surrogate, T, rho, z);
+    };
+    BENCHMARK("surrogate: get_Ar0n<2>, analytic") {
+        return tdxs::get_Ar0n<2, ADBackends::analytic>(surrogate, T, rho, z);
+    };
+    BENCHMARK("model: get_Ar11") {
+        return tdx::get_Ar11(model, T, rho, z);
+    };
+    BENCHMARK("surrogate: get_Ar11") {
+        return tdxs::get_Ar11(surrogate, T, rho, z);
+    };
+}
@@ -0,0 +1,54 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/models/cubics.hpp"
+#include "teqp/derivs.hpp"
+
+using namespace teqp;
+
+/// A Peng-Robinson mixture of N made-up pseudo-components, as in the characterization of a petroleum fraction
+auto make_pseudocomponents(int N, bool with_kij) {
+    std::valarray<double> Tc_K(N), pc_Pa(N), acentric(N);
+    for (auto i = 0; i < N; ++i) {
+        Tc_K[i] = 300.0 + 8.0 * i;
+        pc_Pa[i] = 4.5e6 - 3.0e4 * i;
+        acentric[i] = 0.1 + 0.01 * i;
+    }
+    Eigen::ArrayXXd kmat = Eigen::ArrayXXd::Zero(N, N);
+    if (with_kij) {
+        kmat.setConstant(0.01);
+        kmat.matrix().diagonal().setZero();
+    }
+    return canonical_PR(Tc_K, pc_Pa, acentric, kmat);
+}
+
+TEST_CASE("Cubic mixtures with many components", "[cubic]")
+{
+    double T = 400, rho = 3000;
+    for (auto N : { 2, 10, 50, 100 }) {
+        for (auto with_kij : { false, true }) {
+            auto model = make_pseudocomponents(N, with_kij);
+            Eigen::ArrayXd z = Eigen::ArrayXd::Constant(N, 1.0 / N);
+            Eigen::ArrayXd rhovec = rho * z;
+            using tdx = TDXDerivatives<decltype(model)>;
+            using id = IsochoricDerivatives<decltype(model)>;
+            auto name = std::to_string(N) + " components, " + (with_kij ? "with kij" : "no kij");
+
+            BENCHMARK(name + ": get_a") {
+                return model.get_a(T, z);
+            };
+            BENCHMARK(name + ": alphar") {
+                return model.alphar(T, rho, z);
+            };
+            BENCHMARK(name + ": get_Ar02") {
+                return tdx::get_Ar02(model, T, rho, z);
+            };
+            BENCHMARK(name + ": get_Ar20") {
+                return tdx::get_Ar20(model, T, rho, z);
+            };
+            BENCHMARK(name + ": build_Psir_gradient_autodiff") {
+                return id::build_Psir_gradient_autodiff(model, T, rhovec);
+            };
+        }
+    }
+}
@@ -0,0 +1,67 @@
+// Must come first, see the header
+#include "tests/allocations/allocation_counting.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include <iostream>
+
+#include "teqp/models/vdW.hpp"
+#include "teqp/models/cubics.hpp"
+#include "teqp/derivs.hpp"
+#include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/critical_tracing.hpp"
+
+using namespace teqp;
+
+/// True if one call of f makes no heap allocations, neither with new nor in Eigen
+template<typename Function>
+bool is_allocation_free(const Function& f) {
+    return allocation_counting::count_allocations(f).total() == 0;
+}
+
+/// Compare the evaluations for a binary mixture with fixed-size (Eigen::Array2d) and dynamic (Eigen::ArrayXd) arrays
+template<typename Model, typename VecType>
+void bench_binary(const Model& model, double T, const VecType& rhovec, const std::string& name) {
+    using id = IsochoricDerivatives<Model, double, VecType>;
+    using ct = CriticalTracing<Model, double, VecType>;
+
+    std::cout << std::boolalpha;
+    std::cout << name << ": build_Psir_Hessian_autodiff is allocation-free: " << is_allocation_free([&]() { id::build_Psir_Hessian_autodiff(model, T, rhovec); }) << std::endl;
+    std::cout << name << ": build_Psir_fgradHessian_autodiff is allocation-free: " << is_allocation_free([&]() { id::build_Psir_fgradHessian_autodiff(model, T, rhovec); }) << std::endl;
+    std::cout << name << ": eigen_problem is allocation-free: " << is_allocation_free([&]() { ct::eigen_problem(model, T, rhovec); }) << std::endl;
+
+    BENCHMARK(name + ": build_Psir_Hessian_autodiff") {
+        return id::build_Psir_Hessian_autodiff(model, T, rhovec);
+    };
+    BENCHMARK(name + ": build_Psir_fgradHessian_autodiff") {
+        return id::build_Psir_fgradHessian_autodiff(model, T, rhovec);
+    };
+    BENCHMARK(name + ": build_Psir_gradient_autodiff") {
+        return id::build_Psir_gradient_autodiff(model, T, rhovec);
+    };
+    BENCHMARK(name + ": eigen_problem") {
+        return ct::eigen_problem(model, T, rhovec);
+    };
+    BENCHMARK(name + ": get_drhovec_dT_crit") {
+        return ct::get_drhovec_dT_crit(model, T, rhovec);
+    };
+}
+
+TEST_CASE("Binary mixtures with fixed-size arrays", "[fixedsize]")
+{
+    const Eigen::ArrayXd rhovecX = (Eigen::ArrayXd(2) << 3000.0, 5000.0).finished();
+    const Eigen::Array2d rhovec2 = rhovecX;
+    SECTION("vdW") {
+        std::valarray<double> Tc_K = { 150.687, 289.733 }, pc_Pa = { 4863000.0, 5842000.0 };
+        vdWEOS<double> model(Tc_K, pc_Pa);
+        bench_binary(model, 300.0, rhovec2, "vdW, Array2d");
+        bench_binary(model, 300.0, rhovecX, "vdW, ArrayXd");
+    }
+    SECTION("PR") {
+        std::valarray<double> Tc_K = { 190.564, 154.581 }, pc_Pa = { 4599200, 5042800 }, acentric = { 0.011, 0.022 };
+        auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+        bench_binary(model, 150.0, rhovec2, "PR, Array2d");
+        bench_binary(model, 150.0, rhovecX, "PR, ArrayXd");
+    }
+}
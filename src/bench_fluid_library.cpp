@@ -0,0 +1,33 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/models/multifluid.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Construction of multifluid models", "[library]")
+{
+    std::string root = "../mycp";
+    std::vector<std::string> names = { "Methane", "Ethane" }, aliases = { "74-82-8", "ETHANE" };
+    
+    BENCHMARK("Build from files, by name") {
+        return build_multifluid_model(names, root);
+    };
+    BENCHMARK("Build from files, by alias") {
+        return build_multifluid_model(aliases, root);
+    };
+    BENCHMARK("Load the fluid library") {
+        return FluidLibrary(root).size();
+    };
+    const FluidLibrary library(root);
+    library.to_binary("fluid_library.cbor");
+    BENCHMARK("Load the fluid library from the binary file") {
+        return FluidLibrary::from_binary("fluid_library.cbor").size();
+    };
+    BENCHMARK("Build from the fluid library, by name") {
+        return build_multifluid_model(names, library);
+    };
+    BENCHMARK("Build from the fluid library, by alias") {
+        return build_multifluid_model(aliases, library);
+    };
+}
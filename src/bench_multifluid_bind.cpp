@@ -0,0 +1,42 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/models/multifluid.hpp"
+#include "teqp/derivs.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Density-only evaluation of a bound multifluid model", "[multifluid][bind]")
+{
+    auto model = build_multifluid_model({ "Methane", "Ethane", "Propane", "Nitrogen", "CarbonDioxide" }, "../mycp");
+    auto z = (Eigen::ArrayXd(5) << 0.8, 0.08, 0.04, 0.05, 0.03).finished();
+    double T = 250;
+    auto bound = model.bind(T, z);
+    using tdx = TDXDerivatives<decltype(model), double, Eigen::ArrayXd>;
+    using tdxb = TDXDerivatives<decltype(bound), double, Eigen::ArrayXd>;
+    Eigen::ArrayXd rhos = Eigen::ArrayXd::LinSpaced(100, 1, 15000);
+
+    BENCHMARK("bind") {
+        return model.bind(T, z).tau;
+    };
+    BENCHMARK("100 x alphar") {
+        double o = 0;
+        for (auto rho : rhos) { o += model.alphar(T, rho, z); }
+        return o;
+    };
+    BENCHMARK("100 x alphar, bound") {
+        double o = 0;
+        for (auto rho : rhos) { o += bound.alphar(rho); }
+        return o;
+    };
+    BENCHMARK("100 x Ar0n<2>") {
+        double o = 0;
+        for (auto rho : rhos) { o += tdx::get_Ar0n<2>(model, T, rho, z)[2]; }
+        return o;
+    };
+    BENCHMARK("100 x Ar0n<2>, bound") {
+        double o = 0;
+        for (auto rho : rhos) { o += tdxb::get_Ar0n<2>(bound, T, rho, z)[2]; }
+        return o;
+    };
+}
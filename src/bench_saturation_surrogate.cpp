@@ -0,0 +1,48 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include <iostream>
+
+#include "teqp/models/multifluid.hpp"
+#include "teqp/models/multifluid_ancillaries.hpp"
+#include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/saturation_surrogate.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Saturation surrogates of multifluid pure fluids", "[surrogate]")
+{
+    for (std::string name : { "Methane", "n-Propane", "Water" }) {
+        auto model = build_multifluid_model({ name }, "../mycp");
+        auto jancillaries = nlohmann::json::parse(model.get_meta()).at("pures")[0].at("ANCILLARIES");
+        MultiFluidVLEAncillaries anc(jancillaries);
+        const double Tc = anc.rhoL.T_r, rhoc = anc.rhoL.reducing_value, Tmin = anc.rhoL.Tmin;
+
+        auto wrapped = with_saturation_surrogate(model, Tmin, Tc, rhoc);
+        const auto& surrogate = wrapped.surrogate;
+        std::cout << name << ": " << surrogate.get_N_intervals() << " intervals; estimated relative error " << surrogate.rtol_achieved << std::endl;
+
+        // The largest deviation of the surrogate from the saturation states solved from the ancillaries
+        double worst = 0;
+        for (double T = Tmin; T < surrogate.Tmax; T += (surrogate.Tmax - Tmin) / 97) {
+            auto rhos = pure_VLE_T(model, T, anc.rhoL(T), anc.rhoV(T), 20);
+            auto [rhoL, rhoV] = surrogate.rhoLV(T);
+            worst = std::max({ worst, std::abs(rhoL / rhos[0] - 1), std::abs(rhoV / rhos[1] - 1) });
+        }
+        std::cout << name << ": largest relative deviation of the densities " << worst << std::endl;
+
+        const double T = 0.8 * Tc;
+        BENCHMARK(name + ": build") {
+            return build_saturation_surrogate(model, Tmin, Tc, rhoc).get_N_intervals();
+        };
+        BENCHMARK(name + ": pure_VLE_T from the ancillaries") {
+            return pure_VLE_T(model, T, anc.rhoL(T), anc.rhoV(T), 10);
+        };
+        BENCHMARK(name + ": surrogate") {
+            return surrogate.rhoLV(T);
+        };
+        BENCHMARK(name + ": pure_VLE_T_superanc of the model with the surrogate") {
+            return pure_VLE_T_superanc(wrapped, T, 10);
+        };
+    }
+}
@@ -0,0 +1,42 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/benchmark/catch_benchmark_all.hpp>
+
+#include "teqp/json_builder.hpp"
+#include "teqp/serialization.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Build models from JSON or restore them from the binary format", "[serialization]")
+{
+    std::string root = "../mycp";
+    nlohmann::json spec = {
+        {"kind", "multifluid"},
+        {"model", {
+            {"components", {root + "/dev/fluids/Methane.json", root + "/dev/fluids/Ethane.json", root + "/dev/fluids/n-Propane.json", root + "/dev/fluids/CarbonDioxide.json"}},
+            {"BIP", root + "/dev/mixtures/mixture_binary_pairs.json"},
+            {"departure", root + "/dev/mixtures/mixture_departure_functions.json"}
+        }}
+    };
+    // The model where all the JSON data have already been loaded from file
+    nlohmann::json specloaded = spec;
+    for (auto& c : specloaded["model"]["components"]) { c = load_a_JSON_file(c); }
+    specloaded["model"]["BIP"] = load_a_JSON_file(specloaded["model"]["BIP"]);
+    specloaded["model"]["departure"] = load_a_JSON_file(specloaded["model"]["departure"]);
+
+    const auto model = build_model(spec);
+    const auto blob = model_to_binary(model);
+    const auto blobsize = " (" + std::to_string(blob.size()) + " bytes)";
+
+    BENCHMARK("multifluid: build from JSON files") {
+        return build_model(spec);
+    };
+    BENCHMARK("multifluid: build from loaded JSON") {
+        return build_model(specloaded);
+    };
+    BENCHMARK("multifluid: restore from binary" + blobsize) {
+        return model_from_binary(blob);
+    };
+    BENCHMARK("multifluid: store to binary" + blobsize) {
+        return model_to_binary(model);
+    };
+}
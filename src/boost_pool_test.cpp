@@ -56,31 +56,25 @@ int evaluation() {
     auto rhovecL = (Eigen::ArrayXd(2) << 0.0, 55174.92375117).finished();
     auto rhovecV = (Eigen::ArrayXd(2) << 0.0, 2.20225704).finished();
     
-    using MultiFluid = decltype(teqp::build_multifluid_model(std::vector<std::string>{"", ""}, "", ""));
-    std::vector<MultiFluid> models(60, teqp::build_multifluid_model({ "CarbonDioxide", "Water" }, "../mycp"));
-    std::vector<std::string> outputs(models.size());
+    // One model is shared (read-only) by all the tasks; evaluation of the model is re-entrant
+    const auto model = teqp::build_multifluid_model({ "CarbonDioxide", "Water" }, "../mycp");
+    const std::size_t Ntasks = 60;
+    std::vector<std::string> outputs(Ntasks);
 
     auto serial = [&]() {
-        std::size_t i = 0;
-        for (auto& model : models) {
-            using TDX = teqp::TDXDerivatives<decltype(model)>;
+        for (auto i = 0U; i < Ntasks; ++i) {
             outputs[i] = teqp::trace_VLE_isotherm_binary(model, T, rhovecL, rhovecV).dump();
-            i++;
         }
     };
     auto parallel = [&]() {
         // Launch the pool with four threads.
         boost::asio::thread_pool pool(4);
 
-        std::size_t i = 0;
-        for (auto& model : models) {
-            auto& o = outputs[i];
+        for (auto& o : outputs) {
             // Submit a lambda object to the pool.
             boost::asio::post(pool, [&model, &o, &T, &rhovecL, &rhovecV]() {
-                using TDX = teqp::TDXDerivatives<decltype(model)>;
                 o = teqp::trace_VLE_isotherm_binary(model, T, rhovecL, rhovecV).dump();
             });
-            i++;
         }
 
         // Wait for all tasks in the pool to complete.
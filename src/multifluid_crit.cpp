@@ -12,21 +12,16 @@ void trace_critical_loci(const std::string &coolprop_root, const nlohmann::json
        { "R1234YF","R1234ZE(E)" }, { "R134A","R1234YF" }, { "R23","R1234YF" }, 
        { "R32","R1123" }, { "R32","R1234YF" }, { "R32","R1234ZE(E)" }
    };
-   for (auto &pp : pairs) {
-       using ModelType = decltype(build_multifluid_model(pp, coolprop_root, BIPcollection));
-       std::optional<ModelType> optmodel{std::nullopt};
-       try {
-           optmodel.emplace(build_multifluid_model(pp, coolprop_root, BIPcollection));
-       }
-       catch (std::exception &e) {
-           std::cout << e.what() << std::endl;
-           std::cout << pp[0] << "&" << pp[1] << std::endl;
-           continue;
-       }
+   using ModelType = decltype(build_multifluid_model(pairs[0], coolprop_root, BIPcollection));
+
+   // Build the model for a pair and the starting points at both pure fluid ends; this is 
+   // called concurrently for the pairs, and a pair that cannot be built is reported in the results
+   auto make_jobs = [&](const std::vector<std::string>& pp) {
+       auto model = std::make_shared<const ModelType>(build_multifluid_model(pp, coolprop_root, BIPcollection));
+       std::vector<CriticalTraceJob<ModelType>> jobs;
        for (int i : {0, 1}){
-           const auto &model = optmodel.value();
-           auto rhoc0 = 1.0 / model.redfunc.vc[i];
-           auto T0 = model.redfunc.Tc[i];
+           auto rhoc0 = 1.0 / model->redfunc.vc[i];
+           auto T0 = model->redfunc.Tc[i];
            Eigen::ArrayXd rhovec(2); rhovec[i] = { rhoc0 }; rhovec[1L - i] = 0.0;
 
            using ct = CriticalTracing<ModelType>;
@@ -42,14 +37,26 @@ void trace_critical_loci(const std::string &coolprop_root, const nlohmann::json
                    rhovec[1L - i] = 1.0001;
                }
                double zi = rhovec[i] / rhovec.sum();
-               double T = zi * model.redfunc.Tc[i] + (1 - zi) * model.redfunc.Tc[1L - i];
+               double T = zi * model->redfunc.Tc[i] + (1 - zi) * model->redfunc.Tc[1L - i];
                double z0 = (i == 0) ? zi : 1-zi;
-               auto [Tnew, rhonew] = ct::critical_polish_molefrac(model, T, rhovec, z0);
+               auto [Tnew, rhonew] = ct::critical_polish_fixedmolefrac(*model, T, rhovec, z0);
                T0 = Tnew;
-               rhoc0 = rhovec.sum();
+               rhovec = rhonew;
            }
-           std::string filename = pp[0] + "_" + pp[1] + ".csv";
-           ct::trace_critical_arclength_binary(model, T0, rhovec, filename);
+           // One file per trace since the traces are carried out concurrently
+           std::string filename = pp[0] + "_" + pp[1] + "_" + std::to_string(i) + ".csv";
+           jobs.push_back({ pp[0] + "&" + pp[1], model, T0, rhovec, filename });
+       }
+       return jobs;
+   };
+   auto results = trace_critical_arclength_binary_batch(pairs, make_jobs);
+   for (const auto& result : results) {
+       const auto& pp = pairs[result.index];
+       if (!result.success) {
+           std::cout << pp[0] << "&" << pp[1] << ": " << result.message << std::endl;
+       }
+       else {
+           std::cout << result.label << ": " << result.trace.size() << " points" << std::endl;
        }
    }
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+// Made-up PC-SAFT mixtures with many components, shared by the tests and the benchmarks
+
+#include <string>
+#include <vector>
+
+#include "teqp/models/pcsaft.hpp"
+
+namespace teqp::PCSAFT::fixtures {
+
+/// The coefficients of N n-alkane-like components, heavier with increasing index
+inline std::vector<SAFTCoeffs> alkane_like_coeffs(std::size_t N) {
+    std::vector<SAFTCoeffs> coeffs;
+    for (auto i = 0U; i < N; ++i) {
+        SAFTCoeffs c;
+        c.name = "C" + std::to_string(i + 1);
+        c.m = 1.0 + 0.33 * i;
+        c.sigma_Angstrom = 3.70 + 0.02 * i;
+        c.epsilon_over_k = 150.0 + 10.0 * i;
+        coeffs.push_back(c);
+    }
+    return coeffs;
+}
+
+/// A k_ij matrix with a different value for each ordered pair, so that k_ij != k_ji
+inline Eigen::ArrayXXd asymmetric_kmat(std::size_t N) {
+    const auto n = static_cast<Eigen::Index>(N);
+    Eigen::ArrayXXd kmat = Eigen::ArrayXXd::Zero(n, n);
+    for (auto i = 0; i < n; ++i) {
+        for (auto j = 0; j < n; ++j) {
+            if (i != j) { kmat(i, j) = 0.001 * (i + 2 * j); }
+        }
+    }
+    return kmat;
+}
+
+/// The mixture of the N components of alkane_like_coeffs, with the k_ij of asymmetric_kmat
+inline auto alkane_like_mixture(std::size_t N) {
+    return PCSAFTMixture(alkane_like_coeffs(N), asymmetric_kmat(N));
+}
+
+}
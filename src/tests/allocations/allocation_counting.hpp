@@ -0,0 +1,93 @@
+#pragma once
+
+/**
+ Counting of the heap allocations made by a block of code, for the tests and benchmarks that check that a
+ calculation does not allocate
+
+ Two kinds of allocation are counted:
+ - the calls of the global operator new, which is replaced here (std::vector, std::string, ...)
+ - the allocations of Eigen, which calls std::malloc directly. With EIGEN_RUNTIME_NO_MALLOC, Eigen checks
+   Eigen::internal::is_malloc_allowed() before each of its allocations; while count_allocations runs, allocations
+   are not allowed, and the failed check is counted rather than aborting. Every other Eigen assertion keeps its
+   usual behavior, so real assertion failures are not hidden.
+
+ This header must be included before any other header in the translation unit, since it sets up Eigen. It also
+ defines the replacement of the global operator new, so it is included by one translation unit per executable; the
+ tests that use it are built in their own executable (catch_tests_allocations) for that reason.
+*/
+
+#if defined(EIGEN_WORLD_VERSION)
+#error "allocation_counting.hpp must be included before Eigen"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace allocation_counting {
+
+inline std::atomic<std::size_t> new_count{ 0 };
+inline std::atomic<std::size_t> eigen_count{ 0 };
+
+/// True if the condition of an Eigen assertion is the one of Eigen::internal::check_that_malloc_is_allowed
+constexpr bool is_malloc_check(const char* condition) {
+    constexpr char key[] = "is_malloc_allowed()";
+    for (; *condition != '\0'; ++condition) {
+        std::size_t i = 0;
+        while (key[i] != '\0' && condition[i] == key[i]) {
+            ++i;
+        }
+        if (key[i] == '\0') {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+#define EIGEN_RUNTIME_NO_MALLOC
+#define eigen_assert(x) do { \
+    if constexpr (::allocation_counting::is_malloc_check(#x)) { if (!(x)) { ++::allocation_counting::eigen_count; } } \
+    else { eigen_plain_assert(x); } \
+} while (false)
+
+#include <Eigen/Core>
+
+void* operator new(std::size_t size) {
+    ++allocation_counting::new_count;
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace allocation_counting {
+
+/// The heap allocations made in one call of a function
+struct AllocationCounts {
+    std::size_t new_calls = 0; ///< The calls of the global operator new
+    std::size_t eigen_mallocs = 0; ///< The allocations made by Eigen
+    auto total() const { return new_calls + eigen_mallocs; }
+};
+
+/// Call f and count the heap allocations it makes; not thread-safe, since whether Eigen may allocate is a global setting
+template<typename Function>
+AllocationCounts count_allocations(const Function& f) {
+    // Allocations are allowed again even if f throws
+    struct Forbid {
+        Forbid() { Eigen::internal::set_is_malloc_allowed(false); }
+        ~Forbid() { Eigen::internal::set_is_malloc_allowed(true); }
+    };
+    auto new0 = new_count.load(), eigen0 = eigen_count.load();
+    {
+        Forbid forbid;
+        f();
+    }
+    return { new_count.load() - new0, eigen_count.load() - eigen0 };
+}
+
+}
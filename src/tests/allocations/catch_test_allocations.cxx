@@ -0,0 +1,80 @@
+// Must come first, see the header
+#include "allocation_counting.hpp"
+
+#include <cstdlib>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "teqp/models/cubics.hpp"
+#include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/VLLE.hpp"
+#include "teqp/algorithms/rootfinding.hpp"
+
+using namespace teqp;
+using allocation_counting::count_allocations;
+
+TEST_CASE("NewtonStepSolver does not allocate once constructed", "[rootfinding][workspace]")
+{
+    std::srand(1234);
+    Eigen::MatrixXd J = Eigen::MatrixXd::Random(6, 6) + 6 * Eigen::MatrixXd::Identity(6, 6);
+    Eigen::VectorXd r = Eigen::VectorXd::Random(6), dx(6);
+    NewtonStepSolver<> solver(6);
+    solver.solve(J, -r, dx);
+    Eigen::MatrixXd J2 = Eigen::MatrixXd::Random(6, 6);
+    auto counts = count_allocations([&]() { solver.solve(J2, -r, dx); });
+    CAPTURE(counts.new_calls, counts.eigen_mallocs);
+    CHECK(counts.total() == 0);
+}
+
+TEST_CASE("Allocations made while counting are counted", "[workspace]")
+{
+    auto counts = count_allocations([]() { Eigen::ArrayXd a(100); a.setZero(); std::vector<double> v(100); });
+    CHECK(counts.eigen_mallocs == 1);
+    CHECK(counts.new_calls == 1);
+}
+
+TEST_CASE("The iterations of the mixture VLE and VLLE solvers do not allocate on the heap", "[cubic][VLLE][workspace]")
+{
+    // The three-phase solution of the VLLE test of catch_test_cubics.cxx; each of the two-phase solvers is started near the V+L1 equilibrium
+    std::valarray<double> Tc_K = { 190.564, 305.32 }, pc_Pa = { 4599200, 4872200 }, acentric = { 0.011, 0.0995 };
+    Eigen::ArrayXXd kmat(2, 2); kmat << 0, 0.2, 0.2, 0;
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric, kmat);
+    double T = 160, p = 1487145.7338911793;
+    auto rhovecV = (Eigen::ArrayXd(2) << 1430.6932891600648 * 1.01, 29.069222646818993 * 0.99).finished();
+    auto rhovecL1 = (Eigen::ArrayXd(2) << 19790.019311316686 * 0.99, 2232.8975474159679 * 1.01).finished();
+    auto rhovecL2 = (Eigen::ArrayXd(2) << 4233.7371304627895 * 1.005, 17200.593397335379 * 0.995).finished();
+    Eigen::ArrayXd xL1 = (Eigen::ArrayXd(2) << 19790.019311316686, 2232.8975474159679).finished();
+    xL1 /= xL1.sum();
+
+    // With zero tolerances, exactly maxiter iterations are taken, so the allocations in the iterations after the 
+    // first one are the difference between the two counts. A first call sizes any scratch storage of the model.
+    // The return codes are checked outside of the counting, since Catch may allocate in its assertions
+    auto check_no_allocations_after_first_iteration = [](const auto& run, auto maxiter_met) {
+        run(1);
+        decltype(run(1)) code1, code6;
+        auto N1 = count_allocations([&]() { code1 = run(1); }).total();
+        auto N6 = count_allocations([&]() { code6 = run(6); }).total();
+        CAPTURE(N1, N6);
+        CHECK(code1 == maxiter_met);
+        CHECK(code6 == maxiter_met);
+        CHECK(N6 == N1);
+    };
+    SECTION("mix_VLLE_T") {
+        check_no_allocations_after_first_iteration([&](int maxiter) {
+            return std::get<0>(mix_VLLE_T(model, T, rhovecV, rhovecL1, rhovecL2, 0.0, 0.0, 0.0, 0.0, maxiter));
+        }, VLLE_return_code::maxiter_met);
+    }
+    SECTION("mix_VLE_Tx") {
+        check_no_allocations_after_first_iteration([&](int maxiter) {
+            return std::get<0>(mix_VLE_Tx(model, T, rhovecL1, rhovecV, xL1, 0.0, 0.0, 0.0, 0.0, maxiter));
+        }, VLE_return_code::maxiter_met);
+    }
+    SECTION("mixture_VLE_px") {
+        check_no_allocations_after_first_iteration([&](int maxiter) {
+            MixVLEPxFlags flags;
+            flags.atol = 0; flags.reltol = 0; flags.axtol = 0; flags.relxtol = 0; flags.maxiter = maxiter;
+            return std::get<0>(mixture_VLE_px(model, p, xL1, T + 0.5, rhovecL1, rhovecV, flags));
+        }, VLE_return_code::maxiter_met);
+    }
+}
@@ -7,6 +7,7 @@ using Catch::Approx;
 #include "teqp/derivs.hpp"
 #include "teqp/models/pcsaft.hpp"
 #include "teqp/finite_derivs.hpp"
+#include "PCSAFT_fixtures.hpp"
 using namespace teqp::PCSAFT;
 using namespace teqp;
 
@@ -150,4 +151,132 @@ TEST_CASE("Check PCSAFT with kij and coeffs", "[PCSAFT]")
     SECTION("Incorrectly shaped kij matrix") {
         CHECK_THROWS(PCSAFTMixture(coeffs, kij_bad));
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Check derivative bundle against individual derivatives", "[PCSAFT][bundle]")
+{
+    std::vector<std::string> names = { "Methane", "Ethane" };
+    auto model = PCSAFTMixture(names);
+    double T = 200, rho = 3000;
+    auto z = (Eigen::ArrayXd(2) << 0.3, 0.7).finished();
+    using tdx = TDXDerivatives<decltype(model)>;
+
+    auto bundle = tdx::get_Ar_bundle<2, 3>(model, T, rho, z);
+    auto check = [&](int i, int j, double expected) {
+        CAPTURE(i);
+        CAPTURE(j);
+        CHECK(bundle(i, j) == Approx(expected).epsilon(1e-12));
+    };
+    check(0, 0, tdx::get_Ar00(model, T, rho, z));
+    check(0, 1, tdx::get_Ar01(model, T, rho, z));
+    check(0, 2, tdx::get_Ar02(model, T, rho, z));
+    check(0, 3, tdx::get_Ar0n<3>(model, T, rho, z)[3]);
+    check(1, 0, tdx::get_Ar10(model, T, rho, z));
+    check(1, 1, tdx::get_Ar11(model, T, rho, z));
+    check(1, 2, tdx::get_Ar12(model, T, rho, z));
+    check(2, 0, tdx::get_Ar20(model, T, rho, z));
+    check(2, 1, tdx::get_Arxy<2, 1, ADBackends::autodiff>(model, T, rho, z));
+}
+
+TEST_CASE("Temporaries of PC-SAFT are taken from the arena of the thread", "[PCSAFT][arena]")
+{
+    std::vector<std::string> names = { "Methane", "Ethane" };
+    auto model = PCSAFTMixture(names);
+    double T = 200, rho = 3000;
+    auto z = (Eigen::ArrayXd(2) << 0.3, 0.7).finished();
+    using tdx = TDXDerivatives<decltype(model)>;
+    auto Ar02 = tdx::get_Ar02(model, T, rho, z);
+
+    // A small arena owned by the caller, so that it has to grow in the first evaluation
+    BumpArena arena(64);
+    UseArena use(arena);
+    CHECK(tdx::get_Ar02(model, T, rho, z) == Ar02);
+    auto blocks = arena.heap_allocations();
+    CHECK(blocks > 0);
+
+    // The arena is rewound after each evaluation, so the next ones reuse its blocks
+    auto marker = arena.mark();
+    for (auto i = 0; i < 10; ++i) {
+        CHECK(tdx::get_Ar02(model, T, rho, z) == Ar02);
+    }
+    CHECK(arena.heap_allocations() == blocks);
+    CHECK(arena.mark().block == marker.block);
+    CHECK(arena.mark().offset == marker.offset);
+
+    // Nested scopes give back only their own arrays, and destroy the objects in them
+    {
+        ArenaScope outer(arena);
+        auto names_ = outer.array<std::string>(2);
+        names_[0] = std::string(100, 'x');
+        {
+            ArenaScope inner(arena);
+            inner.array<double>(1000).setZero();
+        }
+        CHECK(names_[0].size() == 100);
+        CHECK(model.alphar(T, rho, z) == tdx::get_Ar00(model, T, rho, z));
+    }
+    CHECK(arena.mark().offset == marker.offset);
+}
+
+TEST_CASE("Check PCSAFT bound to a temperature and composition", "[PCSAFT][bind]")
+{
+    // Twelve components, with an asymmetric kij matrix to check the tabulated pair parameters
+    const auto coeffs = fixtures::alkane_like_coeffs(12);
+    const Eigen::ArrayXXd kmat = fixtures::asymmetric_kmat(12);
+    auto model = PCSAFTMixture(coeffs, kmat);
+    Eigen::ArrayXd z = Eigen::ArrayXd::LinSpaced(12, 1, 2); z /= z.sum();
+    double T = 300;
+
+    // alphar of Gross and Sadowski without the pair tables; the double sums of Eqs. A.12 and A.13 run over all (i, j), 
+    // each pair with its own k_ij. The tables fold (j, i) into (i, j), which must not change the sums
+    auto alphar_untabulated = [&](double T, double rhomolar, const Eigen::ArrayXd& x) {
+        const auto N = x.size();
+        Eigen::ArrayXd m(N), d(N);
+        for (auto i = 0; i < N; ++i) {
+            m[i] = coeffs[i].m;
+            d[i] = coeffs[i].sigma_Angstrom * (1.0 - 0.12 * exp(-3.0 * coeffs[i].epsilon_over_k / T));
+        }
+        double rho_A3 = rhomolar * N_A * 1e-30, mbar = (x * m).sum();
+        std::array<double, 4> zeta;
+        for (auto n = 0; n < 4; ++n) {
+            zeta[n] = EIGEN_PI / 6.0 * rho_A3 * (x * m * d.pow(n)).sum();
+        }
+        double m2_epsilon_sigma3_bar = 0.0, m2_epsilon2_sigma3_bar = 0.0;
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = 0; j < N; ++j) {
+                double sigma_ij = (coeffs[i].sigma_Angstrom + coeffs[j].sigma_Angstrom) / 2.0;
+                double eij_over_kT = sqrt(coeffs[i].epsilon_over_k * coeffs[j].epsilon_over_k) * (1.0 - kmat(i, j)) / T;
+                m2_epsilon_sigma3_bar += x[i] * x[j] * m[i] * m[j] * eij_over_kT * pow(sigma_ij, 3);
+                m2_epsilon2_sigma3_bar += x[i] * x[j] * m[i] * m[j] * pow(eij_over_kT, 2) * pow(sigma_ij, 3);
+            }
+        }
+        double sum_lngii_hs = 0.0;
+        for (auto i = 0; i < N; ++i) {
+            sum_lngii_hs += x[i] * (m[i] - 1.0) * log(gij_HS(zeta, d, i, i));
+        }
+        auto I1 = std::get<0>(get_I_sums(zeta[3], get_a(mbar)));
+        auto I2 = std::get<0>(get_I_sums(zeta[3], get_b(mbar)));
+        double alphar_hc = mbar * get_alphar_hs(zeta) - sum_lngii_hs;
+        double alphar_disp = -2 * EIGEN_PI * rho_A3 * I1 * m2_epsilon_sigma3_bar - EIGEN_PI * rho_A3 * mbar * C1(zeta[3], mbar) * I2 * m2_epsilon2_sigma3_bar;
+        return alphar_hc + alphar_disp;
+    };
+
+    auto bound = model.bind(T, z);
+    using tdx = TDXDerivatives<decltype(model)>;
+    using tdxb = TDXDerivatives<decltype(bound)>;
+    for (double rho : { 1.0, 100.0, 3000.0, 8000.0 }) {
+        CAPTURE(rho);
+        CHECK(model.alphar(T, rho, z) == Approx(alphar_untabulated(T, rho, z)).epsilon(1e-13));
+        CHECK(bound.alphar(rho) == Approx(model.alphar(T, rho, z)).epsilon(1e-14));
+        auto Ar0n = tdx::get_Ar0n<3>(model, T, rho, z);
+        auto Ar0nb = tdxb::get_Ar0n<3>(bound, T, rho, z);
+        for (auto n = 0; n < 4; ++n) {
+            CHECK(Ar0nb[n] == Approx(Ar0n[n]).epsilon(1e-13));
+        }
+    }
+    CHECK_THROWS(bound.alphar(T + 1, 3000.0, z));
+    // The bound mole fractions are always used, so other ones are rejected
+    Eigen::ArrayXd zother = Eigen::ArrayXd::Ones(12) / 12.0;
+    CHECK_THROWS(bound.alphar(T, 3000.0, zother));
+    CHECK_THROWS(bound.alphar(T, 3000.0, Eigen::ArrayXd::Ones(3)));
+    CHECK_THROWS(model.bind(T, Eigen::ArrayXd::Ones(3)));
+}
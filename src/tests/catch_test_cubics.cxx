@@ -9,6 +9,8 @@ using Catch::Approx;
 #include "teqp/models/cubics.hpp"
 #include "teqp/derivs.hpp"
 #include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/VLLE.hpp"
+#include "teqp/algorithms/rootfinding.hpp"
 
 #include <boost/numeric/odeint/stepper/euler.hpp>
 #include <boost/numeric/odeint/stepper/runge_kutta_cash_karp54.hpp>
@@ -55,6 +57,41 @@ TEST_CASE("Check SRK with kij setting", "[cubic]")
     }
 }
 
+TEST_CASE("Check the mixing rule for a against the sum over pairs", "[cubic]")
+{
+    const int N = 20;
+    std::valarray<double> Tc_K(N), pc_Pa(N), acentric(N);
+    for (auto i = 0; i < N; ++i) {
+        Tc_K[i] = 190.0 + 20.0 * i; pc_Pa[i] = 4.6e6 - 1e5 * i; acentric[i] = 0.01 + 0.03 * i;
+    }
+    Eigen::ArrayXXd kmat = Eigen::ArrayXXd::Random(N, N) * 0.05; // Not symmetric, on purpose
+    auto z = (Eigen::ArrayXd::LinSpaced(N, 1, N) / (N * (N + 1) / 2.0)).eval();
+    double T = 300;
+
+    // The sum over all the pairs of a_ij = (1-k_ij)*sqrt(a_i*a_j), with the a_i of the pure components
+    auto a_pairs = [&](const auto& model, const Eigen::ArrayXXd& k) {
+        double a = 0;
+        for (auto i = 0; i < N; ++i) {
+            for (auto j = 0; j < N; ++j) {
+                Eigen::ArrayXd zi = Eigen::ArrayXd::Zero(N), zj = Eigen::ArrayXd::Zero(N);
+                zi[i] = 1; zj[j] = 1;
+                a += z[i] * z[j] * (1 - k(i, j)) * sqrt(model.get_a(T, zi) * model.get_a(T, zj));
+            }
+        }
+        return a;
+    };
+    auto model0 = canonical_PR(Tc_K, pc_Pa, acentric);
+    auto modelk = canonical_PR(Tc_K, pc_Pa, acentric, kmat);
+    CHECK(model0.get_a(T, z) == Approx(a_pairs(model0, Eigen::ArrayXXd::Zero(N, N))).epsilon(1e-14));
+    CHECK(modelk.get_a(T, z) == Approx(a_pairs(model0, kmat)).epsilon(1e-14));
+
+    // The autodiff types take the other branch of the kernel
+    using tdx = TDXDerivatives<decltype(modelk)>;
+    auto Ar10 = tdx::get_Ar10(modelk, T, 1000.0, z);
+    auto Ar10csd = tdx::get_Ar10<ADBackends::complex_step>(modelk, T, 1000.0, z);
+    CHECK(Ar10 == Approx(Ar10csd).epsilon(1e-13));
+}
+
 TEST_CASE("Check calling superancillary curves", "[cubic][superanc]") 
 {
     std::valarray<double> Tc_K = { 150.687 };
@@ -80,6 +117,57 @@ TEST_CASE("Check calling superancillary curves", "[cubic][superanc]")
     }
 }
 
+TEST_CASE("Pure VLE of cubics can be seeded from the superancillary", "[cubic][superanc]")
+{
+    std::valarray<double> Tc_K = { 190.564 }, pc_Pa = { 4599200 }, acentric = { 0.011 };
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    static_assert(has_superanc_rhoLV<decltype(model)>::value);
+    static_assert(!has_superanc_rhoLV<PureComponentView<decltype(model)>>::value);
+
+    for (double T : { 100.0, 150.0, 190.0 }) {
+        CAPTURE(T);
+        auto [rhoL, rhoV] = model.superanc_rhoLV(T);
+        auto resid = IsothermPureVLEResiduals(model, T);
+
+        auto rhos = pure_VLE_T_superanc(model, T);
+        CHECK(rhos[0] == Approx(rhoL).epsilon(1e-12));
+        CHECK(rhos[1] == Approx(rhoV).epsilon(1e-12));
+        CHECK((resid.call(rhos).cwiseAbs() < 1e-10).all());
+
+        // With no iterations, the superancillary is the answer
+        auto rhos0 = pure_VLE_T_superanc(model, T, 0);
+        CHECK(rhos0[0] == rhoL);
+        CHECK(rhos0[1] == rhoV);
+
+        // pure_VLE_T starts from the guesses of the caller, and with no iterations returns them
+        auto rhosguess = pure_VLE_T(model, T, 1.001 * rhoL, 0.999 * rhoV, 20);
+        CHECK(rhosguess[0] == Approx(rhoL).epsilon(1e-12));
+        CHECK(rhosguess[1] == Approx(rhoV).epsilon(1e-12));
+        auto rhosguess0 = pure_VLE_T(model, T, 1.001 * rhoL, 0.999 * rhoV, 0);
+        CHECK(rhosguess0[0] == 1.001 * rhoL);
+        CHECK(rhosguess0[1] == 0.999 * rhoV);
+
+        // maxiter is an upper bound; starting from the solution, the iterations stop once the densities stop changing
+        auto rhos1 = pure_VLE_T(model, T, rhos[0], rhos[1], 1);
+        auto rhos50 = pure_VLE_T(model, T, rhos[0], rhos[1], 50);
+        CHECK(rhos50[0] == Approx(rhos1[0]).epsilon(1e-15));
+        CHECK(rhos50[1] == Approx(rhos1[1]).epsilon(1e-15));
+
+        // The superancillary is only used when asked for, with superanc_or_extrapolate
+        auto rhoc = pc_Pa[0] / (0.3074 * model.R(acentric) * Tc_K[0]); // Zc of Peng-Robinson
+        auto rhovec = superanc_or_extrapolate(model, Tc_K[0], rhoc, T);
+        CHECK(rhovec[0] == rhoL);
+        CHECK(rhovec[1] == rhoV);
+        auto rhoextrap = extrapolate_from_critical(model, Tc_K[0], rhoc, T);
+        CHECK(rhoextrap[0] != rhoL);
+        CHECK(rhoextrap[1] != rhoV);
+        const PureComponentView view(model, 0, 1);
+        auto rhoview = superanc_or_extrapolate(view, Tc_K[0], rhoc, T);
+        CHECK((rhoview == extrapolate_from_critical(view, Tc_K[0], rhoc, T)).all());
+    }
+    CHECK_THROWS(pure_VLE_T_superanc(model, 200.0));
+}
+
 TEST_CASE("Check manual integration of subcritical VLE isotherm for binary mixture", "[cubic][isochoric][traceisotherm]")
 {
     using namespace boost::numeric::odeint;
@@ -384,4 +472,313 @@ TEST_CASE("Check manual integration of subcritical VLE isobar for binary mixture
 
         std::ofstream file("isoP.json"); file << J;
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Trace families of VLE isotherms and isobars concurrently", "[cubic][isochoric][traceisotherm][traceisobar]")
+{
+    std::valarray<double> Tc_K = { 190.564, 154.581 },
+                         pc_Pa = { 4599200, 5042800 },
+                      acentric = { 0.011, 0.022 };
+    const auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+
+    // The pure fluid seeding the isolines is methane, whose superancillary gives the density guesses
+    int ipure = 0;
+    const auto pure = canonical_PR(std::valarray<double>(Tc_K[ipure], 1), std::valarray<double>(pc_Pa[ipure], 1), std::valarray<double>(acentric[ipure], 1));
+
+    SECTION("isotherms") {
+        // The last isotherm is above the critical temperature of methane and cannot be seeded
+        std::vector<double> Ts = { 110, 120, 130, 140, 200 };
+        auto seed = [&pure](double T) { return pure.superanc_rhoLV(T); };
+        auto results = trace_VLE_isotherms_binary(model, Ts, ipure, seed, std::nullopt, 4);
+        REQUIRE(results.size() == Ts.size());
+        for (auto i = 0U; i + 1 < Ts.size(); ++i) {
+            CHECK(results[i].success);
+            CHECK(results[i].value == Ts[i]);
+            CHECK(results[i].trace.size() > 3);
+        }
+        CHECK(!results.back().success);
+        CHECK(!results.back().message.empty());
+
+        // Same as tracing serially from the pure fluid saturation state
+        auto [rhoL, rhoV] = pure.superanc_rhoLV(Ts[1]);
+        auto rhos = pure_VLE_T(pure, Ts[1], rhoL, rhoV, 10);
+        Eigen::ArrayXd rhovecL0 = Eigen::ArrayXd::Zero(2), rhovecV0 = Eigen::ArrayXd::Zero(2);
+        rhovecL0[ipure] = rhos[0]; rhovecV0[ipure] = rhos[1];
+        auto J = trace_VLE_isotherm_binary(model, Ts[1], rhovecL0, rhovecV0);
+        CHECK(J.size() == results[1].trace.size());
+    }
+    SECTION("isobars") {
+        std::vector<double> ps = { 2e5, 5e5, 1e6 };
+        // A rough guess of the saturation temperature, refined by pure_VLE_p
+        auto seed = [&pure](double /*p*/) { 
+            double T = 130; 
+            auto [rhoL, rhoV] = pure.superanc_rhoLV(T);
+            return std::make_tuple(T, rhoL, rhoV);
+        };
+        auto results = trace_VLE_isobars_binary(model, ps, ipure, seed, std::nullopt, 4);
+        REQUIRE(results.size() == ps.size());
+        for (auto i = 0U; i < ps.size(); ++i) {
+            CHECK(results[i].success);
+            CHECK(results[i].trace.size() > 3);
+        }
+        // The pure fluid saturation temperature is consistent with the pressure
+        auto [rhoL0, rhoV0] = pure.superanc_rhoLV(130.0);
+        auto [T, rhoL, rhoV] = pure_VLE_p(pure, ps[1], 130.0, rhoL0, rhoV0);
+        double R = pure.R(std::valarray<double>{ 1.0 });
+        double pcheck = rhoV * R * T * (1 + TDXDerivatives<decltype(pure)>::get_Ar01(pure, T, rhoV, Eigen::ArrayXd::Ones(1)));
+        CHECK(pcheck == Approx(ps[1]));
+        // The liquid density also belongs to the returned temperature
+        double pcheckL = rhoL * R * T * (1 + TDXDerivatives<decltype(pure)>::get_Ar01(pure, T, rhoL, Eigen::ArrayXd::Ones(1)));
+        CHECK(pcheckL == Approx(ps[1]));
+        // Running out of iterations is an error rather than a silently unconverged result
+        CHECK_THROWS_AS(pure_VLE_p(pure, ps[1], 130.0, rhoL0, rhoV0, 1), IterationFailure);
+    }
+}
+
+TEST_CASE("Pass the points of VLE isotherms and isobars to observers", "[cubic][isochoric][traceisotherm][traceisobar]")
+{
+    std::valarray<double> Tc_K = { 190.564, 154.581 },
+                         pc_Pa = { 4599200, 5042800 },
+                      acentric = { 0.011, 0.022 };
+    const auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    const auto pure = canonical_PR(std::valarray<double>(Tc_K[0], 1), std::valarray<double>(pc_Pa[0], 1), std::valarray<double>(acentric[0], 1));
+
+    double T = 120;
+    auto [rhoL, rhoV] = pure.superanc_rhoLV(T);
+    auto rhos = pure_VLE_T(pure, T, rhoL, rhoV, 10);
+    Eigen::ArrayXd rhovecL0 = Eigen::ArrayXd::Zero(2), rhovecV0 = Eigen::ArrayXd::Zero(2);
+    rhovecL0[0] = rhos[0]; rhovecV0[0] = rhos[1];
+
+    SECTION("isotherm") {
+        auto J = trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0);
+        std::vector<VLETracePoint> points;
+        auto N = trace_VLE_isotherm_binary_observed(model, T, rhovecL0, rhovecV0, [&points](const VLETracePoint& pt) { points.push_back(pt); });
+        REQUIRE(N == J.size());
+        REQUIRE(points.size() == J.size());
+        for (auto i = 0U; i < points.size(); ++i) {
+            CHECK(points[i].t == J[i].at("t").get<double>());
+            CHECK(points[i].pL.value() == J[i].at("pL / Pa").get<double>());
+            CHECK(points[i].rhovecV[0] == J[i].at("rhoV / mol/m^3")[0].get<double>());
+            CHECK(!points[i].crit_conditions_L);
+        }
+    }
+    SECTION("isotherm, stopped by the observer and without pressures") {
+        std::size_t Ncalls = 0;
+        VLETraceColumns columns;
+        columns.pressures = false;
+        auto stop_after_three = [&Ncalls](const VLETracePoint& pt) { 
+            CHECK(!pt.pL); CHECK(!pt.pV); 
+            return ++Ncalls < 3; 
+        };
+        auto N = trace_VLE_isotherm_binary_observed(model, T, rhovecL0, rhovecV0, stop_after_three, columns);
+        CHECK(N == 3);
+        CHECK(Ncalls == 3);
+    }
+    SECTION("isobar") {
+        double p = rhos[1] * pure.R(std::valarray<double>{ 1.0 }) * T * (1 + TDXDerivatives<decltype(pure)>::get_Ar01(pure, T, rhos[1], Eigen::ArrayXd::Ones(1)));
+        auto J = trace_VLE_isobar_binary(model, p, T, rhovecL0, rhovecV0);
+        std::vector<double> Ts;
+        auto N = trace_VLE_isobar_binary_observed(model, p, T, rhovecL0, rhovecV0, [&Ts](const VLETracePoint& pt) { Ts.push_back(pt.T); });
+        REQUIRE(N == J.size());
+        for (auto i = 0U; i < Ts.size(); ++i) {
+            CHECK(Ts[i] == J[i].at("T / K").get<double>());
+        }
+    }
+}
+
+TEST_CASE("Store the points of a VLE isotherm column-wise", "[cubic][isochoric][traceisotherm]")
+{
+    std::valarray<double> Tc_K = { 190.564, 154.581 },
+                         pc_Pa = { 4599200, 5042800 },
+                      acentric = { 0.011, 0.022 };
+    const auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    const auto pure = canonical_PR(std::valarray<double>(Tc_K[0], 1), std::valarray<double>(pc_Pa[0], 1), std::valarray<double>(acentric[0], 1));
+
+    double T = 120;
+    auto [rhoL, rhoV] = pure.superanc_rhoLV(T);
+    auto rhos = pure_VLE_T(pure, T, rhoL, rhoV, 10);
+    Eigen::ArrayXd rhovecL0 = Eigen::ArrayXd::Zero(2), rhovecV0 = Eigen::ArrayXd::Zero(2);
+    rhovecL0[0] = rhos[0]; rhovecV0[0] = rhos[1];
+
+    TVLEOptions opt;
+    opt.calc_criticality = true;
+    auto J = trace_VLE_isotherm_binary(model, T, rhovecL0, rhovecV0, opt);
+    auto data = trace_VLE_isotherm_binary_columnar(model, T, rhovecL0, rhovecV0, VLETraceColumns{}, opt);
+    REQUIRE(data.size() == J.size());
+    REQUIRE(data.rhovecL.size() == 2);
+    REQUIRE(data.dxdt.size() == 4);
+    CHECK(data.pV.size() == data.size());
+    CHECK(data.crit_conditions_L.size() == 2);
+    CHECK(data.rhovecV[0].size() == data.size());
+    for (auto i = 0U; i < data.size(); ++i) {
+        CHECK(data.pL[i] == J[i].at("pL / Pa").get<double>());
+        CHECK(data.rhovecL[1][i] == J[i].at("rhoL / mol/m^3")[1].get<double>());
+    }
+    CHECK(data.to_JSON() == J);
+
+    // Quantities that are not selected leave their columns empty
+    VLETraceColumns columns;
+    columns.pressures = false;
+    auto bare = trace_VLE_isotherm_binary_columnar(model, T, rhovecL0, rhovecV0, columns);
+    CHECK(bare.size() == data.size());
+    CHECK(bare.pL.empty());
+    CHECK(bare.crit_conditions_V.empty());
+    CHECK(!bare.to_JSON()[0].contains("pL / Pa"));
+}
+
+TEST_CASE("Workspace overloads of the isochoric builders", "[cubic][isochoric][workspace]")
+{
+    std::valarray<double> Tc_K = { 190.564, 154.581, 150.687 }, pc_Pa = { 4599200, 5042800, 4863000 }, acentric = { 0.011, 0.022, -0.002 };
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    using id = IsochoricDerivatives<decltype(model)>;
+    double T = 170;
+
+    auto close = [](const auto& a, const auto& b) {
+        return ((a.array() - b.array()).cwiseAbs() <= 1e-12 * b.array().cwiseAbs().maxCoeff()).all();
+    };
+
+    // One workspace is reused for all the compositions
+    id::Workspace ws;
+    for (auto rhovec : { Eigen::ArrayXd((Eigen::ArrayXd(3) << 3000.0, 5000.0, 1000.0).finished()), Eigen::ArrayXd((Eigen::ArrayXd(3) << 10.0, 20.0, 30.0).finished()) }) {
+        CAPTURE(rhovec);
+        auto [f, g, H] = id::build_Psir_fgradHessian_autodiff(model, T, rhovec);
+        auto [fws, gws, Hws] = id::build_Psir_fgradHessian_autodiff(model, T, rhovec, ws);
+        CHECK(fws == Approx(f));
+        CHECK(close(gws, g));
+        CHECK(close(Hws, H));
+        CHECK(close(id::build_Psir_gradient_autodiff(model, T, rhovec, ws), id::build_Psir_gradient_autodiff(model, T, rhovec)));
+        CHECK(close(id::build_d2PsirdTdrhoi_autodiff(model, T, rhovec, ws), id::build_d2PsirdTdrhoi_autodiff(model, T, rhovec)));
+        CHECK(ws.dPsirdT == Approx(id::get_dPsirdT_constrhovec(model, T, rhovec)));
+        CHECK(close(id::build_Psi_Hessian_autodiff(model, T, rhovec, ws), id::build_Psi_Hessian_autodiff(model, T, rhovec)));
+
+        // Any array expression can be passed in, without copying it into a new array
+        Eigen::Map<const Eigen::ArrayXd> rhovecmap(rhovec.data(), rhovec.size());
+        CHECK(close(std::get<2>(id::build_Psir_fgradHessian_autodiff(model, T, rhovecmap, ws)), H));
+    }
+
+    // The workspace is resized if the number of components changes
+    auto modelbin = canonical_PR(std::valarray<double>(Tc_K[std::slice(0, 2, 1)]), std::valarray<double>(pc_Pa[std::slice(0, 2, 1)]), std::valarray<double>(acentric[std::slice(0, 2, 1)]));
+    using idbin = IsochoricDerivatives<decltype(modelbin)>;
+    idbin::Workspace wsbin(3);
+    auto rhovecbin = (Eigen::ArrayXd(2) << 3000.0, 5000.0).finished();
+    CHECK(close(std::get<2>(idbin::build_Psir_fgradHessian_autodiff(modelbin, T, rhovecbin, wsbin)), idbin::build_Psir_Hessian_autodiff(modelbin, T, rhovecbin)));
+    CHECK(wsbin.Hessian.rows() == 2);
+}
+
+TEST_CASE("NewtonStepSolver agrees with ColPivHouseholderQR", "[rootfinding]")
+{
+    auto close = [](const auto& a, const auto& b) {
+        return ((a.array() - b.array()).cwiseAbs() <= 1e-12 * b.array().cwiseAbs().maxCoeff()).all();
+    };
+    std::srand(1234);
+    SECTION("Dynamic size") {
+        Eigen::MatrixXd J = Eigen::MatrixXd::Random(6, 6) + 6 * Eigen::MatrixXd::Identity(6, 6);
+        Eigen::VectorXd r = Eigen::VectorXd::Random(6), dx(6);
+        NewtonStepSolver<> solver(6);
+        solver.solve(J, -r, dx);
+        CHECK(close(dx, J.colPivHouseholderQr().solve(-r).eval()));
+        // The storage is reused, and the result does not depend on the previous call
+        Eigen::MatrixXd J2 = Eigen::MatrixXd::Random(6, 6);
+        solver.solve(J2, -r, dx);
+        CHECK(close(dx, J2.colPivHouseholderQr().solve(-r).eval()));
+    }
+    SECTION("Fixed size") {
+        Eigen::Matrix4d J = Eigen::Matrix4d::Random();
+        Eigen::Vector4d r = Eigen::Vector4d::Random();
+        Eigen::Array4d dx;
+        NewtonStepSolver<4> solver(4);
+        solver.solve(J, r, dx);
+        CHECK(close(dx.matrix(), J.colPivHouseholderQr().solve(r).eval()));
+    }
+    SECTION("Rank deficient") {
+        // The third column is the sum of the first two, so the rank is 3; the non-pivot entry of the step is zero
+        Eigen::MatrixXd J = Eigen::MatrixXd::Random(4, 4);
+        J.col(2) = J.col(0) + J.col(1);
+        Eigen::VectorXd r = Eigen::VectorXd::Random(4), dx(4);
+        NewtonStepSolver<> solver(4);
+        solver.solve(J, r, dx);
+        Eigen::VectorXd expected = J.colPivHouseholderQr().solve(r);
+        CHECK(J.colPivHouseholderQr().rank() == 3);
+        CHECK(close(dx, expected));
+    }
+}
+
+TEST_CASE("VLLE of a binary mixture with the Peng-Robinson EOS", "[cubic][VLLE]")
+{
+    // Methane + ethane, with a large k_ij to separate the liquid phases
+    std::valarray<double> Tc_K = { 190.564, 305.32 }, pc_Pa = { 4599200, 4872200 }, acentric = { 0.011, 0.0995 };
+    Eigen::ArrayXXd kmat(2, 2); kmat << 0, 0.2, 0.2, 0;
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric, kmat);
+    double T = 160;
+    // Solution from an independent solver, with |r| of 1.3e-7 (the pressures are of the order of 1e6 Pa)
+    auto rhovecV = (Eigen::ArrayXd(2) << 1430.6932891600648, 29.069222646818993).finished();
+    auto rhovecL1 = (Eigen::ArrayXd(2) << 19790.019311316686, 2232.8975474159679).finished();
+    auto rhovecL2 = (Eigen::ArrayXd(2) << 4233.7371304627895, 17200.593397335379).finished();
+    double p = 1487145.7338911793;
+    // Perturbed initial guesses, so that the steps are positive for some of the unknowns and negative for others
+    Eigen::ArrayXd rhovecV0 = rhovecV * (Eigen::ArrayXd(2) << 1.01, 0.99).finished();
+    Eigen::ArrayXd rhovecL10 = rhovecL1 * (Eigen::ArrayXd(2) << 0.99, 1.01).finished();
+    Eigen::ArrayXd rhovecL20 = rhovecL2 * (Eigen::ArrayXd(2) << 1.005, 0.995).finished();
+
+    auto close = [](const auto& a, const auto& b, double tol) {
+        return ((a - b).cwiseAbs() <= tol * b.cwiseAbs()).all();
+    };
+
+    SECTION("Converged solution") {
+        auto [code, rhovecVnew, rhovecL1new, rhovecL2new] = mix_VLLE_T(model, T, rhovecV0, rhovecL10, rhovecL20, 1e-10, 1e-10, 1e-10, 1e-10, 20);
+        CAPTURE(rhovecVnew, rhovecL1new, rhovecL2new);
+        CHECK(code != VLLE_return_code::maxiter_met);
+        CHECK(close(rhovecVnew, rhovecV, 1e-9));
+        CHECK(close(rhovecL1new, rhovecL1, 1e-9));
+        CHECK(close(rhovecL2new, rhovecL2, 1e-9));
+        using id = IsochoricDerivatives<decltype(model)>;
+        CHECK(rhovecL1new.sum() * model.R(rhovecL1new) * T + id::get_pr(model, T, rhovecL1new) == Approx(p).epsilon(1e-10));
+    }
+    SECTION("Same iterates as the formulation with the Hessians of Psi and a new decomposition in each step") {
+        // The step of mix_VLLE_T before it was rewritten to assemble the Jacobian from the residual Hessians in workspaces
+        using id = IsochoricDerivatives<decltype(model)>;
+        auto reference_step = [&](Eigen::VectorXd& x) {
+            const Eigen::Index N = 2;
+            Eigen::ArrayXd rV = x.head(N).array(), rL1 = x.segment(N, N).array(), rL2 = x.tail(N).array();
+            auto [PsirV, PsirgradV, hessianV] = id::build_Psir_fgradHessian_autodiff(model, T, rV);
+            auto [PsirL1, PsirgradL1, hessianL1] = id::build_Psir_fgradHessian_autodiff(model, T, rL1);
+            auto [PsirL2, PsirgradL2, hessianL2] = id::build_Psir_fgradHessian_autodiff(model, T, rL2);
+            auto HtotV = id::build_Psi_Hessian_autodiff(model, T, rV);
+            auto HtotL1 = id::build_Psi_Hessian_autodiff(model, T, rL1);
+            auto HtotL2 = id::build_Psi_Hessian_autodiff(model, T, rL2);
+            double RT = model.R(rV) * T;
+            double pV = rV.sum() * RT - PsirV + (rV * PsirgradV.array()).sum();
+            double pL1 = rL1.sum() * RT - PsirL1 + (rL1 * PsirgradL1.array()).sum();
+            double pL2 = rL2.sum() * RT - PsirL2 + (rL2 * PsirgradL2.array()).sum();
+            Eigen::ArrayXd dpdrhovecV = RT + (hessianV * rV.matrix()).array();
+            Eigen::ArrayXd dpdrhovecL1 = RT + (hessianL1 * rL1.matrix()).array();
+            Eigen::ArrayXd dpdrhovecL2 = RT + (hessianL2 * rL2.matrix()).array();
+
+            Eigen::VectorXd r(3 * N);
+            r.head(N) = PsirgradV.array() + RT * log(rV) - (PsirgradL1.array() + RT * log(rL1));
+            r.segment(N, N) = PsirgradL1.array() + RT * log(rL1) - (PsirgradL2.array() + RT * log(rL2));
+            r(2 * N) = pV - pL1;
+            r(2 * N + 1) = pL1 - pL2;
+            Eigen::MatrixXd J(3 * N, 3 * N); J.setZero();
+            J.block(0, 0, N, N) = HtotV;
+            J.block(0, N, N, N) = -HtotL1;
+            J.block(N, N, N, N) = HtotL1;
+            J.block(N, 2 * N, N, N) = -HtotL2;
+            J.block(2 * N, 0, 1, N) = dpdrhovecV.matrix().transpose();
+            J.block(2 * N, N, 1, N) = -dpdrhovecL1.matrix().transpose();
+            J.block(2 * N + 1, N, 1, N) = dpdrhovecL1.matrix().transpose();
+            J.block(2 * N + 1, 2 * N, 1, N) = -dpdrhovecL2.matrix().transpose();
+            x += J.colPivHouseholderQr().solve(-r);
+        };
+        Eigen::VectorXd x(6); x << rhovecV0.matrix(), rhovecL10.matrix(), rhovecL20.matrix();
+        for (int maxiter = 1; maxiter <= 5; ++maxiter) {
+            CAPTURE(maxiter);
+            reference_step(x);
+            // With zero tolerances, exactly maxiter steps are taken
+            auto [code, rhovecVnew, rhovecL1new, rhovecL2new] = mix_VLLE_T(model, T, rhovecV0, rhovecL10, rhovecL20, 0.0, 0.0, 0.0, 0.0, maxiter);
+            CHECK(code == VLLE_return_code::maxiter_met);
+            CHECK(close(rhovecVnew, x.head(2).array(), 1e-10));
+            CHECK(close(rhovecL1new, x.segment(2, 2).array(), 1e-10));
+            CHECK(close(rhovecL2new, x.tail(2).array(), 1e-10));
+        }
+    }
+}
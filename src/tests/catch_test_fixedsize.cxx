@@ -0,0 +1,193 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include "teqp/models/cubics.hpp"
+#include "teqp/models/vdW.hpp"
+#include "teqp/derivs.hpp"
+#include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/critical_tracing.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Closed-form eigenvalues and eigenvectors of symmetric 2x2 matrices", "[fixedsize]")
+{
+    std::vector<Eigen::Matrix2d> matrices;
+    matrices.push_back((Eigen::Matrix2d() << 2.0, 1.0, 1.0, 3.0).finished());
+    matrices.push_back((Eigen::Matrix2d() << 1e6, -3e2, -3e2, 1e-2).finished());
+    matrices.push_back((Eigen::Matrix2d() << -5.0, 0.0, 0.0, 4.0).finished());
+    matrices.push_back((Eigen::Matrix2d() << 4.0, 0.0, 0.0, -5.0).finished());
+    matrices.push_back((Eigen::Matrix2d() << 7.0, 0.0, 0.0, 7.0).finished());
+    for (const auto& H : matrices) {
+        CAPTURE(H);
+        auto [eigenvalues, eigenvectors] = detail::sorted_symmetric_eigen_2x2(H);
+        Eigen::SelfAdjointEigenSolver<Eigen::Matrix2d> es(H);
+        double scale = H.cwiseAbs().maxCoeff();
+        CHECK(std::abs(eigenvalues[0] - es.eigenvalues()[0]) < 1e-14*scale);
+        CHECK(std::abs(eigenvalues[1] - es.eigenvalues()[1]) < 1e-14*scale);
+        // Orthonormal, and the same as the eigenvectors from Eigen except for their signs
+        CHECK((eigenvectors.transpose()*eigenvectors - Eigen::Matrix2d::Identity()).cwiseAbs().maxCoeff() < 1e-14);
+        CHECK((H*eigenvectors - eigenvectors*eigenvalues.asDiagonal()).cwiseAbs().maxCoeff() < 1e-14*scale);
+        for (auto i = 0; i < 2; ++i) {
+            CHECK(std::abs(eigenvectors.col(i).dot(es.eigenvectors().col(i))) == Approx(1.0));
+        }
+    }
+}
+
+TEST_CASE("Isochoric derivatives with fixed-size arrays", "[fixedsize]")
+{
+    std::valarray<double> Tc_K = { 190.564, 154.581 }, pc_Pa = { 4599200, 5042800 }, acentric = { 0.011, 0.022 };
+    const auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    using idX = IsochoricDerivatives<decltype(model), double, Eigen::ArrayXd>;
+    using id2 = IsochoricDerivatives<decltype(model), double, Eigen::Array2d>;
+    static_assert(id2::Ncomp == 2);
+    static_assert(idX::Ncomp == Eigen::Dynamic);
+
+    double T = 150.0;
+    const Eigen::ArrayXd rhovecX = (Eigen::ArrayXd(2) << 3000.0, 5000.0).finished();
+    const Eigen::Array2d rhovec2 = rhovecX;
+
+    auto close = [](const auto& a, const auto& b) {
+        return ((a.array() - b.array()).cwiseAbs() <= 1e-12*b.array().cwiseAbs().maxCoeff()).all();
+    };
+
+    auto [fX, gX, HX] = idX::build_Psir_fgradHessian_autodiff(model, T, rhovecX);
+    auto [f2, g2, H2] = id2::build_Psir_fgradHessian_autodiff(model, T, rhovec2);
+    static_assert(std::is_same_v<decltype(H2), Eigen::Matrix2d>);
+    CHECK(f2 == Approx(fX));
+    CHECK(close(g2, gX));
+    CHECK(close(H2, HX));
+    CHECK(close(id2::build_Psir_Hessian_autodiff(model, T, rhovec2), idX::build_Psir_Hessian_autodiff(model, T, rhovecX)));
+    CHECK(close(id2::build_Psi_Hessian_autodiff(model, T, rhovec2), idX::build_Psi_Hessian_autodiff(model, T, rhovecX)));
+    CHECK(close(id2::build_Psir_gradient_autodiff(model, T, rhovec2), idX::build_Psir_gradient_autodiff(model, T, rhovecX)));
+    CHECK(close(id2::build_d2PsirdTdrhoi_autodiff(model, T, rhovec2), idX::build_d2PsirdTdrhoi_autodiff(model, T, rhovecX)));
+    CHECK(close(id2::get_dpdrhovec_constT(model, T, rhovec2), idX::get_dpdrhovec_constT(model, T, rhovecX)));
+    CHECK(close(id2::get_chempotVLE_autodiff(model, T, rhovec2), idX::get_chempotVLE_autodiff(model, T, rhovecX)));
+
+    SECTION("ternary") {
+        std::valarray<double> Tc3 = { 190.564, 154.581, 305.32 }, pc3 = { 4599200, 5042800, 4872200 }, acentric3 = { 0.011, 0.022, 0.099 };
+        const auto model3 = canonical_PR(Tc3, pc3, acentric3);
+        using idX3 = IsochoricDerivatives<decltype(model3), double, Eigen::ArrayXd>;
+        using id3 = IsochoricDerivatives<decltype(model3), double, Eigen::Array3d>;
+        const Eigen::ArrayXd rhovecX3 = (Eigen::ArrayXd(3) << 3000.0, 5000.0, 1000.0).finished();
+        const Eigen::Array3d rhovec3 = rhovecX3;
+        CHECK(close(id3::build_Psi_Hessian_autodiff(model3, T, rhovec3), idX3::build_Psi_Hessian_autodiff(model3, T, rhovecX3)));
+    }
+}
+
+TEST_CASE("Eigenvalue problem and critical tracing with fixed-size arrays", "[fixedsize][crit]")
+{
+    // Argon + Xenon
+    std::valarray<double> Tc_K = { 150.687, 289.733 };
+    std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+    const std::valarray<double> molefrac = { 1.0 };
+    vdWEOS<double> vdW(Tc_K, pc_Pa);
+    auto Zc = 3.0 / 8.0;
+    auto rhoc0 = pc_Pa[0] / (vdW.R(molefrac) * Tc_K[0]) / Zc;
+
+    using ctX = CriticalTracing<decltype(vdW), double, Eigen::ArrayXd>;
+    using ct2 = CriticalTracing<decltype(vdW), double, Eigen::Array2d>;
+
+    SECTION("eigenvalue problem") {
+        for (double z0 : { 0.0, 0.3, 0.9 }) {
+            CAPTURE(z0);
+            const Eigen::ArrayXd rhovecX = (Eigen::ArrayXd(2) << rhoc0, z0*rhoc0).finished();
+            const Eigen::Array2d rhovec2 = rhovecX;
+            auto edX = ctX::eigen_problem(vdW, Tc_K[0], rhovecX);
+            auto ed2 = ct2::eigen_problem(vdW, Tc_K[0], rhovec2);
+            CHECK(ed2.eigenvalues[0] == Approx(edX.eigenvalues[0]));
+            if (z0 == 0.0) {
+                CHECK(edX.eigenvalues.size() == 1);
+                CHECK(std::isinf(ed2.eigenvalues[1]));
+            }
+            else {
+                CHECK(ed2.eigenvalues[1] == Approx(edX.eigenvalues[1]));
+            }
+            CHECK(std::abs(ed2.v0.matrix().dot(edX.v0.matrix())) == Approx(1.0));
+            CHECK(std::abs(ed2.v1.matrix().dot(edX.v1.matrix())) == Approx(1.0));
+
+            auto condsX = ctX::get_criticality_conditions(vdW, Tc_K[0], rhovecX);
+            auto conds2 = ct2::get_criticality_conditions(vdW, Tc_K[0], rhovec2);
+            CHECK(conds2[0] == Approx(condsX[0]));
+            // The sign of the directional derivative follows the sign of the eigenvector
+            CHECK(std::abs(conds2[1]) == Approx(std::abs(condsX[1])).margin(1e-8));
+        }
+    }
+    SECTION("trace") {
+        const Eigen::ArrayXd rhovec0X = (Eigen::ArrayXd(2) << rhoc0, 0.0).finished();
+        const Eigen::Array2d rhovec02 = rhovec0X;
+        auto traceX = ctX::trace_critical_arclength_binary_columnar(vdW, Tc_K[0], rhovec0X);
+        auto trace2 = ct2::trace_critical_arclength_binary_columnar(vdW, Tc_K[0], rhovec02);
+        REQUIRE(trace2.size() > 10);
+        // The steps are not identical because the eigenvectors may differ in sign, which changes the one-sided 
+        // derivatives near infinite dilution, so check that the points are critical instead
+        for (auto i = 0U; i < trace2.size(); ++i) {
+            CAPTURE(i);
+            const Eigen::ArrayXd rhovec = (Eigen::ArrayXd(2) << trace2.rhovec[0][i], trace2.rhovec[1][i]).finished();
+            if ((rhovec > 0).all()) {
+                auto conds = ctX::get_criticality_conditions(vdW, trace2.T[i], rhovec);
+                // The eigenvalues of the Hessian are of the order of RT/rho
+                CHECK(std::abs(conds[0]) < 1e-6*vdW.R(rhovec/rhovec.sum())*trace2.T[i]/rhovec.sum());
+            }
+        }
+        CHECK(trace2.T.front() == Approx(traceX.T.front()));
+    }
+}
+
+TEST_CASE("VLE with fixed-size arrays", "[fixedsize][VLE]")
+{
+    std::valarray<double> Tc_K = { 190.564, 154.581 }, pc_Pa = { 4599200, 5042800 }, acentric = { 0.011, 0.022 };
+    const auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    const auto pure = canonical_PR(std::valarray<double>(Tc_K[0], 1), std::valarray<double>(pc_Pa[0], 1), std::valarray<double>(acentric[0], 1));
+
+    double T = 120;
+    auto [rhoL, rhoV] = pure.superanc_rhoLV(T);
+    auto rhos = pure_VLE_T(pure, T, rhoL, rhoV, 10);
+    Eigen::ArrayXd rhovecL0X = Eigen::ArrayXd::Zero(2), rhovecV0X = Eigen::ArrayXd::Zero(2);
+    rhovecL0X[0] = rhos[0]; rhovecV0X[0] = rhos[1];
+    const Eigen::Array2d rhovecL02 = rhovecL0X, rhovecV02 = rhovecV0X;
+
+    SECTION("isotherm") {
+        auto traceX = trace_VLE_isotherm_binary_columnar(model, T, rhovecL0X, rhovecV0X);
+        auto trace2 = trace_VLE_isotherm_binary_columnar(model, T, rhovecL02, rhovecV02);
+        REQUIRE(trace2.size() > 10);
+        CHECK(trace2.size() == traceX.size());
+        auto n = std::min(trace2.size(), traceX.size());
+        for (auto i = 0U; i < n; ++i) {
+            CAPTURE(i);
+            CHECK(trace2.pL[i] == Approx(traceX.pL[i]).epsilon(1e-6));
+            CHECK(trace2.rhovecV[1][i] == Approx(traceX.rhovecV[1][i]).epsilon(1e-6).margin(1e-6));
+        }
+
+        SECTION("mix_VLE_Tx") {
+            // Solve again at a point in the middle of the isotherm, starting from a perturbed guess
+            auto i = n / 2;
+            const Eigen::ArrayXd rhovecLX = (Eigen::ArrayXd(2) << traceX.rhovecL[0][i], traceX.rhovecL[1][i]).finished();
+            const Eigen::ArrayXd rhovecVX = (Eigen::ArrayXd(2) << traceX.rhovecV[0][i], traceX.rhovecV[1][i]).finished();
+            const Eigen::ArrayXd xX = rhovecLX / rhovecLX.sum();
+            const Eigen::Array2d rhovecL2 = rhovecLX*1.01, rhovecV2 = rhovecVX*0.99, x2 = xX;
+            auto [codeX, rhovecLnewX, rhovecVnewX] = mix_VLE_Tx(model, T, (rhovecLX*1.01).eval(), (rhovecVX*0.99).eval(), xX, 1e-10, 1e-10, 1e-10, 1e-10, 10);
+            auto [code2, rhovecLnew2, rhovecVnew2] = mix_VLE_Tx(model, T, rhovecL2, rhovecV2, x2, 1e-10, 1e-10, 1e-10, 1e-10, 10);
+            static_assert(std::is_same_v<std::decay_t<decltype(rhovecLnew2)>, Eigen::Array2d>);
+            CHECK(code2 == codeX);
+            for (auto k = 0; k < 2; ++k) {
+                CHECK(rhovecLnew2[k] == Approx(rhovecLnewX[k]));
+                CHECK(rhovecVnew2[k] == Approx(rhovecVnewX[k]));
+                CHECK(rhovecLnew2[k] == Approx(rhovecLX[k]).epsilon(1e-6));
+            }
+        }
+    }
+    SECTION("isobar") {
+        double p = rhos[1] * pure.R(std::valarray<double>{ 1.0 }) * T * (1 + TDXDerivatives<decltype(pure)>::get_Ar01(pure, T, rhos[1], Eigen::ArrayXd::Ones(1)));
+        auto traceX = trace_VLE_isobar_binary_columnar(model, p, T, rhovecL0X, rhovecV0X);
+        auto trace2 = trace_VLE_isobar_binary_columnar(model, p, T, rhovecL02, rhovecV02);
+        REQUIRE(trace2.size() > 10);
+        CHECK(trace2.size() == traceX.size());
+        auto n = std::min(trace2.size(), traceX.size());
+        for (auto i = 0U; i < n; ++i) {
+            CAPTURE(i);
+            CHECK(trace2.T[i] == Approx(traceX.T[i]).epsilon(1e-6));
+        }
+    }
+}
@@ -7,6 +7,7 @@ using Catch::Approx;
 #include "teqp/models/multifluid_ancillaries.hpp"
 #include "teqp/algorithms/critical_tracing.hpp"
 #include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/saturation_surrogate.hpp"
 #include "teqp/filesystem.hpp"
 
 using namespace teqp;
@@ -114,6 +115,44 @@ TEST_CASE("Trace critical locus for nitrogen + ethane", "[crit],[multifluid]")
     }
 }
 
+TEST_CASE("Trace a batch of critical loci concurrently", "[crit],[multifluid]")
+{
+    std::string root = "../mycp";
+    std::vector<std::vector<std::string>> pairs = { { "Nitrogen", "Ethane" }, { "BADFLUID", "Ethane" }, { "Methane", "Ethane" } };
+    using ModelType = decltype(build_multifluid_model(pairs[0], root));
+    auto make_jobs = [&root](const std::vector<std::string>& pp) {
+        auto model = std::make_shared<const ModelType>(build_multifluid_model(pp, root));
+        std::vector<CriticalTraceJob<ModelType>> jobs;
+        for (auto ifluid = 0; ifluid < 2; ++ifluid) {
+            Eigen::ArrayXd rhovec0(2); rhovec0 = 0.0; rhovec0[ifluid] = 1.0 / model->redfunc.vc[ifluid];
+            jobs.push_back({ pp[0] + "&" + pp[1], model, model->redfunc.Tc[ifluid], rhovec0 });
+        }
+        return jobs;
+    };
+    TCABOptions opt; opt.init_dt = 100; opt.integration_order = 1;
+    auto results = trace_critical_arclength_binary_batch(pairs, make_jobs, opt, 4);
+
+    // Two traces for each good pair, and one failure for the pair that cannot be built
+    REQUIRE(results.size() == 5);
+    CHECK(results[2].index == 1);
+    CHECK(!results[2].success);
+    CHECK(!results[2].message.empty());
+
+    // The concurrent traces are the same as the serial ones
+    const auto model = build_multifluid_model(pairs[0], root);
+    for (auto ifluid = 0; ifluid < 2; ++ifluid) {
+        const auto& result = results[ifluid];
+        REQUIRE(result.success);
+        CHECK(result.index == 0);
+        Eigen::ArrayXd rhovec0(2); rhovec0 = 0.0; rhovec0[ifluid] = 1.0 / model.redfunc.vc[ifluid];
+        using ct = CriticalTracing<decltype(model), double, Eigen::ArrayXd>;
+        auto j = ct::trace_critical_arclength_binary(model, model.redfunc.Tc[ifluid], rhovec0, "", opt);
+        CHECK(j == result.trace);
+    }
+    CHECK(results[3].success);
+    CHECK(results[4].success);
+}
+
 TEST_CASE("Check that all pure fluid models can be instantiated", "[multifluid],[all]"){
     std::string root = "../mycp";
     SECTION("With absolute paths to json file") {
@@ -162,6 +201,38 @@ TEST_CASE("Check that all ancillaries can be instantiated and work properly", "[
     }
 }
 
+TEST_CASE("Saturation surrogate of a multifluid pure fluid agrees with pure_VLE_T", "[multifluid],[surrogate]") {
+    auto model = build_multifluid_model({ "Methane" }, "../mycp");
+    auto jpure = nlohmann::json::parse(model.get_meta()).at("pures")[0];
+    auto jcrit = jpure.at("STATES").at("critical");
+    // The critical point of the EOS itself, since the expansions run up to just below it
+    auto [Tc, rhoc] = solve_pure_critical(model, jcrit.at("T").get<double>(), jcrit.at("rhomolar").get<double>());
+    const double Tmin = jpure.at("EOS")[0].at("Ttriple");
+    auto wrapped = with_saturation_surrogate(model, Tmin, Tc, rhoc);
+    const auto& surrogate = wrapped.surrogate;
+    CAPTURE(surrogate.get_N_intervals());
+    CHECK(surrogate.rtol_achieved < 1e-10);
+
+    // The saturation states are solved independently of the surrogate, starting from the ancillaries of the fluid
+    MultiFluidVLEAncillaries anc(jpure.at("ANCILLARIES"));
+    using tdx = TDXDerivatives<decltype(model)>;
+    const auto z = (Eigen::ArrayXd(1) << 1.0).finished();
+    for (double T = Tmin; T < surrogate.Tmax; T += 3.1) {
+        CAPTURE(T);
+        auto rhos = pure_VLE_T(model, T, anc.rhoL(T), anc.rhoV(T), 20);
+        auto [rhoLs, rhoVs] = surrogate.rhoLV(T);
+        CHECK(rhoLs == Approx(rhos[0]).epsilon(1e-9));
+        CHECK(rhoVs == Approx(rhos[1]).epsilon(1e-9));
+        double p = rhos[1] * model.R(z) * T * (1.0 + tdx::get_Ar01(model, T, rhos[1], z));
+        CHECK(surrogate.p(T) == Approx(p).epsilon(1e-9));
+
+        // Polishing the densities of the surrogate gives the same solution
+        auto rhospolished = pure_VLE_T_superanc(wrapped, T);
+        CHECK(rhospolished[0] == Approx(rhos[0]).epsilon(1e-11));
+        CHECK(rhospolished[1] == Approx(rhos[1]).epsilon(1e-11));
+    }
+}
+
 TEST_CASE("Check that mixtures can also do absolute paths", "[multifluid],[abspath]") {
     std::string root = "../mycp";
     SECTION("With absolute paths to json file") {
@@ -204,6 +275,89 @@ TEST_CASE("Check that all binary pairs specified in the binary pair file can be
     }
 }
 
+TEST_CASE("Build multifluid models from an indexed fluid library", "[multifluid],[library]") {
+    std::string root = "../mycp";
+    const FluidLibrary library(root);
+    REQUIRE(library.size() == get_files_in_folder(root + "/dev/fluids", ".json").size());
+
+    // Every identifier of the reverse lookup map resolves to the same file
+    for (auto [identifier, path] : build_alias_map(root)) {
+        CAPTURE(identifier);
+        CHECK(library.get_path(identifier) == path);
+    }
+    CHECK(library.get_fluid_JSON("74-82-8").at("INFO").at("NAME") == "Methane");
+    CHECK(library.get_fluid_JSON("PROPANE").at("INFO").at("NAME") == "n-Propane");
+    CHECK_THROWS(library.get_fluid_JSON("NOT_A_FLUID"));
+
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    const auto reference = build_multifluid_model({ "Methane", "n-Propane" }, root);
+    double alphar = reference.alphar(300.0, 3000.0, z);
+    SECTION("by name and by alias") {
+        CHECK(build_multifluid_model({ "Methane", "n-Propane" }, library).alphar(300.0, 3000.0, z) == alphar);
+        CHECK(build_multifluid_model({ "74-82-8", "PROPANE" }, library).alphar(300.0, 3000.0, z) == alphar);
+    }
+    SECTION("reloaded from a binary file") {
+        library.to_binary("fluid_library.cbor");
+        const auto reloaded = FluidLibrary::from_binary("fluid_library.cbor");
+        CHECK(reloaded.size() == library.size());
+        CHECK(reloaded.get_path("PROPANE") == library.get_path("PROPANE"));
+        CHECK(build_multifluid_model({ "Methane", "n-Propane" }, reloaded).alphar(300.0, 3000.0, z) == alphar);
+    }
+    SECTION("shared by the process") {
+        CHECK(FluidLibrary::get_shared(root) == FluidLibrary::get_shared(root + "/"));
+    }
+}
+
+TEST_CASE("Look up binary interaction parameters and departure functions in an index", "[multifluid],[BIP]") {
+    std::string root = "../mycp";
+    const auto BIPcollection = load_a_JSON_file(root + "/dev/mixtures/mixture_binary_pairs.json");
+    const auto depcollection = load_a_JSON_file(root + "/dev/mixtures/mixture_departure_functions.json");
+    const reducing::BinaryPairIndex BIPindex(BIPcollection);
+    const reducing::DepartureFunctionIndex depindex(depcollection);
+
+    SECTION("same entries as the linear search") {
+        nlohmann::json flags = {};
+        for (const auto& el : BIPcollection) {
+            std::vector<std::vector<std::string>> pairs = { {el["Name1"], el["Name2"]}, {el["Name2"], el["Name1"]} };
+            if (el.contains("CAS1") && el.contains("CAS2")) {
+                pairs.push_back({ el["CAS1"], el["CAS2"] });
+                pairs.push_back({ el["CAS2"], el["CAS1"] });
+            }
+            for (const auto& pair : pairs) {
+                CAPTURE(pair);
+                auto [elindex, swapindex] = reducing::get_BIPdep(BIPindex, pair, flags);
+                auto [ellinear, swaplinear] = reducing::get_BIPdep(BIPcollection, pair, flags);
+                CHECK(elindex == ellinear);
+                CHECK(swapindex == swaplinear);
+            }
+        }
+        for (const auto& el : depcollection) {
+            CHECK(depindex.get(el["Name"]) == el);
+        }
+    }
+    SECTION("missing entries") {
+        std::vector<std::string> pair = { "NOT_A_FLUID", "Methane" };
+        CHECK_THROWS(reducing::get_BIPdep(BIPindex, pair, {}));
+        auto [el, swap] = reducing::get_BIPdep(BIPindex, pair, { {"estimate", "Lorentz-Berthelot"} });
+        CHECK(el == std::get<0>(reducing::get_BIPdep(BIPcollection, pair, { {"estimate", "Lorentz-Berthelot"} })));
+        CHECK_THROWS(depindex.get("NOT_A_DEPARTURE_FUNCTION"));
+    }
+    SECTION("same models") {
+        std::vector<nlohmann::json> pureJSON;
+        for (auto name : { "Methane", "Ethane", "n-Propane", "Nitrogen" }) {
+            pureJSON.push_back(load_a_JSON_file(root + "/dev/fluids/" + name + ".json"));
+        }
+        auto z = (Eigen::ArrayXd(4) << 0.4, 0.3, 0.2, 0.1).finished();
+        const auto linear = _build_multifluid_model(pureJSON, BIPcollection, depcollection);
+        const auto indexed = _build_multifluid_model(pureJSON, BIPindex, depindex);
+        CHECK(indexed.alphar(300.0, 3000.0, z) == linear.alphar(300.0, 3000.0, z));
+        CHECK(indexed.get_meta() == linear.get_meta());
+
+        std::vector<std::string> identifiers = { "Methane", "Ethane", "n-Propane", "Nitrogen" };
+        CHECK(reducing::get_F_matrix(BIPindex, identifiers, {}) == reducing::get_F_matrix(BIPcollection, identifiers, {}));
+    }
+}
+
 TEST_CASE("Check that all pure fluid models can be evaluated at zero density", "[multifluid],[all],[virial]") {
     std::string root = "../mycp";
     SECTION("With filename stems") {
@@ -299,4 +453,98 @@ TEST_CASE("Calculate partial molar volume for a CO2 containing mixture", "[parti
     for (auto i = 0; i < expected.size(); ++i){
         CHECK(expected[i] == Approx(der[i]));
     }
-}
\ No newline at end of file
+}
+TEST_CASE("Check that a bound multifluid model gives the same results as the model", "[multifluid],[bind]") {
+    std::string root = "../mycp";
+    auto check = [](const auto& model, double T, double rho, const Eigen::ArrayXd& z) {
+        auto bound = model.bind(T, z);
+        using tdx = TDXDerivatives<decltype(model), double, Eigen::ArrayXd>;
+        using tdxb = TDXDerivatives<decltype(bound), double, Eigen::ArrayXd>;
+        CHECK(bound.alphar(rho) == Approx(model.alphar(T, rho, z)).epsilon(1e-14));
+        CHECK(tdxb::get_Ar01(bound, T, rho, z) == Approx(tdx::get_Ar01(model, T, rho, z)).epsilon(1e-14));
+        auto Ar0n = tdx::template get_Ar0n<4>(model, T, rho, z);
+        auto Ar0nb = tdxb::template get_Ar0n<4>(bound, T, rho, z);
+        for (auto n = 0; n <= 4; ++n) {
+            CAPTURE(n);
+            CHECK(Ar0nb[n] == Approx(Ar0n[n]).epsilon(1e-13));
+        }
+        // Zero density goes through the integer powers of delta
+        CHECK(tdxb::get_Ar01(bound, T, 0.0, z) == Approx(tdx::get_Ar01(model, T, 0.0, z)).margin(1e-15));
+        CHECK_THROWS(bound.alphar(T + 1, rho, z));
+        // Another composition, or another number of components
+        Eigen::ArrayXd zother = z; zother[0] += 1e-6; zother[1] -= 1e-6;
+        CHECK_THROWS(bound.alphar(T, rho, zother));
+        CHECK_THROWS(tdxb::get_Ar01(bound, T, rho, zother));
+        CHECK_THROWS(bound.alphar(T, rho, Eigen::ArrayXd::Ones(1)));
+    };
+    SECTION("Methane + Ethane") {
+        check(build_multifluid_model({ "Methane", "Ethane" }, root), 200, 8000, (Eigen::ArrayXd(2) << 0.4, 0.6).finished());
+    }
+    SECTION("CarbonDioxide + Water (non-analytic terms)") {
+        check(build_multifluid_model({ "CarbonDioxide", "Water" }, root), 320, 20000, (Eigen::ArrayXd(2) << 0.1, 0.9).finished());
+    }
+}
+
+/// Check the closed-form derivative (iT, iD) against autodiff, and then move on to the next one with iT+iD <= 4
+template<int iT = 0, int iD = 0, typename Model>
+void check_analytic_derivatives(const Model& model, double T, double rho, const Eigen::ArrayXd& z) {
+    using tdx = TDXDerivatives<Model, double, Eigen::ArrayXd>;
+    auto ad = tdx::template get_Arxy<iT, iD, ADBackends::autodiff>(model, T, rho, z);
+    auto an = tdx::template get_Arxy<iT, iD, ADBackends::analytic>(model, T, rho, z);
+    CAPTURE(iT);
+    CAPTURE(iD);
+    CHECK(an == Approx(ad).epsilon(1e-11).margin(1e-13));
+    if constexpr (iT + iD < 4) {
+        check_analytic_derivatives<iT, iD + 1>(model, T, rho, z);
+    }
+    else if constexpr (iT < 4) {
+        check_analytic_derivatives<iT + 1, 0>(model, T, rho, z);
+    }
+}
+
+TEST_CASE("Check closed-form tau/delta derivatives against autodiff", "[multifluid],[analytic]") {
+    std::string root = "../mycp";
+    SECTION("All pure fluids") {
+        for (auto path : get_files_in_folder(root + "/dev/fluids", ".json")) {
+            auto stem = path.filename().stem().string(); // filename without the .json
+            if (stem == "Methanol") { continue; }
+            auto model = build_multifluid_model({ stem }, root);
+            Eigen::ArrayXd z = Eigen::ArrayXd::Ones(1);
+            double T = 1.3 * model.redfunc.Tc[0], rho = 0.9 / model.redfunc.vc[0];
+            CAPTURE(stem);
+            check_analytic_derivatives(model, T, rho, z);
+        }
+    }
+    SECTION("Methane + Ethane") {
+        auto model = build_multifluid_model({ "Methane", "Ethane" }, root);
+        auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+        check_analytic_derivatives(model, 200, 8000, z);
+
+        using tdx = TDXDerivatives<decltype(model), double, Eigen::ArrayXd>;
+        auto Ar0nad = tdx::get_Ar0n<4>(model, 200, 8000, z);
+        auto Ar0nan = tdx::get_Ar0n<4, ADBackends::analytic>(model, 200, 8000, z);
+        for (auto n = 0; n <= 4; ++n) {
+            CAPTURE(n);
+            CHECK(Ar0nan[n] == Approx(Ar0nad[n]).epsilon(1e-12));
+        }
+        // At zero density, the density derivatives all vanish
+        CHECK(tdx::get_Ar01<ADBackends::analytic>(model, 200, 0.0, z) == 0.0);
+    }
+    SECTION("CarbonDioxide + Water (non-analytic terms)") {
+        auto model = build_multifluid_model({ "CarbonDioxide", "Water" }, root);
+        auto z = (Eigen::ArrayXd(2) << 0.1, 0.9).finished();
+        check_analytic_derivatives(model, 320, 20000, z);
+
+        // Lower orders give the same elements, and leave the higher ones at zero
+        auto full = model.alphar_taudeltaderivs(320, 20000, z);
+        for (auto order = 0; order < 4; ++order) {
+            auto o = model.alphar_taudeltaderivs(320, 20000, z, order);
+            for (auto i = 0; i <= 4; ++i) {
+                for (auto j = 0; i + j <= 4; ++j) {
+                    CAPTURE(order, i, j);
+                    CHECK(o(i, j) == ((i + j <= order) ? full(i, j) : 0.0));
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,153 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include "teqp/json_builder.hpp"
+#include "teqp/derivs.hpp"
+#include "teqp/serialization.hpp"
+
+using namespace teqp;
+
+/// Evaluate alphar and some of its derivatives at a few state points, as a flat array to be compared exactly
+template<typename Model>
+Eigen::ArrayXd evaluate_alphar(const Model& model, const Eigen::ArrayXd& z) {
+    using tdx = TDXDerivatives<Model>;
+    std::vector<double> o;
+    for (double T : {250.0, 300.0, 400.0}) {
+        for (double rho : {1e-3, 10.0, 1000.0}) {
+            o.push_back(model.alphar(T, rho, z));
+            o.push_back(tdx::get_Ar01(model, T, rho, z));
+            o.push_back(tdx::get_Ar10(model, T, rho, z));
+        }
+    }
+    return Eigen::Map<Eigen::ArrayXd>(&(o[0]), o.size());
+}
+
+TEST_CASE("Round trip of each of the AllowedModels through the binary format", "[serialization]")
+{
+    std::vector<std::pair<nlohmann::json, Eigen::ArrayXd>> specs;
+    auto z1 = (Eigen::ArrayXd(1) << 1.0).finished();
+    auto z2 = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+
+    specs.emplace_back(nlohmann::json{ {"kind", "vdW1"}, {"model", {{"a", 1.0}, {"b", 2e-5}}} }, z1);
+    specs.emplace_back(nlohmann::json{ {"kind", "PR"}, {"model", {{"Tcrit / K", {190.564, 305.32}}, {"pcrit / Pa", {4599200, 4872200}}, {"acentric", {0.011, 0.099}}}} }, z2);
+    specs.emplace_back(nlohmann::json{ {"kind", "SRK"}, {"model", {{"Tcrit / K", {190.564, 305.32}}, {"pcrit / Pa", {4599200, 4872200}}, {"acentric", {0.011, 0.099}}}} }, z2);
+    nlohmann::json water = {
+        {"a0i / Pa m^6/mol^2",0.12277 }, {"bi / m^3/mol", 0.000014515}, {"c1", 0.67359}, {"Tc / K", 647.096},
+        {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"class", "4C"}
+    };
+    specs.emplace_back(nlohmann::json{ {"kind", "CPA"}, {"model", {{"cubic", "SRK"}, {"pures", {water}}, {"R_gas / J/mol/K", 8.3144598}}} }, z1);
+    nlohmann::json jPCSAFT = nlohmann::json::array();
+    jPCSAFT.push_back({ {"name", "Methane"}, { "m", 1.0 }, { "sigma_Angstrom", 3.7039},{"epsilon_over_k", 150.03}, {"BibTeXKey", "Gross-IECR-2001"} });
+    jPCSAFT.push_back({ {"name", "Ethane"}, { "m", 1.6069 }, { "sigma_Angstrom", 3.5206},{"epsilon_over_k", 191.42}, {"BibTeXKey", "Gross-IECR-2001"} });
+    specs.emplace_back(nlohmann::json{ {"kind", "PCSAFT"}, {"model", jPCSAFT} }, z2);
+    // Methane has Gaussian and power terms, CO2 a non-analytic term, and the pair a GERG-2008 departure function
+    nlohmann::json jMF = {
+        {"components", {"../mycp/dev/fluids/Methane.json", "../mycp/dev/fluids/CarbonDioxide.json"}},
+        {"BIP", "../mycp/dev/mixtures/mixture_binary_pairs.json"},
+        {"departure", "../mycp/dev/mixtures/mixture_departure_functions.json"}
+    };
+    specs.emplace_back(nlohmann::json{ {"kind", "multifluid"}, {"model", jMF} }, z2);
+
+    for (const auto& [spec, z] : specs) {
+        CAPTURE(spec.at("kind"));
+        const AllowedModels model = build_model(spec);
+        auto blob = model_to_binary(model);
+        const AllowedModels restored = model_from_binary(blob);
+        REQUIRE(restored.index() == model.index());
+        // Storing the restored model gives the same bytes
+        CHECK(model_to_binary(restored) == blob);
+        // And the model gives exactly the same values
+        std::visit([&z = z, &restored](const auto& m) {
+            const auto& r = std::get<std::decay_t<decltype(m)>>(restored);
+            CHECK((evaluate_alphar(m, z) == evaluate_alphar(r, z)).all());
+        }, model);
+    }
+}
+
+TEST_CASE("The options of the CPA association term survive the round trip", "[serialization][CPA]")
+{
+    nlohmann::json water = {
+        {"a0i / Pa m^6/mol^2",0.12277 }, {"bi / m^3/mol", 0.000014515}, {"c1", 0.67359}, {"Tc / K", 647.096},
+        {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"class", "4C"}
+    };
+    using CPAModel = std::decay_t<decltype(CPA::CPAfactory(nlohmann::json{}))>;
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    for (bool warm_start : { false, true }) {
+        CAPTURE(warm_start);
+        nlohmann::json jCPA = { {"cubic", "SRK"}, {"pures", {water, water}}, {"R_gas / J/mol/K", 8.3144598}, {"radial_dist", "CS"}, {"warm_start", warm_start} };
+        const AllowedModels model = build_model(nlohmann::json{ {"kind", "CPA"}, {"model", jCPA} });
+        auto blob = model_to_binary(model);
+        const AllowedModels restored = model_from_binary(blob);
+        REQUIRE(std::holds_alternative<CPAModel>(restored));
+        const auto& m = std::get<CPAModel>(model);
+        const auto& r = std::get<CPAModel>(restored);
+        CHECK(r.assoc.get_warm_start() == warm_start);
+        // With another radial distribution function than the default, so that it is seen if it is lost
+        CHECK(r.alphar(300.0, 50000.0, z) == Approx(m.alphar(300.0, 50000.0, z)).epsilon(1e-14));
+        CHECK(model_to_binary(restored) == blob);
+    }
+}
+
+TEST_CASE("Invalid binary data is rejected", "[serialization]")
+{
+    const AllowedModels model = build_model(nlohmann::json{ {"kind", "vdW1"}, {"model", {{"a", 1.0}, {"b", 2e-5}}} });
+    auto blob = model_to_binary(model);
+    SECTION("truncated") {
+        blob.pop_back();
+        CHECK_THROWS_AS(model_from_binary(blob), teqp::InvalidArgument);
+    }
+    SECTION("trailing bytes") {
+        blob.push_back(0);
+        CHECK_THROWS_AS(model_from_binary(blob), teqp::InvalidArgument);
+    }
+    SECTION("not a model") {
+        blob[0] = 'x';
+        CHECK_THROWS_AS(model_from_binary(blob), teqp::InvalidArgument);
+    }
+    SECTION("other version") {
+        blob[4] += 1;
+        CHECK_THROWS_AS(model_from_binary(blob), teqp::InvalidArgument);
+    }
+    SECTION("length of the kind larger than the blob") {
+        // The kind is stored after the magic bytes, the version and the byte order marker
+        std::fill(blob.begin() + 12, blob.begin() + 20, std::uint8_t(0xFF));
+        CHECK_THROWS_AS(model_from_binary(blob), teqp::InvalidArgument);
+    }
+}
+
+TEST_CASE("Lengths that do not fit in the binary data are rejected before allocating", "[serialization]")
+{
+    auto with_lengths = [](std::initializer_list<std::uint64_t> lengths) {
+        serialization::BinaryWriter w;
+        for (auto N : lengths) { w.put(N); }
+        return w.release();
+    };
+    using serialization::BinaryReader;
+    {
+        auto blob = with_lengths({ std::uint64_t(1) << 62 });
+        BinaryReader r(blob);
+        CHECK_THROWS_AS(r.get<std::string>(), teqp::InvalidArgument);
+    }
+    {
+        auto blob = with_lengths({ std::uint64_t(1) << 40 });
+        BinaryReader r(blob);
+        CHECK_THROWS_AS(r.get<std::vector<std::vector<double>>>(), teqp::InvalidArgument);
+    }
+    {
+        auto blob = with_lengths({ std::uint64_t(1) << 32, std::uint64_t(1) << 32 });
+        BinaryReader r(blob);
+        CHECK_THROWS_AS(r.get<Eigen::ArrayXXd>(), teqp::InvalidArgument);
+    }
+    {
+        auto blob = with_lengths({ 0, ~std::uint64_t(0) });
+        BinaryReader r(blob);
+        CHECK_THROWS_AS(r.get<Eigen::ArrayXXd>(), teqp::InvalidArgument);
+    }
+    {
+        auto blob = with_lengths({ 4, 1, 0, 0, 0, 0 });
+        BinaryReader r(blob);
+        CHECK_THROWS_AS((r.get<Eigen::Array<double, 3, 1>>()), teqp::InvalidArgument);
+    }
+}
@@ -0,0 +1,81 @@
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_approx.hpp>
+
+using Catch::Approx;
+
+#include "teqp/models/cubics.hpp"
+#include "teqp/derivs.hpp"
+#include "teqp/algorithms/VLE.hpp"
+#include "teqp/algorithms/saturation_surrogate.hpp"
+#include "teqp/models/chebyshev_surrogate.hpp"
+
+using namespace teqp;
+
+TEST_CASE("Saturation surrogate of a cubic agrees with its superancillary", "[cubic][superanc][surrogate]")
+{
+    std::valarray<double> Tc_K = { 190.564 }, pc_Pa = { 4599200 }, acentric = { 0.011 };
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    double rhoc = pc_Pa[0] / (0.3074 * model.R(acentric) * Tc_K[0]); // Zc of Peng-Robinson
+    SaturationSurrogateOptions options;
+    options.rtol = 1e-12;
+    auto wrapped = with_saturation_surrogate(model, 90.0, Tc_K[0], rhoc, options);
+    const auto& surrogate = wrapped.surrogate;
+    CAPTURE(surrogate.get_N_intervals());
+    CHECK(surrogate.rtol_achieved < 1e-11);
+    static_assert(has_superanc_rhoLV<decltype(wrapped)>::value);
+    CHECK(wrapped.get_meta() == model.get_meta());
+
+    for (double T = 90.0; T < surrogate.Tmax; T += 1.37) {
+        CAPTURE(T);
+        auto [rhoL, rhoV] = model.superanc_rhoLV(T);
+        auto [rhoLs, rhoVs] = surrogate.rhoLV(T);
+        CHECK(rhoLs == Approx(rhoL).epsilon(1e-11));
+        CHECK(rhoVs == Approx(rhoV).epsilon(1e-11));
+
+        // The wrapped model answers saturation queries from the surrogate
+        auto rhos = pure_VLE_T_superanc(wrapped, T, 0);
+        CHECK(rhos[0] == rhoLs);
+        CHECK(rhos[1] == rhoVs);
+    }
+    CHECK_THROWS(surrogate.rhoLV(80.0));
+    CHECK_THROWS(surrogate.rhoLV(Tc_K[0]));
+}
+
+TEST_CASE("Chebyshev surrogate of a cubic mixture", "[cubic][surrogate]")
+{
+    std::valarray<double> Tc_K = { 190.564, 305.32 }, pc_Pa = { 4599200, 4872200 }, acentric = { 0.011, 0.099 };
+    auto model = canonical_PR(Tc_K, pc_Pa, acentric);
+    auto z = (Eigen::ArrayXd(2) << 0.7, 0.3).finished();
+    auto surrogate = build_Chebyshev_surrogate(model, z, 250.0, 400.0, 0.0, 8000.0, {}, 2);
+
+    const auto& e = surrogate.get_errors();
+    CHECK(e.Ar00 < 1e-12);
+    CHECK(e.Ar01 < 1e-11);
+    CHECK(e.Ar10 < 1e-11);
+    CHECK(e.Ar02 < 1e-9);
+    CHECK(e.Ar11 < 1e-9);
+    CHECK(e.Ar20 < 1e-9);
+    // The expansions have converged in each patch
+    auto tails = surrogate.get_tails();
+    CHECK(tails.size() == 4);
+    for (auto tail : tails) {
+        CHECK(tail < 1e-12);
+    }
+
+    using tdx = TDXDerivatives<decltype(model)>;
+    using tdxs = TDXDerivatives<decltype(surrogate)>;
+    double T = 313.3, rho = 4321.0;
+    CHECK(tdxs::get_Ar01(surrogate, T, rho, z) == Approx(tdx::get_Ar01(model, T, rho, z)).epsilon(1e-10));
+    CHECK(tdxs::get_Ar20(surrogate, T, rho, z) == Approx(tdx::get_Ar20(model, T, rho, z)).epsilon(1e-8));
+    // The closed-form derivatives agree with those from autodiff of the expansions
+    auto ders = tdxs::get_Ar0n<4>(surrogate, T, rho, z);
+    auto dersa = tdxs::get_Ar0n<4, ADBackends::analytic>(surrogate, T, rho, z);
+    for (auto n = 0; n <= 4; ++n) {
+        CHECK(dersa[n] == Approx(ders[n]).epsilon(1e-12));
+    }
+    CHECK(tdxs::get_Arxy<2, 2, ADBackends::analytic>(surrogate, T, rho, z) == Approx(tdxs::get_Arxy<2, 2, ADBackends::autodiff>(surrogate, T, rho, z)).epsilon(1e-10));
+
+    CHECK_THROWS(surrogate.alphar(200.0, rho, z));
+    CHECK_THROWS(surrogate.alphar(T, 9000.0, z));
+    CHECK_THROWS(surrogate.alphar(T, rho, (Eigen::ArrayXd(2) << 0.5, 0.5).finished()));
+}
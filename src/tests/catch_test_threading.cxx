@@ -0,0 +1,96 @@
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+
+#include "teqp/json_builder.hpp"
+#include "teqp/derivs.hpp"
+#include "teqp/parallel.hpp"
+#include "teqp/models/multifluid_mutant.hpp"
+
+using namespace teqp;
+
+/**
+* Evaluate a set of alphar derivatives of the model at a few state points; the
+* results are returned as a flat array so they can be compared bitwise
+*/
+template<typename Model>
+Eigen::ArrayXd evaluate_derivatives(const Model& model, const Eigen::ArrayXd& z) {
+    using tdx = TDXDerivatives<Model>;
+    std::vector<double> o;
+    for (double T : {250.0, 300.0, 400.0}) {
+        for (double rho : {1e-3, 10.0, 1000.0}) {
+            o.push_back(model.alphar(T, rho, z));
+            o.push_back(tdx::get_Ar01(model, T, rho, z));
+            o.push_back(tdx::get_Ar10(model, T, rho, z));
+            o.push_back(tdx::get_Ar02(model, T, rho, z));
+            o.push_back(tdx::template get_Arxy<1, 1, ADBackends::autodiff>(model, T, rho, z));
+        }
+    }
+    return Eigen::Map<Eigen::ArrayXd>(&(o[0]), o.size());
+}
+
+/**
+* Evaluate the shared model concurrently from several threads, many times each,
+* and check that every evaluation reproduces the serial result exactly
+*/
+template<typename Model>
+void check_concurrent_evaluation(const Model& model, const Eigen::ArrayXd& z) {
+    const auto serial = evaluate_derivatives(model, z);
+    const std::size_t Nthreads = 8, Nrepeats = 50;
+    std::atomic<std::size_t> Nmismatch{ 0 };
+    parallel_for_chunks(Nthreads*Nrepeats, Nthreads, [&](std::size_t ibegin, std::size_t iend) {
+        for (auto i = ibegin; i < iend; ++i) {
+            auto vals = evaluate_derivatives(model, z);
+            if ((vals != serial).any()) {
+                ++Nmismatch;
+            }
+        }
+    });
+    CHECK(Nmismatch == 0);
+}
+
+TEST_CASE("Concurrent evaluation of one shared instance of each of the AllowedModels", "[threads]")
+{
+    std::vector<std::pair<nlohmann::json, Eigen::ArrayXd>> specs;
+    auto z1 = (Eigen::ArrayXd(1) << 1.0).finished();
+    auto z2 = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+
+    specs.emplace_back(nlohmann::json{ {"kind", "vdW1"}, {"model", {{"a", 1.0}, {"b", 2e-5}}} }, z1);
+    specs.emplace_back(nlohmann::json{ {"kind", "PR"}, {"model", {{"Tcrit / K", {190.564, 305.32}}, {"pcrit / Pa", {4599200, 4872200}}, {"acentric", {0.011, 0.099}}}} }, z2);
+    nlohmann::json water = {
+        {"a0i / Pa m^6/mol^2",0.12277 }, {"bi / m^3/mol", 0.000014515}, {"c1", 0.67359}, {"Tc / K", 647.096},
+        {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"class", "4C"}
+    };
+    specs.emplace_back(nlohmann::json{ {"kind", "CPA"}, {"model", {{"cubic", "SRK"}, {"pures", {water}}, {"R_gas / J/mol/K", 8.3144598}}} }, z1);
+    nlohmann::json jPCSAFT = nlohmann::json::array();
+    jPCSAFT.push_back({ {"name", "Methane"}, { "m", 1.0 }, { "sigma_Angstrom", 3.7039},{"epsilon_over_k", 150.03}, {"BibTeXKey", "Gross-IECR-2001"} });
+    jPCSAFT.push_back({ {"name", "Ethane"}, { "m", 1.6069 }, { "sigma_Angstrom", 3.5206},{"epsilon_over_k", 191.42}, {"BibTeXKey", "Gross-IECR-2001"} });
+    specs.emplace_back(nlohmann::json{ {"kind", "PCSAFT"}, {"model", jPCSAFT} }, z2);
+    nlohmann::json jMF = {
+        {"components", {"../mycp/dev/fluids/Methane.json", "../mycp/dev/fluids/Ethane.json"}},
+        {"BIP", "../mycp/dev/mixtures/mixture_binary_pairs.json"},
+        {"departure", "../mycp/dev/mixtures/mixture_departure_functions.json"}
+    };
+    specs.emplace_back(nlohmann::json{ {"kind", "multifluid"}, {"model", jMF} }, z2);
+
+    for (const auto& [spec, z] : specs) {
+        CAPTURE(spec.at("kind"));
+        const AllowedModels model = build_model(spec);
+        std::visit([&z = z](const auto& model) { check_concurrent_evaluation(model, z); }, model);
+    }
+}
+
+TEST_CASE("Concurrent evaluation of a shared mutant with Chebyshev departure function", "[threads]")
+{
+    std::string root = "../mycp";
+    nlohmann::json flags = { {"estimate", "Lorentz-Berthelot"} };
+    auto BIPcollection = root + "/dev/mixtures/mixture_binary_pairs.json";
+    auto model = build_multifluid_model({ "R32", "R1234ZEE" }, root, BIPcollection, flags);
+
+    std::string s = R"({"0": {"1": {"BIP": {"betaT": 1.0, "gammaT": 1.0, "betaV": 1.0, "gammaV": 1.0, "Fij": 1.0},
+    "departure": {"type": "Chebyshev2D", "a":[1,2,3,4,1,2,3,4,1,2,3,4,1,2,3,4], "taumin": 1e-10, "taumax": 5, "deltamin": 1e-6, "deltamax": 4, "Ntau":3, "Ndelta":3
+    }}}})";
+    const auto mutant = build_multifluid_mutant(model, nlohmann::json::parse(s));
+    auto z = (Eigen::ArrayXd(2) << 0.4, 0.6).finished();
+    check_concurrent_evaluation(mutant, z);
+}
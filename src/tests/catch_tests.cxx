@@ -281,6 +281,82 @@ TEST_CASE("Trace critical locus for vdW", "[vdW][crit]")
     CHECK(max_spluses.min() > -log(1 - 1.0 / 3.0));
 }
 
+TEST_CASE("Pass the points of a critical trace to an observer", "[vdW][crit]")
+{
+    // Argon + Xenon
+    std::valarray<double> Tc_K = { 150.687, 289.733 };
+    std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+    const std::valarray<double> molefrac = { 1.0 };
+    vdWEOS<double> vdW(Tc_K, pc_Pa);
+    auto Zc = 3.0 / 8.0;
+    auto rhoc0 = pc_Pa[0] / (vdW.R(molefrac) * Tc_K[0]) / Zc;
+    Eigen::ArrayXd rhovec0(2); rhovec0 = 0.0; rhovec0[0] = rhoc0;
+
+    using ct = CriticalTracing<decltype(vdW), double, Eigen::ArrayXd>;
+    TCABOptions opt;
+    auto trace = ct::trace_critical_arclength_binary(vdW, Tc_K[0], rhovec0, "", opt);
+
+    SECTION("all columns") {
+        std::vector<CriticalTracePoint> points;
+        auto N = ct::trace_critical_arclength_binary_observed(vdW, Tc_K[0], rhovec0, [&points](const CriticalTracePoint& pt) { points.push_back(pt); }, {}, "", opt);
+        REQUIRE(N == trace.size());
+        REQUIRE(points.size() == trace.size());
+        for (auto i = 0U; i < points.size(); ++i) {
+            CHECK(points[i].T == trace[i].at("T / K").get<double>());
+            CHECK(points[i].splus.value() == trace[i].at("s^+").get<double>());
+            CHECK(points[i].p.value() == trace[i].at("p / Pa").get<double>());
+            CHECK(points[i].criticality_conditions.value()[0] == trace[i].at("lambda1").get<double>());
+        }
+    }
+    SECTION("only the state, stopped by the observer") {
+        CriticalTraceColumns columns;
+        columns.p = false; columns.splus = false; columns.derivatives = false; columns.criticality_conditions = false;
+        std::size_t Ncalls = 0;
+        auto observer = [&Ncalls](const CriticalTracePoint& pt) {
+            CHECK(!pt.p); CHECK(!pt.splus); CHECK(!pt.dTdt); CHECK(!pt.criticality_conditions);
+            return ++Ncalls < 5;
+        };
+        auto N = ct::trace_critical_arclength_binary_observed(vdW, Tc_K[0], rhovec0, observer, columns, "", opt);
+        CHECK(N == 5);
+        CHECK(Ncalls == 5);
+    }
+}
+
+TEST_CASE("Store the points of a critical trace column-wise", "[vdW][crit]")
+{
+    // Argon + Xenon
+    std::valarray<double> Tc_K = { 150.687, 289.733 };
+    std::valarray<double> pc_Pa = { 4863000.0, 5842000.0 };
+    const std::valarray<double> molefrac = { 1.0 };
+    vdWEOS<double> vdW(Tc_K, pc_Pa);
+    auto Zc = 3.0 / 8.0;
+    auto rhoc0 = pc_Pa[0] / (vdW.R(molefrac) * Tc_K[0]) / Zc;
+    Eigen::ArrayXd rhovec0(2); rhovec0 = 0.0; rhovec0[0] = rhoc0;
+
+    using ct = CriticalTracing<decltype(vdW), double, Eigen::ArrayXd>;
+    TCABOptions opt;
+    opt.calc_stability = true;
+    auto trace = ct::trace_critical_arclength_binary(vdW, Tc_K[0], rhovec0, "", opt);
+    auto data = ct::trace_critical_arclength_binary_columnar(vdW, Tc_K[0], rhovec0, {}, "", opt);
+    REQUIRE(data.size() == trace.size());
+    REQUIRE(data.rhovec.size() == 2);
+    CHECK(data.locally_stable.size() == data.size());
+    for (auto i = 0U; i < data.size(); ++i) {
+        CHECK(data.T[i] == trace[i].at("T / K").get<double>());
+        CHECK(data.rhovec[1][i] == trace[i].at("rho1 / mol/m^3").get<double>());
+        CHECK(data.drhovecdt[0][i] == trace[i].at("drho0/dt").get<double>());
+    }
+    CHECK(data.to_JSON() == trace);
+
+    CriticalTraceColumns columns;
+    columns.splus = false; columns.criticality_conditions = false;
+    auto partial = ct::trace_critical_arclength_binary_columnar(vdW, Tc_K[0], rhovec0, columns, "", opt);
+    CHECK(partial.size() == data.size());
+    CHECK(partial.splus.empty());
+    CHECK(partial.lambda1.empty());
+    CHECK(partial.p.size() == partial.size());
+}
+
 TEST_CASE("Check criticality conditions for vdW", "[vdW][crit]")
 {
     // Argon
@@ -475,6 +551,181 @@ TEST_CASE("Test water w/ factory", "") {
    //REQUIRE(p_withassoc == 3.14);
 }
 
+auto build_CPA_water_methanol_MEG(bool warm_start = false) {
+    nlohmann::json water = {
+        {"a0i / Pa m^6/mol^2",0.12277 }, {"bi / m^3/mol", 0.000014515}, {"c1", 0.67359}, {"Tc / K", 647.096},
+        {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"class","4C"}
+    };
+    nlohmann::json methanol = {
+        {"a0i / Pa m^6/mol^2",0.40531 }, {"bi / m^3/mol", 0.000030978}, {"c1", 0.43102}, {"Tc / K", 512.64},
+        {"epsABi / J/mol", 24591.0}, {"betaABi", 0.0161}, {"class","2B"}
+    };
+    nlohmann::json MEG = {
+        {"a0i / Pa m^6/mol^2",1.0810 }, {"bi / m^3/mol", 0.0000514}, {"c1", 0.6744}, {"Tc / K", 720.0},
+        {"epsABi / J/mol", 19752.0}, {"betaABi", 0.0141}, {"class","4C"}
+    };
+    nlohmann::json j = { {"cubic","SRK"}, {"pures", {water, methanol, MEG}}, {"R_gas / J/mol/K", 8.3144598}, {"warm_start", warm_start} };
+    return CPA::CPAfactory(j);
+}
+
+TEST_CASE("Test water as a mixture of water and water", "[CPA]") {
+    nlohmann::json water = {
+        {"a0i / Pa m^6/mol^2",0.12277 }, {"bi / m^3/mol", 0.000014515}, {"c1", 0.67359}, {"Tc / K", 647.096},
+        {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"class","4C"}
+    };
+    auto pure = CPA::CPAfactory({ {"cubic","SRK"}, {"pures", {water}}, {"R_gas / J/mol/K", 8.3144598} });
+    auto mix = CPA::CPAfactory({ {"cubic","SRK"}, {"pures", {water, water}}, {"R_gas / J/mol/K", 8.3144598} });
+
+    double T = 400;
+    auto z1 = (Eigen::ArrayXd(1) << 1).finished();
+    auto z2 = (Eigen::ArrayXd(2) << 0.3, 0.7).finished();
+    using tdx = TDXDerivatives<decltype(pure)>;
+    for (double rhomolar : { 100.0, 1000.0, 50000.0 }) {
+        CAPTURE(rhomolar);
+        CHECK(mix.alphar(T, rhomolar, z2) == Approx(pure.alphar(T, rhomolar, z1)).epsilon(1e-12));
+        CHECK(tdx::get_Ar01(mix, T, rhomolar, z2) == Approx(tdx::get_Ar01(pure, T, rhomolar, z1)).epsilon(1e-12));
+        CHECK(tdx::get_Ar10(mix, T, rhomolar, z2) == Approx(tdx::get_Ar10(pure, T, rhomolar, z1)).epsilon(1e-12));
+    }
+}
+
+TEST_CASE("The radial distribution function of CPA is set in the JSON", "[CPA]") {
+    nlohmann::json water = {
+        {"a0i / Pa m^6/mol^2",0.12277 }, {"bi / m^3/mol", 0.000014515}, {"c1", 0.67359}, {"Tc / K", 647.096},
+        {"epsABi / J/mol", 16655.0}, {"betaABi", 0.0692}, {"class","4C"}
+    };
+    auto build = [&](const std::vector<nlohmann::json>& pures, const std::string& dist) {
+        nlohmann::json j = { {"cubic","SRK"}, {"pures", pures}, {"R_gas / J/mol/K", 8.3144598} };
+        if (!dist.empty()) { j["radial_dist"] = dist; }
+        return CPA::CPAfactory(j);
+    };
+    double T = 400, rhomolar = 40000;
+    auto z1 = (Eigen::ArrayXd(1) << 1).finished();
+    auto z2 = (Eigen::ArrayXd(2) << 0.3, 0.7).finished();
+    // KG is the default
+    CHECK(build({ water }, "KG").alphar(T, rhomolar, z1) == build({ water }, "").alphar(T, rhomolar, z1));
+    CHECK(build({ water }, "CS").alphar(T, rhomolar, z1) != build({ water }, "KG").alphar(T, rhomolar, z1));
+    // The explicit solution for pure fluids and the iterative one for mixtures use the same function
+    for (std::string dist : { "CS", "KG", "OT" }) {
+        CAPTURE(dist);
+        CHECK(build({ water, water }, dist).alphar(T, rhomolar, z2) == Approx(build({ water }, dist).alphar(T, rhomolar, z1)).epsilon(1e-12));
+    }
+    CHECK_THROWS(build({ water }, "XX"));
+}
+
+TEST_CASE("Check site fractions of water + methanol + MEG", "[CPA]") {
+    auto model = build_CPA_water_methanol_MEG();
+    double T = 350;
+    auto z = (Eigen::ArrayXd(3) << 0.5, 0.3, 0.2).finished();
+    const auto n = model.assoc.get_N_sites_total();
+    REQUIRE(n == 10);
+
+    for (double rhomolar : { 10.0, 5000.0, 30000.0 }) {
+        CAPTURE(rhomolar);
+        auto X = model.assoc.XA_calc(T, rhomolar, z);
+        Eigen::ArrayXXd Delta(n, n);
+        Eigen::ArrayXd xsite(n);
+        model.assoc.build_Delta_sites(T, rhomolar, z, Delta, xsite);
+        // The site fractions satisfy the mass balance X_a*(1 + rho*sum_b Delta_ab*x_b*X_b) = 1
+        Eigen::ArrayXd residual = X * (1.0 + rhomolar * (Delta.matrix() * (xsite * X).matrix()).array()) - 1.0;
+        CAPTURE(residual);
+        CHECK(residual.abs().maxCoeff() < 1e-13);
+        CHECK((X > 0).all());
+        CHECK((X <= 1).all());
+    }
+}
+
+TEST_CASE("Check derivatives of CPA for water + methanol + MEG", "[CPA]") {
+    auto model = build_CPA_water_methanol_MEG();
+    double T = 350, rhomolar = 30000;
+    auto z = (Eigen::ArrayXd(3) << 0.5, 0.3, 0.2).finished();
+    using tdx = TDXDerivatives<decltype(model)>;
+
+    auto Ar01 = tdx::get_Ar01(model, T, rhomolar, z);
+    auto Ar01csd = tdx::get_Ar01<ADBackends::complex_step>(model, T, rhomolar, z);
+    auto Ar01n = tdx::get_Ar0n<1>(model, T, rhomolar, z)[1];
+    CAPTURE(Ar01);
+    CAPTURE(Ar01csd);
+    CHECK(Ar01 == Approx(Ar01csd).epsilon(1e-13));
+    CHECK(Ar01 == Approx(Ar01n).epsilon(1e-13));
+
+    auto Ar10 = tdx::get_Ar10(model, T, rhomolar, z);
+    auto Ar10csd = tdx::get_Ar10<ADBackends::complex_step>(model, T, rhomolar, z);
+    CAPTURE(Ar10);
+    CAPTURE(Ar10csd);
+    CHECK(Ar10 == Approx(Ar10csd).epsilon(1e-13));
+
+    // Second derivative, compared with the centered finite difference of the first
+    auto Ar02 = tdx::get_Ar02(model, T, rhomolar, z);
+    double h = 1e-4 * rhomolar;
+    auto Ar01p = tdx::get_Ar01(model, T, rhomolar + h, z) / (rhomolar + h), Ar01m = tdx::get_Ar01(model, T, rhomolar - h, z) / (rhomolar - h);
+    auto Ar02fd = rhomolar * rhomolar * (Ar01p - Ar01m) / (2 * h);
+    CHECK(Ar02 == Approx(Ar02fd).epsilon(1e-5));
+}
+
+TEST_CASE("Warm starts of the site fractions of water + methanol + MEG", "[CPA]") {
+    auto cold = build_CPA_water_methanol_MEG();
+    auto warm = build_CPA_water_methanol_MEG(true);
+    double T = 350;
+    auto z = (Eigen::ArrayXd(3) << 0.5, 0.3, 0.2).finished(), z2 = (Eigen::ArrayXd(3) << 0.4, 0.4, 0.2).finished();
+
+    // Off by default, so the result does not depend on what was evaluated before
+    auto alphar = cold.alphar(T, 30000.0, z);
+    cold.alphar(T, 29000.0, z);
+    cold.alphar(T + 10, 30000.0, z2);
+    CHECK(cold.alphar(T, 30000.0, z) == alphar);
+
+    // When turned on, the solutions at other densities, temperatures and compositions only change the starting values
+    for (double rhomolar : { 29000.0, 29500.0, 30000.0 }) {
+        warm.alphar(T, rhomolar, z);
+        warm.alphar(T + 10, rhomolar, z);
+        warm.alphar(T, rhomolar, z2);
+    }
+    CHECK(warm.alphar(T, 30000.0, z) == Approx(alphar).epsilon(1e-14));
+    CHECK(warm.alphar(T + 10, 30000.0, z2) == Approx(cold.alphar(T + 10, 30000.0, z2)).epsilon(1e-14));
+}
+
+TEST_CASE("Warm starts of the site fractions from a store held by the caller", "[CPA]") {
+    auto model = build_CPA_water_methanol_MEG();
+    const auto& assoc = model.assoc;
+    double T = 350;
+    auto z = (Eigen::ArrayXd(3) << 0.5, 0.3, 0.2).finished();
+    const Eigen::ArrayXd Xcold = assoc.XA_calc(T, 30000.0, z);
+
+    SECTION("a solution is found within the tolerances in temperature and composition, for the same owner only") {
+        CPA::XAWarmStart warm;
+        Eigen::ArrayXd X(Xcold.size());
+        warm.store(&assoc, T, 30000.0, z, Xcold);
+        auto z2 = (Eigen::ArrayXd(3) << 0.52, 0.29, 0.19).finished();
+        CHECK(warm.find(&assoc, T * 1.01, 29000.0, z2, X));
+        CHECK((X == Xcold).all());
+        CHECK(!warm.find(&model, T, 30000.0, z, X));
+        CHECK(!warm.find(&assoc, T * 1.1, 30000.0, z, X));
+        auto z3 = (Eigen::ArrayXd(3) << 0.6, 0.2, 0.2).finished();
+        CHECK(!warm.find(&assoc, T, 30000.0, z3, X));
+        warm.clear();
+        CHECK(!warm.find(&assoc, T, 30000.0, z, X));
+    }
+    SECTION("the results only depend on the evaluations made with the store") {
+        // A short sequence of state points, as in the iterations of a bubble-point solver
+        auto run = [&](CPA::XAWarmStart& warm) {
+            std::vector<double> o;
+            for (auto k = 0; k < 5; ++k) {
+                double Tk = T + 0.2 * k;
+                auto y = (Eigen::ArrayXd(3) << 0.9 - 0.01 * k, 0.09 + 0.01 * k, 0.01).finished();
+                o.push_back(assoc.XA_calc(Tk, 30000.0 - 10 * k, z, warm)[0]);
+                o.push_back(assoc.XA_calc(Tk, 50.0 + k, y, warm)[0]);
+            }
+            return o;
+        };
+        CPA::XAWarmStart warm1, warm2;
+        auto o1 = run(warm1);
+        assoc.XA_calc(T + 1, 20000.0, z); // Not made with a store, so it changes nothing
+        auto o2 = run(warm2);
+        CHECK(o1 == o2);
+        CHECK(assoc.XA_calc(T, 30000.0, z, warm1)[0] == Approx(Xcold[0]).epsilon(1e-14));
+    }
+}
+
 TEST_CASE("Check zero(ish)","") {
     double zero = 0.0;
     REQUIRE(zero == 0.0);
@@ -482,4 +733,38 @@ TEST_CASE("Check zero(ish)","") {
     REQUIRE(zeroad == 0.0);
     //mcx::MultiComplex zeromcx = 0.0;
     //REQUIRE(zeromcx == 0.0);
-}
\ No newline at end of file
+}
+TEST_CASE("Check batched Arxy against point-by-point evaluation", "[batch]") {
+    auto model = build_vdW();
+    using tdx = TDXDerivatives<decltype(model)>;
+    const std::size_t N = 101;
+    Eigen::ArrayXd T = Eigen::ArrayXd::LinSpaced(N, 200, 400), rho = Eigen::ArrayXd::LinSpaced(N, 1, 3000);
+    Eigen::ArrayXXd z(N, 2);
+    z.col(0) = Eigen::ArrayXd::LinSpaced(N, 0.01, 0.99);
+    z.col(1) = 1.0 - z.col(0);
+
+    SECTION("one composition per point") {
+        Eigen::ArrayXd expected(N);
+        for (auto i = 0; i < N; ++i) {
+            expected[i] = tdx::get_Arxy<1, 1, ADBackends::autodiff>(model, T[i], rho[i], z.row(i).transpose().eval());
+        }
+        for (std::size_t Nthreads : {1, 4}) {
+            Eigen::ArrayXd out(N);
+            tdx::get_Arxy_batch<1, 1>(model, T, rho, z, out, Nthreads);
+            CHECK((out - expected).abs().maxCoeff() == 0.0);
+        }
+    }
+    SECTION("fixed composition") {
+        Eigen::ArrayXXd z0 = z.topRows(1);
+        Eigen::ArrayXd expected(N), out(N);
+        for (auto i = 0; i < N; ++i) {
+            expected[i] = tdx::get_Ar01(model, T[i], rho[i], z0.row(0).transpose().eval());
+        }
+        tdx::get_Arxy_batch<0, 1>(model, T, rho, z0, out, 3);
+        CHECK((out - expected).abs().maxCoeff() == 0.0);
+    }
+    SECTION("mismatched lengths") {
+        Eigen::ArrayXd out(N - 1);
+        CHECK_THROWS(tdx::get_Arxy_batch<0, 1>(model, T, rho, z, out));
+    }
+}
@@ -109,7 +109,7 @@ auto some_teqp(obtainablethings thing, int Ncomp, const Taus& taus, const Deltas
     return out;
 }
 
-template<int itau, int idelta, typename Taus, typename Deltas, typename TT, typename RHO, typename Model>
+template<int itau, int idelta, bool with_analytic = false, typename Taus, typename Deltas, typename TT, typename RHO, typename Model>
 auto one_deriv(obtainablethings thing, int Ncomp, Taus& taus, Deltas& deltas, const Model& model, const std::string &modelname, TT& Ts, RHO& rhos) {
 
     auto check_values = [](auto res) {
@@ -130,9 +130,20 @@ auto one_deriv(obtainablethings thing, int Ncomp, Taus& taus, Deltas& deltas, co
 
     std::cout << "Values:" << check_values(timingREFPROP) << ", " << check_values(timingteqpad) << std::endl;
 
+    // The closed-form derivatives are only available for some models (the multifluid one)
+    std::vector<OneTiming> timingteqpan;
+    if constexpr (with_analytic) {
+        timingteqpan = some_teqp<itau, idelta, ADBackends::analytic>(thing, Ncomp, taus, deltas, model, Ts, rhos);
+        std::cout << "Values(analytic):" << check_values(timingteqpan) << std::endl;
+    }
+
     auto N = timingREFPROP.size();
-    std::vector<double> timesteqpad, timesteqpmcx, timesREFPROP, 
-                        valsteqpad,   valsteqpmcx,  valsREFPROP;
+    std::vector<double> timesteqpad, timesteqpmcx, timesteqpan, timesREFPROP, 
+                        valsteqpad,   valsteqpmcx,  valsteqpan,  valsREFPROP;
+    for (auto i = 0; i < timingteqpan.size(); ++i) {
+        timesteqpan.push_back(timingteqpan[i].sec_per_call);
+        valsteqpan.push_back(timingteqpan[i].value);
+    }
     for (auto i = 0; i < N; ++i) {
         timesteqpad.push_back(timingteqpad[i].sec_per_call);
         //timesteqpmcx.push_back(timingteqpmcx[i].sec_per_call);
@@ -148,8 +159,10 @@ auto one_deriv(obtainablethings thing, int Ncomp, Taus& taus, Deltas& deltas, co
         {"timeteqp",timesteqpad},
         {"timeteqp(autodiff)",timesteqpad},
         //{"timeteqp(multicomplex)",timesteqpmcx},
+        {"timeteqp(analytic)",timesteqpan},
         {"timeREFPROP",timesREFPROP},
         {"valteqp(autodiff)",valsteqpad},
+        {"valteqp(analytic)",valsteqpan},
         //{"valteqp(multicomplex)",valsteqpmcx},
         {"valREFPROP",valsREFPROP},
         {"model", modelname},
@@ -275,10 +288,10 @@ int main()
             outputs.push_back(one_deriv<0, 2>(thing, Ncomp, taus, deltas, SAFT, "PCSAFT", Ts, rhos)); append_Ncomp();
             outputs.push_back(one_deriv<0, 3>(thing, Ncomp, taus, deltas, SAFT, "PCSAFT", Ts, rhos)); append_Ncomp();
 
-            outputs.push_back(one_deriv<0, 0>(thing, Ncomp, taus, deltas, model, "multifluid", Ts, rhos)); append_Ncomp();
-            outputs.push_back(one_deriv<0, 1>(thing, Ncomp, taus, deltas, model, "multifluid", Ts, rhos)); append_Ncomp();
-            outputs.push_back(one_deriv<0, 2>(thing, Ncomp, taus, deltas, model, "multifluid", Ts, rhos)); append_Ncomp();
-            outputs.push_back(one_deriv<0, 3>(thing, Ncomp, taus, deltas, model, "multifluid", Ts, rhos)); append_Ncomp();
+            outputs.push_back(one_deriv<0, 0, true>(thing, Ncomp, taus, deltas, model, "multifluid", Ts, rhos)); append_Ncomp();
+            outputs.push_back(one_deriv<0, 1, true>(thing, Ncomp, taus, deltas, model, "multifluid", Ts, rhos)); append_Ncomp();
+            outputs.push_back(one_deriv<0, 2, true>(thing, Ncomp, taus, deltas, model, "multifluid", Ts, rhos)); append_Ncomp();
+            outputs.push_back(one_deriv<0, 3, true>(thing, Ncomp, taus, deltas, model, "multifluid", Ts, rhos)); append_Ncomp();
         }
 
         std::ofstream file("Ar0n_timings.json");